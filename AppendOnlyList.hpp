@@ -0,0 +1,90 @@
+#ifndef APPEND_ONLY_LIST_HPP
+#define APPEND_ONLY_LIST_HPP
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <cstddef>
+
+// Append-only list whose elements never move, so readers can index and
+// traverse it without taking any lock while writers append.
+//
+// Storage is a fixed table of CHUNKS chunks; chunk k holds FIRST << k
+// elements and is allocated the first time it is needed. Appends are
+// serialised by a mutex and become visible to readers by a release store of
+// the size, so a reader that sees size() == n may safely read elements [0, n).
+template <typename T, size_t FIRST_BITS = 3, size_t CHUNKS = 24>
+class AppendOnlyList {
+private:
+    static constexpr size_t FIRST = size_t(1) << FIRST_BITS;
+
+    std::atomic<T*> chunks[CHUNKS];
+    std::atomic<size_t> published{0};
+    std::mutex writeLock;
+
+    // Chunk k covers indices [FIRST * (2^k - 1), FIRST * (2^(k+1) - 1)).
+    static void locate(size_t index, size_t& chunk, size_t& offset) {
+        chunk = 63 - static_cast<size_t>(__builtin_clzll(index / FIRST + 1));
+        offset = index - FIRST * ((size_t(1) << chunk) - 1);
+    }
+
+    T* slot(size_t index) const {
+        size_t chunk, offset;
+        locate(index, chunk, offset);
+        return chunks[chunk].load(std::memory_order_acquire) + offset;
+    }
+
+public:
+    static constexpr size_t MAX_SIZE = FIRST * ((size_t(1) << CHUNKS) - 1);
+
+    AppendOnlyList() {
+        for (auto& c : chunks) c.store(nullptr, std::memory_order_relaxed);
+    }
+
+    AppendOnlyList(const AppendOnlyList&) = delete;
+    AppendOnlyList& operator=(const AppendOnlyList&) = delete;
+
+    ~AppendOnlyList() {
+        size_t n = published.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < n; i++) slot(i)->~T();
+        for (auto& c : chunks) {
+            ::operator delete(c.load(std::memory_order_relaxed));
+        }
+    }
+
+    size_t size() const {
+        return published.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+
+    // Elements the allocated chunks have room for
+    size_t capacity() const {
+        size_t n = 0;
+        for (size_t k = 0; k < CHUNKS && chunks[k].load(std::memory_order_acquire); k++) n += FIRST << k;
+        return n;
+    }
+
+    const T& operator[](size_t index) const { return *slot(index); }
+    T& operator[](size_t index) { return *slot(index); }
+
+    // Returns the index of the new element.
+    template <typename... Args>
+    size_t emplace_back(Args&&... args) {
+        std::lock_guard<std::mutex> lock(writeLock);
+        size_t n = published.load(std::memory_order_relaxed);
+        size_t chunk, offset;
+        locate(n, chunk, offset);
+        T* base = chunks[chunk].load(std::memory_order_relaxed);
+        if (!base) {
+            base = static_cast<T*>(::operator new(sizeof(T) * (FIRST << chunk)));
+            chunks[chunk].store(base, std::memory_order_release);
+        }
+        new (base + offset) T(std::forward<Args>(args)...);
+        published.store(n + 1, std::memory_order_release);
+        return n;
+    }
+};
+
+#endif // APPEND_ONLY_LIST_HPP
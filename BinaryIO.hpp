@@ -0,0 +1,309 @@
+#ifndef BINARY_IO_HPP
+#define BINARY_IO_HPP
+
+#include <string>
+#include <string_view>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Little-endian encoding helpers shared by the write-ahead log and snapshots,
+// file-backed versions of them for snapshots too large to hold whole, and a
+// whole-file read.
+
+class BinaryWriter {
+private:
+    std::string buffer;
+
+public:
+    void u8(uint8_t v) { buffer.push_back(static_cast<char>(v)); }
+
+    void u32(uint32_t v) {
+        for (int i = 0; i < 4; i++) u8(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void u64(uint64_t v) {
+        for (int i = 0; i < 8; i++) u8(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void str(std::string_view s) {
+        u32(static_cast<uint32_t>(s.size()));
+        buffer.append(s);
+    }
+
+    void raw(const void* data, size_t n) {
+        buffer.append(static_cast<const char*>(data), n);
+    }
+
+    // Overwrites four bytes already written, e.g. a length placeholder.
+    void patchU32(size_t offset, uint32_t v) {
+        for (int i = 0; i < 4; i++) buffer[offset + i] = static_cast<char>(v >> (8 * i));
+    }
+
+    void patch(size_t offset, const void* data, size_t n) {
+        std::memcpy(&buffer[offset], data, n);
+    }
+
+    // Zero-pads up to the next multiple of `alignment`.
+    void align(size_t alignment) {
+        while (buffer.size() % alignment != 0) buffer.push_back('\0');
+    }
+
+    size_t size() const { return buffer.size(); }
+    const std::string& data() const { return buffer; }
+    void clear() { buffer.clear(); }
+};
+
+// Bounds-checked reader. Any read past the end clears ok() and returns zeros,
+// so callers can decode a whole record and check once at the end.
+class BinaryReader {
+private:
+    const char* pos;
+    const char* end;
+    bool good = true;
+
+    bool need(size_t n) {
+        if (!good || static_cast<size_t>(end - pos) < n) {
+            good = false;
+            return false;
+        }
+        return true;
+    }
+
+public:
+    BinaryReader(const char* data, size_t size) : pos(data), end(data + size) {}
+
+    bool ok() const { return good; }
+    size_t remaining() const { return static_cast<size_t>(end - pos); }
+    const char* position() const { return pos; }
+
+    uint8_t u8() {
+        if (!need(1)) return 0;
+        return static_cast<uint8_t>(*pos++);
+    }
+
+    uint32_t u32() {
+        if (!need(4)) return 0;
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) v |= static_cast<uint32_t>(static_cast<uint8_t>(pos[i])) << (8 * i);
+        pos += 4;
+        return v;
+    }
+
+    uint64_t u64() {
+        if (!need(8)) return 0;
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++) v |= static_cast<uint64_t>(static_cast<uint8_t>(pos[i])) << (8 * i);
+        pos += 8;
+        return v;
+    }
+
+    std::string str() {
+        uint32_t n = u32();
+        if (!need(n)) return std::string();
+        std::string s(pos, n);
+        pos += n;
+        return s;
+    }
+
+    void skip(size_t n) {
+        if (need(n)) pos += n;
+    }
+};
+
+// CRC-32 (IEEE), used to detect torn or corrupted records.
+inline uint32_t crc32(const void* data, size_t n, uint32_t crc = 0) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) {
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// Writes all `n` bytes to `fd`. Returns false if a write fails.
+inline bool writeAll(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        ssize_t written = ::write(fd, p, n);
+        if (written <= 0) return false;
+        p += written;
+        n -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// A BinaryWriter that hands its bytes to a file every FLUSH_BYTES, so a large
+// snapshot is never held in memory whole. Keeps a running CRC-32 of what it
+// has written.
+class FileWriter {
+private:
+    int fd;
+    BinaryWriter buffer;
+    uint64_t flushed = 0; // Bytes handed to the file so far
+    uint32_t crc = 0;
+    bool good = true;
+
+    void flushIfFull() {
+        if (buffer.size() >= FLUSH_BYTES) flush();
+    }
+
+public:
+    static constexpr size_t FLUSH_BYTES = size_t(1) << 20;
+
+    explicit FileWriter(int file) : fd(file) {}
+
+    void u8(uint8_t v) { buffer.u8(v); flushIfFull(); }
+    void u32(uint32_t v) { buffer.u32(v); flushIfFull(); }
+    void u64(uint64_t v) { buffer.u64(v); flushIfFull(); }
+    void str(std::string_view s) { buffer.str(s); flushIfFull(); }
+    void raw(const void* data, size_t n) { buffer.raw(data, n); flushIfFull(); }
+
+    // Zero-pads up to the next multiple of `alignment` of size().
+    void align(size_t alignment) {
+        while (size() % alignment != 0) buffer.u8(0);
+    }
+
+    // Bytes written so far, buffered or not: the file offset of the next one.
+    uint64_t size() const { return flushed + buffer.size(); }
+
+    // Writes out whatever is buffered. False once any write has failed.
+    bool flush() {
+        if (good && buffer.size() > 0) {
+            crc = crc32(buffer.data().data(), buffer.size(), crc);
+            good = writeAll(fd, buffer.data().data(), buffer.size());
+        }
+        flushed += buffer.size();
+        buffer.clear();
+        return good;
+    }
+
+    uint32_t checksum() const { return crc; } // Of the bytes flushed so far
+    bool ok() const { return good; }
+};
+
+// BinaryReader's interface over the first `size` bytes of a file, read
+// BUFFER_BYTES at a time with pread.
+class FileReader {
+private:
+    int fd;
+    uint64_t limit;
+    uint64_t fileOffset = 0; // Of the first byte not yet in the buffer
+    std::vector<char> buffer;
+    size_t pos = 0;
+    size_t end = 0;
+    bool good = true;
+
+    bool need(size_t n) {
+        if (!good) return false;
+        if (end - pos >= n) return true;
+        if (n - (end - pos) > limit - fileOffset) {
+            good = false;
+            return false;
+        }
+        // Keep the unread bytes and top up after them
+        std::memmove(buffer.data(), buffer.data() + pos, end - pos);
+        end -= pos;
+        pos = 0;
+        if (buffer.size() < n) buffer.resize(n);
+        while (end < buffer.size() && fileOffset < limit) {
+            size_t want = static_cast<size_t>(std::min<uint64_t>(buffer.size() - end, limit - fileOffset));
+            ssize_t got = ::pread(fd, buffer.data() + end, want, static_cast<off_t>(fileOffset));
+            if (got <= 0) break;
+            end += static_cast<size_t>(got);
+            fileOffset += static_cast<uint64_t>(got);
+        }
+        good = end >= n;
+        return good;
+    }
+
+public:
+    static constexpr size_t BUFFER_BYTES = size_t(1) << 20;
+
+    FileReader(int file, uint64_t size) : fd(file), limit(size), buffer(BUFFER_BYTES) {}
+
+    bool ok() const { return good; }
+
+    uint8_t u8() {
+        if (!need(1)) return 0;
+        return static_cast<uint8_t>(buffer[pos++]);
+    }
+
+    uint32_t u32() {
+        if (!need(4)) return 0;
+        uint32_t v = BinaryReader(buffer.data() + pos, 4).u32();
+        pos += 4;
+        return v;
+    }
+
+    uint64_t u64() {
+        if (!need(8)) return 0;
+        uint64_t v = BinaryReader(buffer.data() + pos, 8).u64();
+        pos += 8;
+        return v;
+    }
+
+    std::string str() {
+        uint32_t n = u32();
+        if (!need(n)) return std::string();
+        std::string s(buffer.data() + pos, n);
+        pos += n;
+        return s;
+    }
+};
+
+// Checks that the last four bytes of file `fd` are the CRC-32 of everything
+// before them, reading it in pieces. `bodySize` receives that length.
+inline bool fileCrcMatches(int fd, uint64_t& bodySize) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < 4) return false;
+    bodySize = static_cast<uint64_t>(st.st_size) - 4;
+    std::vector<char> piece(FileReader::BUFFER_BYTES);
+    uint32_t crc = 0;
+    for (uint64_t offset = 0; offset < bodySize;) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(piece.size(), bodySize - offset));
+        ssize_t got = ::pread(fd, piece.data(), want, static_cast<off_t>(offset));
+        if (got <= 0) return false;
+        crc = crc32(piece.data(), static_cast<size_t>(got), crc);
+        offset += static_cast<uint64_t>(got);
+    }
+    char stored[4];
+    if (::pread(fd, stored, 4, static_cast<off_t>(bodySize)) != 4) return false;
+    return BinaryReader(stored, 4).u32() == crc;
+}
+
+// Reads a whole file into `bytes`. Returns false if it cannot be read.
+inline bool readWholeFile(const std::string& path, std::vector<char>& bytes) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    bool good = ::fstat(fd, &st) == 0;
+    if (good) {
+        bytes.resize(static_cast<size_t>(st.st_size));
+        size_t got = 0;
+        while (got < bytes.size()) {
+            ssize_t n = ::read(fd, bytes.data() + got, bytes.size() - got);
+            if (n <= 0) break;
+            got += static_cast<size_t>(n);
+        }
+        good = got == bytes.size();
+    }
+    ::close(fd);
+    return good;
+}
+
+#endif // BINARY_IO_HPP
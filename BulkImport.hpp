@@ -0,0 +1,650 @@
+#ifndef BULK_IMPORT_HPP
+#define BULK_IMPORT_HPP
+
+#include "Network.hpp"
+#include "BinaryIO.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <iterator>
+#include <charconv>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+
+// Loads users, connections and posts from CSV or JSON-lines files.
+//
+// A CSV file starts with a header row naming its columns, in any order; a
+// JSON-lines file has one flat object per line with the same keys. Other
+// columns and keys are ignored.
+//
+//   users  type,username,password,name,detail1,detail2
+//          type is 1 or student (university, major) or 2 or professional
+//          (company, title)
+//   edges  from,to                   usernames
+//   posts  author,content,timestamp  timestamp in seconds, may be left out
+//
+// The file is read whole and cut at line breaks into one chunk per thread.
+// The threads parse their chunks and resolve usernames side by side, then
+// the rows go into the Network in one bulk call (see Network::importUsers).
+// Quoted CSV fields may hold commas and doubled quotes but not line breaks.
+
+enum class ImportFormat {
+    Csv,
+    JsonLines
+};
+
+// JSON lines for .jsonl, .ndjson and .json files, CSV otherwise.
+inline ImportFormat importFormatOf(const std::string& path) {
+    for (const char* suffix : {".jsonl", ".ndjson", ".json"}) {
+        size_t n = std::char_traits<char>::length(suffix);
+        if (path.size() >= n && path.compare(path.size() - n, n, suffix) == 0) return ImportFormat::JsonLines;
+    }
+    return ImportFormat::Csv;
+}
+
+struct ImportStats {
+    size_t rows = 0;     // Data rows read
+    size_t imported = 0; // Users, connections or posts added
+    size_t rejected = 0; // Malformed rows and rows naming unknown users
+    double seconds = 0;  // Reading, parsing and loading
+
+    // Rows that were well-formed but already present
+    size_t duplicates() const { return rows - imported - rejected; }
+    double rowsPerSecond() const { return seconds > 0 ? rows / seconds : 0; }
+};
+
+// Which input columns feed which fields, shared by every thread's parser.
+struct RowLayout {
+    ImportFormat format = ImportFormat::Csv;
+    std::vector<std::string> columns; // The fields a table wants, in its order
+    std::vector<int> csvSlots;        // CSV column -> index into columns, or -1
+
+    int slotOf(std::string_view name) const {
+        for (size_t i = 0; i < columns.size(); i++) {
+            if (columns[i] == name) return static_cast<int>(i);
+        }
+        return -1;
+    }
+};
+
+// Splits one line into the fields its layout asks for. Fields are views into
+// the line or, when they had to be unescaped, into the parser's own arena, so
+// they stay valid as long as both the file and the parser do.
+class RowParser {
+private:
+    const RowLayout& layout;
+    std::vector<std::string_view> fields;
+    std::string scratch;
+    StringArena unescaped;
+
+    std::string_view keepScratch() {
+        uint64_t location = unescaped.add(scratch);
+        return unescaped.get(location, static_cast<uint32_t>(scratch.size()));
+    }
+
+    // One CSV field starting at `p`; leaves `p` on the comma or line end after it.
+    bool csvField(const char*& p, const char* end, std::string_view& field, bool wanted) {
+        if (p == end || *p != '"') {
+            const char* start = p;
+            while (p < end && *p != ',') ++p;
+            field = std::string_view(start, static_cast<size_t>(p - start));
+            return true;
+        }
+        const char* start = ++p;
+        bool doubled = false;
+        for (;; ++p) {
+            if (p == end) return false; // Unterminated quote
+            if (*p != '"') continue;
+            if (p + 1 < end && p[1] == '"') {
+                doubled = true;
+                ++p;
+                continue;
+            }
+            break;
+        }
+        const char* stop = p++;
+        if (p < end && *p != ',') return false;
+        if (!doubled) {
+            field = std::string_view(start, static_cast<size_t>(stop - start));
+        } else if (wanted) {
+            scratch.clear();
+            for (const char* q = start; q < stop; ++q) {
+                scratch += *q;
+                if (*q == '"') ++q;
+            }
+            field = keepScratch();
+        }
+        return true;
+    }
+
+    bool parseCsv(const char* p, const char* end) {
+        for (size_t column = 0;; column++) {
+            int slot = column < layout.csvSlots.size() ? layout.csvSlots[column] : -1;
+            std::string_view field;
+            if (!csvField(p, end, field, slot >= 0)) return false;
+            if (slot >= 0) fields[slot] = field;
+            if (p == end) return true;
+            ++p; // The comma
+        }
+    }
+
+    static void skipSpace(const char*& p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    }
+
+    static bool hex4(const char* p, const char* end, uint32_t& value) {
+        if (end - p < 4) return false;
+        value = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = p[i];
+            uint32_t digit;
+            if (c >= '0' && c <= '9') digit = static_cast<uint32_t>(c - '0');
+            else if (c >= 'a' && c <= 'f') digit = static_cast<uint32_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') digit = static_cast<uint32_t>(c - 'A' + 10);
+            else return false;
+            value = value << 4 | digit;
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | cp >> 6);
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | cp >> 12);
+            out += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | cp >> 18);
+            out += static_cast<char>(0x80 | (cp >> 12 & 0x3F));
+            out += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // A JSON string starting at its opening quote. Strings without escapes
+    // are returned in place.
+    bool jsonString(const char*& p, const char* end, std::string_view& out, bool wanted) {
+        const char* start = ++p;
+        while (p < end && *p != '"' && *p != '\\') ++p;
+        if (p == end) return false;
+        if (*p == '"') {
+            out = std::string_view(start, static_cast<size_t>(p - start));
+            ++p;
+            return true;
+        }
+
+        scratch.assign(start, p);
+        while (p < end && *p != '"') {
+            if (*p != '\\') {
+                scratch += *p++;
+                continue;
+            }
+            if (++p == end) return false;
+            char c = *p++;
+            switch (c) {
+                case '"': case '\\': case '/': scratch += c; break;
+                case 'b': scratch += '\b'; break;
+                case 'f': scratch += '\f'; break;
+                case 'n': scratch += '\n'; break;
+                case 'r': scratch += '\r'; break;
+                case 't': scratch += '\t'; break;
+                case 'u': {
+                    uint32_t cp;
+                    if (!hex4(p, end, cp)) return false;
+                    p += 4;
+                    // A surrogate pair encodes one code point outside the BMP
+                    uint32_t low;
+                    if (cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u' &&
+                        hex4(p + 2, end, low) && low >= 0xDC00 && low < 0xE000) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        p += 6;
+                    }
+                    appendUtf8(scratch, cp);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        if (p == end) return false;
+        ++p;
+        if (wanted) out = keepScratch();
+        return true;
+    }
+
+    // Flat objects only: string, number, true/false and null values.
+    bool parseJson(const char* p, const char* end) {
+        skipSpace(p, end);
+        if (p == end || *p != '{') return false;
+        ++p;
+        skipSpace(p, end);
+        if (p < end && *p == '}') {
+            ++p;
+            skipSpace(p, end);
+            return p == end;
+        }
+        for (;;) {
+            skipSpace(p, end);
+            std::string_view key;
+            if (p == end || *p != '"' || !jsonString(p, end, key, true)) return false;
+            int slot = layout.slotOf(key);
+            skipSpace(p, end);
+            if (p == end || *p != ':') return false;
+            ++p;
+            skipSpace(p, end);
+            if (p == end) return false;
+
+            std::string_view value;
+            if (*p == '"') {
+                if (!jsonString(p, end, value, slot >= 0)) return false;
+            } else {
+                const char* start = p;
+                while (p < end && *p != ',' && *p != '}' && *p != ' ' && *p != '\t') ++p;
+                value = std::string_view(start, static_cast<size_t>(p - start));
+                if (value.empty() || value.front() == '{' || value.front() == '[') return false;
+                if (value == "null") value = std::string_view();
+            }
+            if (slot >= 0) fields[slot] = value;
+
+            skipSpace(p, end);
+            if (p == end) return false;
+            if (*p == '}') {
+                ++p;
+                skipSpace(p, end);
+                return p == end;
+            }
+            if (*p != ',') return false;
+            ++p;
+        }
+    }
+
+public:
+    explicit RowParser(const RowLayout& rowLayout) : layout(rowLayout), fields(rowLayout.columns.size()) {}
+
+    // Returns false if the line is malformed. Missing fields are empty.
+    bool parse(const char* p, const char* end) {
+        std::fill(fields.begin(), fields.end(), std::string_view());
+        return layout.format == ImportFormat::Csv ? parseCsv(p, end) : parseJson(p, end);
+    }
+
+    std::string_view operator[](size_t slot) const { return fields[slot]; }
+
+    // Maps the columns of a CSV header line onto `layout`. Returns false
+    // unless the first `required` columns of the layout are all present.
+    static bool readHeader(RowLayout& layout, const char* p, const char* end, size_t required) {
+        RowLayout names;
+        names.format = ImportFormat::Csv;
+        RowParser header(names);
+        layout.csvSlots.clear();
+        for (;;) {
+            std::string_view name;
+            if (!header.csvField(p, end, name, true)) return false;
+            layout.csvSlots.push_back(layout.slotOf(name));
+            if (p == end) break;
+            ++p;
+        }
+        for (size_t i = 0; i < required; i++) {
+            if (std::find(layout.csvSlots.begin(), layout.csvSlots.end(), static_cast<int>(i)) == layout.csvSlots.end()) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Username -> UserId for resolving millions of names in a row.
+//
+// UsernameTable's node-based map costs several dependent cache misses per
+// lookup. Here each user has one 32-byte slot in an open-addressing table
+// that holds the name inline (up to INLINE_CHARS of it), so a lookup reads
+// one cache line, and find() takes names a batch at a time and prefetches
+// all their slots before probing any of them.
+class NameIndex {
+private:
+    static constexpr size_t INLINE_CHARS = 27;
+
+    struct alignas(32) Slot {
+        UserId id = NO_USER;
+        uint8_t length = 0; // Capped at 255; longer names are checked in full
+        char name[INLINE_CHARS];
+    };
+
+    const Network& net;
+    size_t users;
+    std::vector<Slot> slots;
+    size_t mask = 0;
+
+    static size_t hash(std::string_view name) {
+        return std::hash<std::string_view>()(name);
+    }
+
+    static uint8_t cappedLength(std::string_view name) {
+        return static_cast<uint8_t>(std::min<size_t>(name.size(), 255));
+    }
+
+    bool matches(const Slot& slot, std::string_view name) const {
+        if (slot.length != cappedLength(name)) return false;
+        if (std::memcmp(slot.name, name.data(), std::min(name.size(), INLINE_CHARS)) != 0) return false;
+        return name.size() <= INLINE_CHARS || net.usernameOf(slot.id) == name;
+    }
+
+public:
+    static constexpr size_t BATCH = 16;
+
+    // Indexes every user `network` has now.
+    explicit NameIndex(const Network& network) : net(network), users(network.userCount()) {
+        size_t capacity = 16;
+        while (capacity < network.userCount() * 2) capacity *= 2;
+        slots.resize(capacity);
+        mask = capacity - 1;
+        for (UserId id = 0; id < network.userCount(); id++) {
+            std::string_view name = network.usernameOf(id);
+            size_t i = hash(name) & mask;
+            while (slots[i].id != NO_USER) i = (i + 1) & mask;
+            slots[i].id = id;
+            slots[i].length = cappedLength(name);
+            std::memcpy(slots[i].name, name.data(), std::min(name.size(), INLINE_CHARS));
+        }
+    }
+
+    size_t userCount() const { return users; }
+
+    // The ids of names[0..n), NO_USER for unknown names; n <= BATCH.
+    void find(const std::string_view* names, size_t n, UserId* ids) const {
+        size_t start[BATCH];
+        for (size_t k = 0; k < n; k++) {
+            start[k] = hash(names[k]) & mask;
+            __builtin_prefetch(&slots[start[k]]);
+        }
+        for (size_t k = 0; k < n; k++) {
+            ids[k] = NO_USER;
+            for (size_t i = start[k]; slots[i].id != NO_USER; i = (i + 1) & mask) {
+                if (matches(slots[i], names[k])) {
+                    ids[k] = slots[i].id;
+                    break;
+                }
+            }
+        }
+    }
+};
+
+// Usernames read by one thread that are waiting to be resolved, each with a
+// key saying where its id belongs. They are looked up BATCH at a time.
+class PendingNames {
+private:
+    std::string_view names[NameIndex::BATCH];
+    size_t keys[NameIndex::BATCH];
+    size_t count = 0;
+
+public:
+    // store(key, id) receives every id once it is known.
+    template <typename Store>
+    void add(const NameIndex& index, std::string_view name, size_t key, Store store) {
+        names[count] = name;
+        keys[count] = key;
+        if (++count == NameIndex::BATCH) resolve(index, store);
+    }
+
+    template <typename Store>
+    void resolve(const NameIndex& index, Store store) {
+        UserId ids[NameIndex::BATCH];
+        index.find(names, count, ids);
+        for (size_t k = 0; k < count; k++) store(keys[k], ids[k]);
+        count = 0;
+    }
+};
+
+// Imports files into a Network on up to `threads` threads. Not safe to use
+// while anything else is using the Network.
+class BulkImporter {
+private:
+    Network& net;
+    size_t threads;
+    std::unique_ptr<NameIndex> names; // Rebuilt when users have been added since
+
+    static constexpr size_t MIN_CHUNK_BYTES = size_t(1) << 16; // Smaller files are not worth a thread
+
+    struct Chunk {
+        const char* begin;
+        const char* end;
+    };
+
+    // The next line in [p, end), without its line break or carriage return.
+    static bool nextLine(const char*& p, const char* end, const char*& lineBegin, const char*& lineEnd) {
+        if (p >= end) return false;
+        lineBegin = p;
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        lineEnd = newline ? newline : end;
+        p = newline ? newline + 1 : end;
+        if (lineEnd > lineBegin && lineEnd[-1] == '\r') --lineEnd;
+        return true;
+    }
+
+    // Cuts [begin, end) into up to `threads` pieces that each end at a line break.
+    std::vector<Chunk> split(const char* begin, const char* end) const {
+        size_t size = static_cast<size_t>(end - begin);
+        size_t pieces = std::max<size_t>(1, std::min(threads, size / MIN_CHUNK_BYTES));
+        std::vector<Chunk> chunks;
+        const char* start = begin;
+        for (size_t i = 1; i < pieces && start < end; i++) {
+            const char* cut = begin + size * i / pieces;
+            if (cut < start) cut = start;
+            const char* newline = static_cast<const char*>(std::memchr(cut, '\n', static_cast<size_t>(end - cut)));
+            if (!newline) break;
+            chunks.push_back({start, newline + 1});
+            start = newline + 1;
+        }
+        chunks.push_back({start, end});
+        return chunks;
+    }
+
+    // Reads `path` and parses every data row, a thread per chunk. After each
+    // line is parsed into its chunk's parser, row(chunk, parser) is called and
+    // returns false to reject the row. `parsers` keeps the parsers (and any
+    // unescaped fields) alive for the caller.
+    template <typename RowFn>
+    bool parseFile(const std::string& path, RowLayout& layout, size_t required, std::vector<char>& bytes,
+                   std::deque<RowParser>& parsers, ImportStats& stats, RowFn row) {
+        if (!readWholeFile(path, bytes)) return false;
+        layout.format = importFormatOf(path);
+        const char* p = bytes.data();
+        const char* end = p + bytes.size();
+
+        if (layout.format == ImportFormat::Csv) {
+            const char* lineBegin;
+            const char* lineEnd;
+            if (!nextLine(p, end, lineBegin, lineEnd) || !RowParser::readHeader(layout, lineBegin, lineEnd, required)) {
+                return false;
+            }
+        }
+
+        std::vector<Chunk> chunks = split(p, end);
+        for (size_t c = 0; c < chunks.size(); c++) parsers.emplace_back(layout);
+        std::vector<size_t> rows(chunks.size(), 0);
+        std::vector<size_t> rejected(chunks.size(), 0);
+
+        auto work = [&](size_t c) {
+            RowParser& parser = parsers[c];
+            const char* at = chunks[c].begin;
+            const char* lineBegin;
+            const char* lineEnd;
+            while (nextLine(at, chunks[c].end, lineBegin, lineEnd)) {
+                if (lineBegin == lineEnd) continue;
+                rows[c]++;
+                if (!parser.parse(lineBegin, lineEnd) || !row(c, parser)) rejected[c]++;
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (size_t c = 1; c < chunks.size(); c++) pool.emplace_back(work, c);
+        work(0);
+        for (auto& thread : pool) thread.join();
+
+        for (size_t c = 0; c < chunks.size(); c++) {
+            stats.rows += rows[c];
+            stats.rejected += rejected[c];
+        }
+        return true;
+    }
+
+    const NameIndex& nameIndex() {
+        if (!names || names->userCount() != net.userCount()) names = std::make_unique<NameIndex>(net);
+        return *names;
+    }
+
+    template <typename T>
+    static std::vector<T> concatenate(std::vector<std::vector<T>>& parts) {
+        size_t total = 0;
+        for (const auto& part : parts) total += part.size();
+        std::vector<T> all;
+        all.reserve(total);
+        for (auto& part : parts) {
+            std::move(part.begin(), part.end(), std::back_inserter(all));
+            std::vector<T>().swap(part);
+        }
+        return all;
+    }
+
+    static double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+public:
+    explicit BulkImporter(Network& network, size_t threadCount = std::thread::hardware_concurrency())
+        : net(network), threads(std::max<size_t>(1, threadCount)) {}
+
+    // Each returns false if the file cannot be read or a CSV header lacks a
+    // required column; `stats` then says nothing useful.
+
+    bool importUsers(const std::string& path, ImportStats& stats) {
+        auto start = std::chrono::steady_clock::now();
+        enum { TYPE, USERNAME, PASSWORD, NAME, DETAIL1, DETAIL2 };
+        RowLayout layout;
+        layout.columns = {"type", "username", "password", "name", "detail1", "detail2"};
+
+        std::vector<char> bytes;
+        std::deque<RowParser> parsers;
+        std::vector<std::vector<std::unique_ptr<User>>> parsed(threads);
+        bool good = parseFile(path, layout, 4, bytes, parsers, stats, [&](size_t c, const RowParser& row) {
+            std::string_view type = row[TYPE];
+            char code = type == "1" || type == "student" ? '1' : type == "2" || type == "professional" ? '2' : 0;
+            if (!code || row[USERNAME].empty()) return false;
+            parsed[c].push_back(makeUser(code, std::string(row[USERNAME]), std::string(row[PASSWORD]), std::string(row[NAME]),
+                                         std::string(row[DETAIL1]), std::string(row[DETAIL2])));
+            return true;
+        });
+        if (!good) return false;
+
+        std::vector<std::unique_ptr<User>> batch = concatenate(parsed);
+        stats.imported = net.importUsers(batch);
+        stats.seconds = secondsSince(start);
+        return true;
+    }
+
+    bool importConnections(const std::string& path, ImportStats& stats) {
+        auto start = std::chrono::steady_clock::now();
+        enum { FROM, TO };
+        RowLayout layout;
+        layout.columns = {"from", "to"};
+
+        std::vector<char> bytes;
+        std::deque<RowParser> parsers;
+        // Each row is added with both ends unknown and filled in when its
+        // batch of names is resolved; key 2i is row i's first end, 2i + 1 its second
+        const NameIndex& index = nameIndex();
+        std::vector<std::vector<std::pair<UserId, UserId>>> parsed(threads);
+        std::vector<PendingNames> pending(threads);
+        auto storeEnd = [&](size_t c) {
+            return [&parsed, c](size_t key, UserId id) {
+                auto& edge = parsed[c][key / 2];
+                (key % 2 ? edge.second : edge.first) = id;
+            };
+        };
+        bool good = parseFile(path, layout, 2, bytes, parsers, stats, [&](size_t c, const RowParser& row) {
+            size_t at = parsed[c].size();
+            parsed[c].emplace_back(NO_USER, NO_USER);
+            pending[c].add(index, row[FROM], 2 * at, storeEnd(c));
+            pending[c].add(index, row[TO], 2 * at + 1, storeEnd(c));
+            return true;
+        });
+        if (!good) return false;
+
+        for (size_t c = 0; c < threads; c++) {
+            pending[c].resolve(index, storeEnd(c));
+            auto& rows = parsed[c];
+            size_t before = rows.size();
+            rows.erase(std::remove_if(rows.begin(), rows.end(), [](const std::pair<UserId, UserId>& edge) {
+                return edge.first == NO_USER || edge.second == NO_USER || edge.first == edge.second;
+            }), rows.end());
+            stats.rejected += before - rows.size();
+        }
+        std::vector<std::pair<UserId, UserId>> edges = concatenate(parsed);
+        stats.imported = net.importConnections(edges, threads);
+        stats.seconds = secondsSince(start);
+        return true;
+    }
+
+    // Posts are appended oldest first; a file that is not already in time
+    // order is sorted (stably) before loading.
+    bool importPosts(const std::string& path, ImportStats& stats) {
+        auto start = std::chrono::steady_clock::now();
+        enum { AUTHOR, CONTENT, TIMESTAMP };
+        RowLayout layout;
+        layout.columns = {"author", "content", "timestamp"};
+        int64_t now = Network::currentTime();
+
+        std::vector<char> bytes;
+        std::deque<RowParser> parsers;
+        // Authors are filled in when their batch of names is resolved
+        const NameIndex& index = nameIndex();
+        std::vector<std::vector<ImportedPost>> parsed(threads);
+        std::vector<PendingNames> pending(threads);
+        auto storeAuthor = [&](size_t c) {
+            return [&parsed, c](size_t key, UserId id) { parsed[c][key].author = id; };
+        };
+        bool good = parseFile(path, layout, 2, bytes, parsers, stats, [&](size_t c, const RowParser& row) {
+            int64_t timestamp = now;
+            std::string_view time = row[TIMESTAMP];
+            if (!time.empty()) {
+                auto result = std::from_chars(time.data(), time.data() + time.size(), timestamp);
+                if (result.ec != std::errc() || result.ptr != time.data() + time.size()) return false;
+            }
+            parsed[c].push_back({NO_USER, timestamp, row[CONTENT]});
+            pending[c].add(index, row[AUTHOR], parsed[c].size() - 1, storeAuthor(c));
+            return true;
+        });
+        if (!good) return false;
+
+        for (size_t c = 0; c < threads; c++) {
+            pending[c].resolve(index, storeAuthor(c));
+            auto& rows = parsed[c];
+            size_t before = rows.size();
+            rows.erase(std::remove_if(rows.begin(), rows.end(), [](const ImportedPost& post) {
+                return post.author == NO_USER;
+            }), rows.end());
+            stats.rejected += before - rows.size();
+        }
+
+        std::vector<ImportedPost> batch = concatenate(parsed);
+        auto older = [](const ImportedPost& a, const ImportedPost& b) { return a.timestamp < b.timestamp; };
+        if (!std::is_sorted(batch.begin(), batch.end(), older)) {
+            std::stable_sort(batch.begin(), batch.end(), older);
+        }
+        stats.imported = net.importPosts(batch);
+        stats.seconds = secondsSince(start);
+        return true;
+    }
+};
+
+#endif // BULK_IMPORT_HPP
@@ -0,0 +1,270 @@
+#ifndef COMMAND_SESSION_HPP
+#define COMMAND_SESSION_HPP
+
+#include "Network.hpp"
+#include "Render.hpp"
+#include <string>
+#include <vector>
+#include <iostream>
+
+// Line-oriented command interface over a Network, used to replay scripts and
+// captured traffic without the interactive prompts. One command per line,
+// fields separated by '|':
+//
+//   register|<1 = Student, 2 = Professional>|username|password|full name|university or company|major or title
+//   login|username|password
+//   logout
+//   profile
+//   post|content
+//   feed                  (first page, newest posts first)
+//   more                  (next page of the last feed)
+//   top                   (the feed's most engaging posts)
+//   suggest               (people you may know, by mutual connections)
+//   path|username         (shortest chain of connections to that user)
+//   like|post number
+//   unlike|post number
+//   search|query          (with the connections you share with each result)
+//   find|words            (your and your connections' posts with all the words;
+//                          OR between words separates alternatives)
+//   trending              (hashtags used by the most posts in the last hour)
+//   request|username
+//   requests
+//   accept|username
+//   format|text or json   (output format for the rest of the session)
+//   stats                 (latency and counters of every operation so far)
+//
+// Blank lines and lines starting with '#' are ignored. In json format every
+// line of output is one JSON object (see Render.hpp).
+
+enum class CommandType {
+    Register, Login, Logout, Profile, Post, Feed, More, Top, Like, Unlike, Search, Request, Requests, Accept,
+    Suggest, Path, Format, Stats, Find, Trending,
+    Invalid, // Unknown command, wrong arguments or not logged in
+    None,    // Blank line or comment
+    COUNT
+};
+
+class CommandSession {
+private:
+    Network& net;
+    User* currentUser = nullptr;
+    FeedCursor feedCursor; // Where `more` continues the feed
+    OutputFormat format = OutputFormat::Text;
+    bool shared = false;   // Running under executeShared
+    bool deferred = false; // The last executeShared needs exclusive access
+
+    static std::vector<std::string> split(const std::string& line) {
+        std::vector<std::string> fields;
+        size_t start = 0;
+        while (true) {
+            size_t bar = line.find('|', start);
+            fields.push_back(line.substr(start, bar - start));
+            if (bar == std::string::npos) break;
+            start = bar + 1;
+        }
+        return fields;
+    }
+
+    static CommandType parse(const std::string& name) {
+        static const char* const names[] = {"register", "login", "logout", "profile", "post", "feed", "more",
+                                            "top", "like", "unlike", "search", "request", "requests", "accept",
+                                            "suggest", "path", "format", "stats", "find", "trending"};
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            if (name == names[i]) return static_cast<CommandType>(i);
+        }
+        return CommandType::Invalid;
+    }
+
+    static bool parseNumber(const std::string& text, size_t& value) {
+        if (text.empty() || text.size() > 18 || text.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        value = std::stoull(text);
+        return true;
+    }
+
+    static size_t argumentCount(CommandType type) {
+        switch (type) {
+            case CommandType::Register: return 6;
+            case CommandType::Login: return 2;
+            case CommandType::Post:
+            case CommandType::Like:
+            case CommandType::Unlike:
+            case CommandType::Search:
+            case CommandType::Find:
+            case CommandType::Request:
+            case CommandType::Accept:
+            case CommandType::Path:
+            case CommandType::Format: return 1;
+            default: return 0;
+        }
+    }
+
+public:
+    explicit CommandSession(Network& network, OutputFormat outputFormat = OutputFormat::Text)
+        : net(network), format(outputFormat) {}
+
+    static const char* name(CommandType type) {
+        static const char* const names[] = {"register", "login", "logout", "profile", "post", "feed", "more",
+                                            "top", "like", "unlike", "search", "request", "requests", "accept",
+                                            "suggest", "path", "format", "stats", "find", "trending", "invalid",
+                                            "none"};
+        return names[static_cast<size_t>(type)];
+    }
+
+    User* user() const { return currentUser; }
+
+    // The command a line would run, without running it.
+    static CommandType peek(const std::string& line) {
+        if (line.empty() || line[0] == '#' || line == "\r") return CommandType::None;
+        return parse(line.substr(0, line.find('|')));
+    }
+
+    // Commands that only read shared Network state and may run concurrently.
+    static bool isReadOnly(CommandType type) {
+        return type != CommandType::Register && type != CommandType::Post && type != CommandType::Like &&
+               type != CommandType::Unlike && type != CommandType::Request && type != CommandType::Accept;
+    }
+
+    // Commands that may run alongside each other and read-only ones, through
+    // executeShared: likes change only Network's thread-safe like counters,
+    // and requests its sharded request store.
+    static bool isConcurrent(CommandType type) {
+        return isReadOnly(type) || type == CommandType::Like || type == CommandType::Unlike ||
+               type == CommandType::Request;
+    }
+
+    // Commands that may run alongside anything, mutations included, as they
+    // take only Network's own per-user locks (see Network::viewNewsFeed).
+    static bool isLockFree(CommandType type) {
+        return type == CommandType::Feed || type == CommandType::More;
+    }
+
+    // As execute, for a command isConcurrent allows, run alongside others.
+    // Returns false, having written nothing, if it turns out to need the
+    // Network to itself (a request the other user had already sent, which
+    // connects them); run it again with execute, with nothing else running.
+    bool executeShared(const std::string& line, std::ostream& out) {
+        shared = true;
+        deferred = false;
+        execute(line, out);
+        shared = false;
+        return !deferred;
+    }
+
+    // Runs one command line, writing its output to `out`, and returns which
+    // command it was.
+    CommandType execute(std::string line, std::ostream& out) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') return CommandType::None;
+        setOutputFormat(out, format);
+
+        std::vector<std::string> fields = split(line);
+        CommandType type = parse(fields[0]);
+        if (type == CommandType::Invalid || fields.size() != argumentCount(type) + 1) {
+            Renderer(out).message("Invalid command: " + line);
+            return CommandType::Invalid;
+        }
+
+        bool needsLogin = type != CommandType::Register && type != CommandType::Login && type != CommandType::Format &&
+                          type != CommandType::Stats && type != CommandType::Trending;
+        if (needsLogin && !currentUser) {
+            Renderer(out).message("Please log in first.");
+            return CommandType::Invalid;
+        }
+
+        switch (type) {
+            case CommandType::Register: {
+                auto user = makeUser(fields[1].empty() ? '\0' : fields[1][0], fields[2], fields[3], fields[4], fields[5], fields[6]);
+                if (!user) {
+                    Renderer(out).message("Invalid choice. Please try again.");
+                } else if (net.addUser(std::move(user))) {
+                    Renderer(out).message("Registration successful!");
+                } else {
+                    Renderer(out).message("Username already exists. Please try another.");
+                }
+                break;
+            }
+            case CommandType::Login:
+                currentUser = net.login(fields[1], fields[2]);
+                feedCursor = FeedCursor();
+                Renderer(out).message(currentUser ? "Login successful!" : "Invalid username or password.");
+                break;
+            case CommandType::Logout:
+                currentUser = nullptr;
+                Renderer(out).message("Logging out...");
+                break;
+            case CommandType::Profile:
+                currentUser->displayProfile(out);
+                break;
+            case CommandType::Post:
+                net.createPost(currentUser->getUsername(), fields[1], out);
+                break;
+            case CommandType::Feed:
+                feedCursor = net.viewNewsFeed(currentUser->getUsername(), FeedCursor(), out);
+                break;
+            case CommandType::More:
+                if (feedCursor.atEnd()) {
+                    Renderer(out).message("No more posts.");
+                } else {
+                    feedCursor = net.viewNewsFeed(currentUser->getUsername(), feedCursor, out);
+                }
+                break;
+            case CommandType::Top:
+                net.viewTopPosts(currentUser->getUsername(), out);
+                break;
+            case CommandType::Like:
+            case CommandType::Unlike: {
+                size_t post = 0;
+                if (!parseNumber(fields[1], post)) {
+                    Renderer(out).message("Invalid post number: " + fields[1]);
+                    return CommandType::Invalid;
+                }
+                if (type == CommandType::Like) net.likePost(currentUser->getUsername(), post, out);
+                else net.unlikePost(currentUser->getUsername(), post, out);
+                break;
+            }
+            case CommandType::Search:
+                net.searchUsers(currentUser->getUsername(), fields[1], out);
+                break;
+            case CommandType::Find:
+                net.searchPosts(currentUser->getUsername(), fields[1], out);
+                break;
+            case CommandType::Request:
+                deferred = !net.sendConnectionRequest(currentUser->getUsername(), fields[1], out, !shared);
+                break;
+            case CommandType::Requests:
+                net.viewConnectionRequests(currentUser->getUsername(), out);
+                break;
+            case CommandType::Accept:
+                net.acceptConnectionRequest(currentUser->getUsername(), fields[1], out);
+                break;
+            case CommandType::Suggest:
+                net.viewSuggestions(currentUser->getUsername(), out);
+                break;
+            case CommandType::Path:
+                net.viewConnectionPath(currentUser->getUsername(), fields[1], out);
+                break;
+            case CommandType::Format:
+                if (fields[1] != "text" && fields[1] != "json") {
+                    Renderer(out).message("Unknown format: " + fields[1] + ". Use text or json.");
+                    return CommandType::Invalid;
+                }
+                format = fields[1] == "json" ? OutputFormat::JsonLines : OutputFormat::Text;
+                setOutputFormat(out, format);
+                Renderer(out).message("Output format: " + fields[1] + ".");
+                break;
+            case CommandType::Stats:
+                viewStats(out);
+                break;
+            case CommandType::Trending:
+                net.viewTrending(out);
+                break;
+            default:
+                break;
+        }
+        return type;
+    }
+};
+
+#endif // COMMAND_SESSION_HPP
@@ -0,0 +1,307 @@
+#ifndef CONNECTION_GRAPH_HPP
+#define CONNECTION_GRAPH_HPP
+
+#include "UsernameTable.hpp"
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+// Open-addressing (linear probing) hash set of vertex ids.
+// Used as the per-user adjacency while the graph is being mutated.
+class IdSet {
+private:
+    static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+    std::vector<uint32_t> slots;
+    size_t count = 0;
+
+    static size_t hash(uint32_t id) {
+        // Fibonacci hashing spreads sequential ids across the table
+        return static_cast<size_t>(id * 2654435769u);
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<uint32_t> old = std::move(slots);
+        slots.assign(capacity, EMPTY);
+        count = 0;
+        for (uint32_t id : old) {
+            if (id != EMPTY) insert(id);
+        }
+    }
+
+    void grow() {
+        rehash(slots.empty() ? 8 : slots.size() * 2);
+    }
+
+public:
+    size_t size() const { return count; }
+
+    // Sizes the table so it holds `n` ids without growing again.
+    void reserve(size_t n) {
+        size_t capacity = 8;
+        while (capacity < n * 2) capacity *= 2;
+        if (capacity > slots.size()) rehash(capacity);
+    }
+
+    bool contains(uint32_t id) const {
+        if (slots.empty()) return false;
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(id) & mask;; i = (i + 1) & mask) {
+            if (slots[i] == id) return true;
+            if (slots[i] == EMPTY) return false;
+        }
+    }
+
+    // Returns false if the id was already present.
+    bool insert(uint32_t id) {
+        // Keep the load factor under 1/2 so probe chains stay short
+        if ((count + 1) * 2 > slots.size()) grow();
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(id) & mask;; i = (i + 1) & mask) {
+            if (slots[i] == id) return false;
+            if (slots[i] == EMPTY) {
+                slots[i] = id;
+                count++;
+                return true;
+            }
+        }
+    }
+
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (uint32_t id : slots) {
+            if (id != EMPTY) fn(id);
+        }
+    }
+};
+
+// Immutable compressed sparse row view of the graph: the neighbours of vertex v
+// are neighbors[offsets[v] .. offsets[v + 1]), sorted ascending.
+class CsrSnapshot {
+private:
+    std::vector<uint32_t> offsets{0};
+    std::vector<uint32_t> neighbors;
+
+public:
+    CsrSnapshot() = default;
+
+    CsrSnapshot(std::vector<uint32_t> rowOffsets, std::vector<uint32_t> rowNeighbors)
+        : offsets(std::move(rowOffsets)), neighbors(std::move(rowNeighbors)) {}
+
+    explicit CsrSnapshot(const std::vector<IdSet>& adjacency) {
+        offsets.reserve(adjacency.size() + 1);
+        for (const auto& set : adjacency) {
+            size_t begin = neighbors.size();
+            set.forEach([&](uint32_t id) { neighbors.push_back(id); });
+            std::sort(neighbors.begin() + begin, neighbors.end());
+            offsets.push_back(static_cast<uint32_t>(neighbors.size()));
+        }
+    }
+
+    size_t vertexCount() const { return offsets.size() - 1; }
+    size_t edgeCount() const { return neighbors.size(); }
+
+    size_t degree(uint32_t v) const {
+        return v < vertexCount() ? offsets[v + 1] - offsets[v] : 0;
+    }
+
+    const uint32_t* begin(uint32_t v) const { return neighbors.data() + offsets[v]; }
+    const uint32_t* end(uint32_t v) const { return neighbors.data() + offsets[v + 1]; }
+
+    bool contains(uint32_t v, uint32_t other) const {
+        return v < vertexCount() && std::binary_search(begin(v), end(v), other);
+    }
+};
+
+// Sorted neighbour lists for traversals, kept up to date as edges are added.
+//
+// The lists are the last CsrSnapshot plus, for each vertex that gained an
+// edge since, a full sorted copy of its list that new neighbours are inserted
+// into. Once the copies hold more than an eighth as many ids as the snapshot
+// (and at least MIN_MERGE), they are merged into a new snapshot, so an edge
+// costs O(degree) plus an amortised share of one O(V + E) merge and readers
+// never rebuild anything. A bitmap of the changed vertices, small enough to
+// stay in cache, keeps lookups of the others as cheap as in the snapshot.
+class SortedAdjacency {
+private:
+    static constexpr size_t MIN_MERGE = size_t(1) << 16;
+
+    CsrSnapshot csr;
+    size_t vertices = 0;
+    std::vector<uint64_t> changedBits;
+    std::vector<uint32_t> changedSlot; // Per vertex: index into `changed`, if its bit is set
+    std::vector<std::vector<uint32_t>> changed;
+    std::vector<uint32_t> changedVertices;
+    size_t changedIds = 0;
+    size_t entries = 0; // Both directions of every edge
+
+    bool isChanged(uint32_t v) const { return (changedBits[v >> 6] >> (v & 63)) & 1; }
+
+    const std::vector<uint32_t>& changedList(uint32_t v) const { return changed[changedSlot[v]]; }
+
+    void insert(uint32_t v, uint32_t id) {
+        if (!isChanged(v)) {
+            changed.emplace_back(begin(v), end(v));
+            changedSlot[v] = static_cast<uint32_t>(changed.size() - 1);
+            changedVertices.push_back(v);
+            changedBits[v >> 6] |= uint64_t(1) << (v & 63);
+            changedIds += changed.back().size();
+        }
+        std::vector<uint32_t>& list = changed[changedSlot[v]];
+        list.insert(std::upper_bound(list.begin(), list.end(), id), id);
+        changedIds++;
+    }
+
+    void merge() {
+        std::vector<uint32_t> offsets{0}, neighbors;
+        offsets.reserve(vertices + 1);
+        neighbors.reserve(entries);
+        for (uint32_t v = 0; v < vertices; v++) {
+            neighbors.insert(neighbors.end(), begin(v), end(v));
+            offsets.push_back(static_cast<uint32_t>(neighbors.size()));
+        }
+        reset(CsrSnapshot(std::move(offsets), std::move(neighbors)));
+    }
+
+    // Makes `snapshot` the whole graph and drops the copies.
+    void reset(CsrSnapshot snapshot) {
+        csr = std::move(snapshot);
+        for (uint32_t v : changedVertices) changedBits[v >> 6] = 0;
+        changed.clear();
+        changedVertices.clear();
+        changedIds = 0;
+        entries = csr.edgeCount();
+    }
+
+public:
+    size_t vertexCount() const { return vertices; }
+    size_t edgeCount() const { return entries; }
+
+    const uint32_t* begin(uint32_t v) const {
+        if (isChanged(v)) return changedList(v).data();
+        return v < csr.vertexCount() ? csr.begin(v) : nullptr;
+    }
+
+    const uint32_t* end(uint32_t v) const {
+        if (isChanged(v)) return changedList(v).data() + changedList(v).size();
+        return v < csr.vertexCount() ? csr.end(v) : nullptr;
+    }
+
+    size_t degree(uint32_t v) const {
+        return v < vertices ? static_cast<size_t>(end(v) - begin(v)) : 0;
+    }
+
+    bool contains(uint32_t v, uint32_t other) const {
+        return v < vertices && std::binary_search(begin(v), end(v), other);
+    }
+
+    void addVertex() {
+        if (vertices % 64 == 0) changedBits.push_back(0);
+        changedSlot.push_back(0);
+        vertices++;
+    }
+
+    // Call once per new undirected edge.
+    void addEdge(uint32_t a, uint32_t b) {
+        insert(a, b);
+        insert(b, a);
+        entries += 2;
+        if (changedIds > std::max(MIN_MERGE, csr.edgeCount() / 8)) merge();
+    }
+
+    // Starts over from the full adjacency, after edges were added in bulk.
+    void rebuild(const std::vector<IdSet>& adjacency) {
+        reset(CsrSnapshot(adjacency));
+    }
+};
+
+// Undirected connection graph owned by Network, with one vertex per UserId.
+// Adjacency is a hash set per vertex for O(1) membership, alongside sorted
+// lists (SortedAdjacency) for read-heavy traversals that every mutation keeps
+// current. Readers may call snapshot() concurrently as long as no one
+// mutates the graph meanwhile.
+class ConnectionGraph {
+private:
+    std::vector<IdSet> adjacency;
+    SortedAdjacency sorted;
+
+public:
+    size_t vertexCount() const { return adjacency.size(); }
+
+    UserId addVertex() {
+        adjacency.emplace_back();
+        sorted.addVertex();
+        return static_cast<UserId>(adjacency.size() - 1);
+    }
+
+    void reserveVertices(size_t n) {
+        adjacency.reserve(n);
+    }
+
+    // Returns false if the edge already existed.
+    bool addEdge(UserId a, UserId b) {
+        if (a == b || !adjacency[a].insert(b)) return false;
+        adjacency[b].insert(a);
+        sorted.addEdge(a, b);
+        return true;
+    }
+
+    // Adds many edges at once on up to `threads` threads and returns how many
+    // were new. Thread t owns the vertices v with v % threads == t and only
+    // ever writes their adjacency, so the threads share nothing but the
+    // read-only edge list. Each owned set is sized for its new ends first and
+    // then filled without rehashing.
+    size_t addEdges(const std::vector<std::pair<UserId, UserId>>& edges, size_t threads) {
+        size_t n = adjacency.size();
+        threads = std::max<size_t>(1, std::min(threads, n));
+        std::vector<size_t> added(threads, 0);
+
+        auto fill = [&](size_t t) {
+            std::vector<uint32_t> incoming(n / threads + 1, 0); // Indexed by v / threads
+            for (const auto& edge : edges) {
+                if (edge.first == edge.second || edge.first >= n || edge.second >= n) continue;
+                if (edge.first % threads == t) incoming[edge.first / threads]++;
+                if (edge.second % threads == t) incoming[edge.second / threads]++;
+            }
+            for (size_t v = t; v < n; v += threads) {
+                if (incoming[v / threads]) adjacency[v].reserve(adjacency[v].size() + incoming[v / threads]);
+            }
+            for (const auto& edge : edges) {
+                UserId a = edge.first, b = edge.second;
+                if (a == b || a >= n || b >= n) continue;
+                // An edge is counted by whoever owns its lower end
+                if (a % threads == t && adjacency[a].insert(b) && a < b) added[t]++;
+                if (b % threads == t && adjacency[b].insert(a) && b < a) added[t]++;
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (size_t t = 1; t < threads; t++) pool.emplace_back(fill, t);
+        fill(0);
+        for (auto& thread : pool) thread.join();
+
+        sorted.rebuild(adjacency);
+        size_t total = 0;
+        for (size_t count : added) total += count;
+        return total;
+    }
+
+    bool connected(UserId a, UserId b) const {
+        return a < adjacency.size() && adjacency[a].contains(b);
+    }
+
+    size_t degree(UserId v) const {
+        return v < adjacency.size() ? adjacency[v].size() : 0;
+    }
+
+    template <typename Fn>
+    void forEachNeighbor(UserId v, Fn fn) const {
+        adjacency[v].forEach(fn);
+    }
+
+    const SortedAdjacency& snapshot() const { return sorted; }
+};
+
+#endif // CONNECTION_GRAPH_HPP
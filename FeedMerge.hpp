@@ -0,0 +1,84 @@
+#ifndef FEED_MERGE_HPP
+#define FEED_MERGE_HPP
+
+#include <vector>
+#include <queue>
+#include <cstdint>
+#include <cstddef>
+
+// Position in a feed. Default-constructed, it starts at the newest post;
+// each page returns the cursor for the page after it. Callers should treat it
+// as opaque.
+class FeedCursor {
+private:
+    uint64_t before = UINT64_MAX; // Only posts with a smaller index come next
+
+    template <typename List>
+    friend class FeedMerge;
+
+public:
+    bool atStart() const { return before == UINT64_MAX; }
+    bool atEnd() const { return before == 0; }
+};
+
+// Pages through the union of several per-author post lists, newest first.
+//
+// Each list holds post indices in ascending order; since indices are handed
+// out in creation order, a higher index is a newer post. The merge keeps one
+// cursor per list in a max-heap, so a page of N posts over k lists costs
+// O(k log h + N log k), however long the lists are. `List` needs size() and
+// operator[] returning something convertible to size_t.
+template <typename List>
+class FeedMerge {
+private:
+    struct Head {
+        size_t post;
+        size_t list;
+        size_t position; // Index of `post` within its list
+        bool operator<(const Head& other) const { return post < other.post; }
+    };
+
+    std::vector<const List*> lists;
+
+public:
+    void add(const List& list) {
+        lists.push_back(&list);
+    }
+
+    // Up to `limit` post indices older than `cursor`, newest first. `cursor`
+    // is advanced past them, or set to its end if nothing older remains.
+    std::vector<size_t> page(FeedCursor& cursor, size_t limit) const {
+        if (limit == 0) return std::vector<size_t>();
+        std::vector<Head> heads;
+        heads.reserve(lists.size());
+        for (size_t i = 0; i < lists.size(); i++) {
+            const List& list = *lists[i];
+            // Binary search for the first entry at or after the cursor,
+            // unless the whole list comes before it, as on the first page
+            size_t lo = 0, hi = list.size();
+            if (hi > 0 && static_cast<uint64_t>(list[hi - 1]) < cursor.before) lo = hi;
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (static_cast<uint64_t>(list[mid]) < cursor.before) lo = mid + 1;
+                else hi = mid;
+            }
+            if (lo > 0) heads.push_back(Head{static_cast<size_t>(list[lo - 1]), i, lo - 1});
+        }
+        std::priority_queue<Head> heap(std::less<Head>(), std::move(heads));
+
+        std::vector<size_t> result;
+        while (!heap.empty() && result.size() < limit) {
+            Head top = heap.top();
+            heap.pop();
+            result.push_back(top.post);
+            if (top.position > 0) {
+                size_t pos = top.position - 1;
+                heap.push(Head{static_cast<size_t>((*lists[top.list])[pos]), top.list, pos});
+            }
+        }
+        cursor.before = heap.empty() || result.empty() ? 0 : result.back();
+        return result;
+    }
+};
+
+#endif // FEED_MERGE_HPP
@@ -0,0 +1,74 @@
+#ifndef FRIEND_SUGGESTIONS_HPP
+#define FRIEND_SUGGESTIONS_HPP
+
+#include "UsernameTable.hpp"
+#include "SetIntersection.hpp"
+#include "TopK.hpp"
+#include <vector>
+#include <cstdint>
+
+struct Suggestion {
+    UserId user;
+    size_t mutual; // Connections the two users share
+};
+
+// "People you may know": the users `user` is not connected to, ranked by how
+// many connections they share with `user`, best `k` first.
+//
+// Only friends of friends can share a connection, so candidates are gathered
+// from the neighbours' lists, each once (a visited bitmap). A candidate's
+// mutual count is an intersection of two sorted lists: when `user` has many
+// connections they are marked once in a bitmap and each candidate's list is
+// probed against it, otherwise the lists are intersected directly, which
+// gallops through hubs' long lists. A candidate whose degree cannot beat the
+// current k-th best is skipped without intersecting.
+//
+// `Graph` is any CSR-like view: vertexCount(), and begin(v)/end(v) giving
+// v's neighbours sorted ascending (e.g. SortedAdjacency).
+template <typename Graph>
+std::vector<Suggestion> suggestConnections(const Graph& graph, UserId user, size_t k) {
+    // At this degree a bitmap probe per candidate id beats merging two lists
+    constexpr size_t DENSE_DEGREE = 64;
+
+    std::vector<Suggestion> result;
+    size_t n = graph.vertexCount();
+    if (user >= n || k == 0) return result;
+
+    const uint32_t* mine = graph.begin(user);
+    const uint32_t* mineEnd = graph.end(user);
+    size_t degree = static_cast<size_t>(mineEnd - mine);
+    if (degree == 0) return result;
+
+    IdBitmap excluded(n); // `user`, their connections and candidates already scored
+    IdBitmap friends(n);
+    excluded.set(user);
+    for (const uint32_t* f = mine; f != mineEnd; ++f) {
+        excluded.set(*f);
+        friends.set(*f);
+    }
+    bool dense = degree >= DENSE_DEGREE;
+
+    TopK<UserId> best(k);
+    for (const uint32_t* f = mine; f != mineEnd; ++f) {
+        for (const uint32_t* c = graph.begin(*f); c != graph.end(*f); ++c) {
+            if (!excluded.testAndSet(*c)) continue;
+            size_t candidateDegree = static_cast<size_t>(graph.end(*c) - graph.begin(*c));
+            if (best.full() && static_cast<double>(std::min(degree, candidateDegree)) < best.weakest()) continue;
+
+            size_t mutual;
+            if (dense && candidateDegree <= degree * intersection::GALLOP_RATIO) {
+                mutual = friends.countIn(graph.begin(*c), graph.end(*c));
+            } else {
+                mutual = intersectionSize(mine, mineEnd, graph.begin(*c), graph.end(*c));
+            }
+            best.offer(static_cast<double>(mutual), *c);
+        }
+    }
+
+    for (const auto& entry : best.sorted()) {
+        result.push_back(Suggestion{entry.second, static_cast<size_t>(entry.first)});
+    }
+    return result;
+}
+
+#endif // FRIEND_SUGGESTIONS_HPP
@@ -0,0 +1,139 @@
+#ifndef GRAPH_GENERATOR_HPP
+#define GRAPH_GENERATOR_HPP
+
+#include "Network.hpp"
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+struct GeneratorConfig {
+    size_t users = 10000;
+    double averageDegree = 20;
+    double postsPerUser = 5;
+    double skew = 0.8;  // 0 = uniform; closer to 1 = a few very popular users
+    uint64_t seed = 42;
+};
+
+// Synthetic social network with a power-law degree distribution (Chung-Lu
+// style): user i is picked as an edge endpoint, or as a post author, with
+// probability proportional to (i + 1)^-skew, so low ids become hubs.
+class GraphGenerator {
+private:
+    GeneratorConfig config;
+    std::mt19937_64 rng;
+    std::vector<double> cumulative; // Prefix sums of the user weights
+
+    static const std::vector<std::string>& firstNames() {
+        static const std::vector<std::string> names = {
+            "Alice", "Bob", "Carol", "David", "Erin", "Frank", "Grace", "Heidi", "Ivan", "Judy",
+            "Mallory", "Niaj", "Olivia", "Peggy", "Rupert", "Sybil", "Trent", "Uma", "Victor", "Wendy"};
+        return names;
+    }
+
+    static const std::vector<std::string>& lastNames() {
+        static const std::vector<std::string> names = {
+            "Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller", "Davis", "Lopez", "Wilson",
+            "Anderson", "Thomas", "Taylor", "Moore", "Jackson", "Martin", "Lee", "Perez", "White", "Harris"};
+        return names;
+    }
+
+    static const std::vector<std::string>& words() {
+        static const std::vector<std::string> vocabulary = {
+            "hiring", "launch", "team", "project", "career", "learning", "cloud", "data", "design", "growth",
+            "startup", "research", "promotion", "conference", "internship", "engineering", "product", "market",
+            "leadership", "mentor", "remote", "python", "cpp", "security", "ai", "network", "today", "new",
+            "#hiring", "#ai", "#career", "#opentowork", "#cpp", "#cloud", "#startup", "#leadership"};
+        return vocabulary;
+    }
+
+public:
+    explicit GraphGenerator(const GeneratorConfig& cfg) : config(cfg), rng(cfg.seed) {
+        cumulative.reserve(config.users);
+        double total = 0;
+        for (size_t i = 0; i < config.users; i++) {
+            total += std::pow(static_cast<double>(i + 1), -config.skew);
+            cumulative.push_back(total);
+        }
+    }
+
+    const GeneratorConfig& getConfig() const { return config; }
+
+    // A user id drawn from the power-law weights.
+    UserId pickUser() {
+        std::uniform_real_distribution<double> dist(0.0, cumulative.back());
+        auto it = std::upper_bound(cumulative.begin(), cumulative.end(), dist(rng));
+        return static_cast<UserId>(std::min<size_t>(it - cumulative.begin(), config.users - 1));
+    }
+
+    // A user id drawn uniformly.
+    UserId pickUniform() {
+        std::uniform_int_distribution<size_t> dist(0, config.users - 1);
+        return static_cast<UserId>(dist(rng));
+    }
+
+    static std::string usernameFor(size_t i) {
+        return "user" + std::to_string(i);
+    }
+
+    std::string fullNameFor(size_t i) const {
+        const auto& first = firstNames();
+        const auto& last = lastNames();
+        return first[i % first.size()] + " " + last[(i / first.size()) % last.size()];
+    }
+
+    std::unique_ptr<User> makeUserFor(size_t i) const {
+        if (i % 2 == 0) {
+            return std::make_unique<Student>(usernameFor(i), "pw" + std::to_string(i), fullNameFor(i), "State University", "Computer Science");
+        }
+        return std::make_unique<Professional>(usernameFor(i), "pw" + std::to_string(i), fullNameFor(i), "Innovate Inc.", "Engineer");
+    }
+
+    std::string postContent() {
+        const auto& vocabulary = words();
+        std::uniform_int_distribution<size_t> pick(0, vocabulary.size() - 1);
+        std::string text;
+        for (int w = 0; w < 8; w++) {
+            if (w) text += ' ';
+            text += vocabulary[pick(rng)];
+        }
+        return text;
+    }
+
+    // About users * averageDegree / 2 distinct undirected edges.
+    std::vector<std::pair<UserId, UserId>> edges() {
+        size_t target = static_cast<size_t>(config.users * config.averageDegree / 2);
+        std::vector<std::pair<UserId, UserId>> out;
+        out.reserve(target);
+        for (size_t i = 0; i < target; i++) {
+            UserId a = pickUser();
+            UserId b = pickUniform(); // One popular end, one random end
+            if (a != b) out.emplace_back(std::min(a, b), std::max(a, b));
+        }
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+        std::shuffle(out.begin(), out.end(), rng);
+        return out;
+    }
+
+    // Registers every user, connects the generated edges through the normal
+    // request/accept path and creates the posts.
+    void populate(Network& net) {
+        for (size_t i = 0; i < config.users; i++) {
+            net.addUser(makeUserFor(i));
+        }
+        for (const auto& edge : edges()) {
+            net.requestConnection(edge.first, edge.second);
+            net.acceptConnection(edge.second, edge.first);
+        }
+        size_t postTotal = static_cast<size_t>(config.users * config.postsPerUser);
+        for (size_t i = 0; i < postTotal; i++) {
+            net.addPost(pickUser(), postContent());
+        }
+    }
+};
+
+#endif // GRAPH_GENERATOR_HPP
@@ -0,0 +1,56 @@
+#ifndef LATENCY_SAMPLES_HPP
+#define LATENCY_SAMPLES_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+// Collects raw latency samples (in microseconds) and summarises them.
+class LatencySamples {
+private:
+    std::vector<double> samples;
+    bool sorted = true;
+
+    void sort() {
+        if (!sorted) {
+            std::sort(samples.begin(), samples.end());
+            sorted = true;
+        }
+    }
+
+public:
+    void add(double micros) {
+        samples.push_back(micros);
+        sorted = false;
+    }
+
+    // Adds all of `other`'s samples, e.g. to combine per-thread results.
+    void merge(const LatencySamples& other) {
+        samples.insert(samples.end(), other.samples.begin(), other.samples.end());
+        sorted = false;
+    }
+
+    size_t count() const { return samples.size(); }
+    bool empty() const { return samples.empty(); }
+
+    double mean() const {
+        if (samples.empty()) return 0;
+        double sum = 0;
+        for (double v : samples) sum += v;
+        return sum / samples.size();
+    }
+
+    // p in [0, 1], e.g. 0.99 for the 99th percentile.
+    double percentile(double p) {
+        if (samples.empty()) return 0;
+        sort();
+        size_t index = static_cast<size_t>(p * samples.size());
+        return samples[std::min(samples.size() - 1, index)];
+    }
+
+    double max() {
+        return percentile(1.0);
+    }
+};
+
+#endif // LATENCY_SAMPLES_HPP
@@ -0,0 +1,93 @@
+#ifndef LIKE_SET_HPP
+#define LIKE_SET_HPP
+
+#include "UsernameTable.hpp"
+#include <unordered_set>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+// Which users like which posts, safe to update from many threads at once.
+//
+// The (user, post) pairs are spread over SHARDS shards by a hash of both
+// halves, each shard with its own mutex. Likes of one hot post by different
+// users therefore land on different shards and do not queue behind one lock.
+// Post indices must fit in 32 bits.
+class LikeSet {
+private:
+    static constexpr size_t SHARDS = 64;
+
+    struct alignas(64) Shard {
+        std::mutex lock;
+        std::unordered_set<uint64_t> pairs;
+    };
+
+    Shard shards[SHARDS];
+
+    static uint64_t key(UserId user, size_t post) {
+        return (static_cast<uint64_t>(user) << 32) | static_cast<uint32_t>(post);
+    }
+
+    Shard& shardOf(uint64_t k) {
+        return shards[(k * 0x9E3779B97F4A7C15ull) >> 58]; // Top 6 bits: SHARDS = 64
+    }
+
+public:
+    // Runs fn() while holding the pair's shard lock, if the pair was added.
+    // Returns false if `user` already likes `post`.
+    template <typename Fn>
+    bool insert(UserId user, size_t post, Fn fn) {
+        uint64_t k = key(user, post);
+        Shard& shard = shardOf(k);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        if (!shard.pairs.insert(k).second) return false;
+        fn();
+        return true;
+    }
+
+    // Runs fn() while holding the pair's shard lock, if the pair was removed.
+    // Returns false if `user` did not like `post`.
+    template <typename Fn>
+    bool erase(UserId user, size_t post, Fn fn) {
+        uint64_t k = key(user, post);
+        Shard& shard = shardOf(k);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        if (!shard.pairs.erase(k)) return false;
+        fn();
+        return true;
+    }
+
+    bool contains(UserId user, size_t post) {
+        uint64_t k = key(user, post);
+        Shard& shard = shardOf(k);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        return shard.pairs.count(k) != 0;
+    }
+
+    // Locks every shard, in a fixed order, until the result is destroyed.
+    // Counters updated under the shard locks cannot change meanwhile, which
+    // gives a snapshot a consistent cut of the pairs and the counts.
+    std::vector<std::unique_lock<std::mutex>> lockAll() {
+        std::vector<std::unique_lock<std::mutex>> held;
+        held.reserve(SHARDS);
+        for (auto& shard : shards) held.emplace_back(shard.lock);
+        return held;
+    }
+
+    // Calls fn(UserId, size_t) for every pair. Callers must hold lockAll().
+    template <typename Fn>
+    void forEachLocked(Fn fn) const {
+        for (const auto& shard : shards) {
+            for (uint64_t k : shard.pairs) fn(static_cast<UserId>(k >> 32), static_cast<size_t>(k & 0xFFFFFFFFu));
+        }
+    }
+
+    // Number of pairs. Callers must hold lockAll().
+    size_t sizeLocked() const {
+        size_t total = 0;
+        for (const auto& shard : shards) total += shard.pairs.size();
+        return total;
+    }
+};
+
+#endif // LIKE_SET_HPP
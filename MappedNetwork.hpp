@@ -0,0 +1,585 @@
+#ifndef MAPPED_NETWORK_HPP
+#define MAPPED_NETWORK_HPP
+
+#include "MappedSnapshot.hpp"
+#include "ConnectionGraph.hpp"
+#include "User.hpp"
+#include "NetworkQueries.hpp"
+#include "RequestStore.hpp"
+#include "PostStore.hpp"
+#include "PostIndex.hpp"
+#include "NgramIndex.hpp"
+#include "TrendingTags.hpp"
+#include "Render.hpp"
+#include "Metrics.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <iostream>
+
+// A Network served straight from a MappedSnapshot, usable as soon as the file
+// is mapped. The base is never modified: new users, connections, requests and
+// posts go into an in-memory delta layered on top, with ids continuing after
+// the base's. The delta is not persisted.
+//
+// Offers the same menu operations as Network so main's menu loop can drive it,
+// and the same source interface, so both answer queries with the shared
+// algorithms of NetworkQueries.hpp.
+class MappedNetwork {
+private:
+    MappedSnapshot base;
+
+    // Delta on top of the mapped base
+    std::vector<std::unique_ptr<User>> deltaUsers;          // Ids from base.userCount()
+    std::unordered_map<std::string, UserId> deltaIds;
+    std::unordered_map<UserId, std::unique_ptr<User>> materialized; // Base users that have logged in
+    std::vector<IdSet> deltaEdges;                          // Indexed by UserId, grown on demand
+    PostStore deltaPosts;                                   // Indices from base.postCount()
+    std::unordered_map<size_t, int> baseLikeDelta;          // Likes added to base posts
+    std::unordered_set<uint64_t> toggledLikes;              // (user << 32 | post) liked or unliked this session
+    std::unordered_map<UserId, std::vector<size_t>> deltaPostsByAuthor;
+    int64_t requestTtl = RequestStore::DEFAULT_TTL;
+
+    // Built from the base on first use, then kept up to date
+    std::unique_ptr<RequestStore> requests;                 // Every pending request, the base's included
+    std::unique_ptr<NgramIndex> searchIndex;                // Usernames and full names
+    std::unique_ptr<PostIndex> postIndex;
+    std::unique_ptr<TrendingTags> trending;
+
+    static constexpr size_t FEED_PAGE_SIZE = 10;
+    static constexpr size_t TOP_POSTS = 10;
+    static constexpr size_t SUGGESTIONS = 10;
+    static constexpr size_t MAX_SEPARATION = 6;
+    static constexpr size_t POST_SEARCH_RESULTS = 20;
+    static constexpr size_t TRENDING_TAGS = 10;
+
+    // Sorted neighbour lists of base plus delta, in the CSR shape
+    // suggestConnections expects. Users with delta edges get a merged copy,
+    // built on first use; everyone else reads the mapped list in place.
+    class MergedGraph {
+    private:
+        const MappedNetwork& net;
+        mutable std::unordered_map<UserId, std::vector<uint32_t>> merged;
+
+        const std::vector<uint32_t>* mergedList(UserId v) const {
+            if (v >= net.deltaEdges.size() || net.deltaEdges[v].size() == 0) return nullptr;
+            auto it = merged.find(v);
+            if (it == merged.end()) {
+                std::vector<uint32_t> list;
+                net.forEachNeighbor(v, [&](uint32_t id) { list.push_back(id); });
+                std::sort(list.begin(), list.end());
+                it = merged.emplace(v, std::move(list)).first;
+            }
+            return &it->second;
+        }
+
+    public:
+        explicit MergedGraph(const MappedNetwork& network) : net(network) {}
+
+        size_t vertexCount() const { return net.totalUsers(); }
+
+        const uint32_t* begin(UserId v) const {
+            if (const auto* list = mergedList(v)) return list->data();
+            return net.isBaseUser(v) ? net.base.neighbors(v).first : nullptr;
+        }
+
+        const uint32_t* end(UserId v) const {
+            if (const auto* list = mergedList(v)) return list->data() + list->size();
+            return net.isBaseUser(v) ? net.base.neighbors(v).second : nullptr;
+        }
+    };
+
+    static uint64_t pairKey(UserId a, UserId b) {
+        return (static_cast<uint64_t>(a) << 32) | b;
+    }
+
+    size_t totalUsers() const { return base.userCount() + deltaUsers.size(); }
+
+    bool isBaseUser(UserId id) const { return id < base.userCount(); }
+
+    // Empty for NO_USER, which a corrupt post record may name as its author.
+    std::string_view nameOf(UserId id) const {
+        if (isBaseUser(id)) return base.str(base.user(id).username);
+        if (id >= totalUsers()) return std::string_view();
+        return deltaUsers[id - base.userCount()]->getUsername();
+    }
+
+    std::string_view fullNameOf(UserId id) const {
+        if (isBaseUser(id)) return base.str(base.user(id).fullName);
+        if (id >= totalUsers()) return std::string_view();
+        return deltaUsers[id - base.userCount()]->getFullName();
+    }
+
+    UserId find(const std::string& username) const {
+        UserId id = base.find(username);
+        if (id != NO_USER) return id;
+        auto it = deltaIds.find(username);
+        return it != deltaIds.end() ? it->second : NO_USER;
+    }
+
+    // Counted on demand: the mapped network is read-mostly and keeps no
+    // MutualCounts
+    size_t mutualCount(UserId a, UserId b) const {
+        if (degree(a) > degree(b)) std::swap(a, b);
+        size_t count = 0;
+        forEachNeighbor(a, [&](UserId n) {
+            if (connected(b, n)) count++;
+        });
+        return count;
+    }
+
+    // The base's requests are loaded into a RequestStore on first use, oldest
+    // first so expiry can walk them in order; from then on the store is the
+    // only record of pending requests.
+    RequestStore& pendingRequests() {
+        if (!requests) {
+            requests = std::make_unique<RequestStore>();
+            std::vector<RequestStore::Request> loaded;
+            base.forEachRequest([&](UserId from, UserId to, int64_t sentAt) { loaded.push_back({from, to, sentAt}); });
+            std::stable_sort(loaded.begin(), loaded.end(), [](const RequestStore::Request& a, const RequestStore::Request& b) {
+                return a.sentAt < b.sentAt;
+            });
+            for (const auto& r : loaded) requests->insert(r.from, r.to, r.sentAt);
+        }
+        return *requests;
+    }
+
+    // As Network::expireRequests, but nothing is logged.
+    void expireRequests(int64_t now) {
+        if (requestTtl <= 0) return;
+        size_t expired = pendingRequests().expire(now - requestTtl, [](const RequestStore::Request&) {});
+        Metrics::count(Counter::RequestsExpired, expired);
+    }
+
+    // The mapped layout carries no n-gram index, so the first search builds
+    // one over every user; users added later are indexed as they register.
+    NgramIndex& userIndex() {
+        if (!searchIndex) {
+            searchIndex = std::make_unique<NgramIndex>();
+            for (UserId id = 0; id < totalUsers(); id++) {
+                searchIndex->add(id, std::string(nameOf(id)), std::string(fullNameOf(id)));
+            }
+        }
+        return *searchIndex;
+    }
+
+    std::string_view contentOf(size_t index) const {
+        if (index >= base.postCount()) return deltaPosts.get(index - base.postCount()).content;
+        return base.str(base.post(index).content);
+    }
+
+    void renderPost(Renderer& render, size_t index) const {
+        UserId author = authorOf(index);
+        render.post(PostView{index, author, timestampOf(index), likesOf(index), contentOf(index)}, nameOf(author));
+    }
+
+public:
+    // Maps the snapshot; returns false if it is missing or invalid.
+    bool open(const std::string& path) {
+        return base.open(path);
+    }
+
+    // Requests older than this many seconds expire; 0 keeps them forever.
+    void setRequestTtl(int64_t seconds) {
+        requestTtl = seconds;
+    }
+
+    // One author's posts: the base ones, then the delta ones, all ascending.
+    struct AuthorPosts {
+        const uint32_t* base;
+        size_t baseCount;
+        const std::vector<size_t>* delta;
+
+        size_t size() const { return baseCount + (delta ? delta->size() : 0); }
+        size_t operator[](size_t i) const { return i < baseCount ? base[i] : (*delta)[i - baseCount]; }
+    };
+
+    // --- The source interface of NetworkQueries.hpp ---
+
+    size_t userCount() const { return totalUsers(); }
+    size_t postCount() const { return base.postCount() + deltaPosts.size(); }
+
+    size_t degree(UserId id) const {
+        auto adj = base.neighbors(id); // Empty for delta users
+        size_t d = static_cast<size_t>(adj.second - adj.first);
+        return d + (id < deltaEdges.size() ? deltaEdges[id].size() : 0);
+    }
+
+    bool connected(UserId a, UserId b) const {
+        if (isBaseUser(a) && isBaseUser(b)) {
+            auto adj = base.neighbors(a);
+            if (std::binary_search(adj.first, adj.second, b)) return true;
+        }
+        return a < deltaEdges.size() && deltaEdges[a].contains(b);
+    }
+
+    template <typename Fn>
+    void forEachNeighbor(UserId id, Fn fn) const {
+        if (isBaseUser(id)) {
+            auto adj = base.neighbors(id);
+            for (const uint32_t* it = adj.first; it != adj.second; ++it) fn(*it);
+        }
+        if (id < deltaEdges.size()) deltaEdges[id].forEach(fn);
+    }
+
+    AuthorPosts authorPosts(UserId author) const {
+        AuthorPosts list{nullptr, 0, nullptr};
+        if (isBaseUser(author)) {
+            auto posts = base.posts(author);
+            list.base = posts.first;
+            list.baseCount = static_cast<size_t>(posts.second - posts.first);
+        }
+        auto it = deltaPostsByAuthor.find(author);
+        if (it != deltaPostsByAuthor.end()) list.delta = &it->second;
+        return list;
+    }
+
+    UserId authorOf(size_t index) const {
+        if (index >= base.postCount()) return deltaPosts.author(index - base.postCount());
+        return base.authorOf(index);
+    }
+
+    int likesOf(size_t index) const {
+        if (index >= base.postCount()) return deltaPosts.likes(index - base.postCount());
+        auto it = baseLikeDelta.find(index);
+        return static_cast<int>(base.post(index).likes) + (it != baseLikeDelta.end() ? it->second : 0);
+    }
+
+    int64_t timestampOf(size_t index) const {
+        if (index >= base.postCount()) return deltaPosts.timestamp(index - base.postCount());
+        return base.post(index).timestamp;
+    }
+
+    MergedGraph adjacency() const { return MergedGraph(*this); }
+
+    // --- Menu operations ---
+
+    bool addUser(std::unique_ptr<User> newUser) {
+        if (!newUser || find(newUser->getUsername()) != NO_USER) {
+            return false; // User already exists or is null
+        }
+        UserId id = static_cast<UserId>(totalUsers());
+        newUser->setId(id);
+        deltaIds.emplace(newUser->getUsername(), id);
+        if (searchIndex) searchIndex->add(id, newUser->getUsername(), newUser->getFullName());
+        deltaUsers.push_back(std::move(newUser));
+        return true;
+    }
+
+    // Base users are materialised into a User object on first login only.
+    User* login(const std::string& username, const std::string& password) {
+        OperationTimer timer(Operation::Login);
+        UserId id = find(username);
+        if (id == NO_USER) return nullptr;
+
+        User* user = nullptr;
+        if (!isBaseUser(id)) {
+            user = deltaUsers[id - base.userCount()].get();
+        } else {
+            auto it = materialized.find(id);
+            if (it == materialized.end()) {
+                const MappedUser& u = base.user(id);
+                auto made = makeUser(static_cast<char>(u.typeCode), std::string(base.str(u.username)),
+                                     std::string(base.str(u.password)), std::string(base.str(u.fullName)),
+                                     std::string(base.str(u.detail1)), std::string(base.str(u.detail2)));
+                if (!made) return nullptr;
+                made->setId(id);
+                it = materialized.emplace(id, std::move(made)).first;
+            }
+            user = it->second.get();
+        }
+        if (!user->checkPassword(password)) return nullptr;
+        user->setConnectionCount(degree(id));
+        return user;
+    }
+
+    // As in Network: if `to` has already asked to connect with `from`, this
+    // accepts that request instead of sending a new one.
+    RequestStatus requestConnection(UserId from, UserId to, int64_t sentAt = Network::currentTime()) {
+        if (from >= totalUsers() || to >= totalUsers() || from == to) {
+            return RequestStatus::Invalid;
+        }
+        if (connected(from, to)) {
+            return RequestStatus::AlreadyConnected;
+        }
+        RequestStore& pending = pendingRequests();
+        if (pending.contains(to, from)) {
+            acceptConnection(from, to);
+            return RequestStatus::Accepted;
+        }
+        if (!pending.insert(from, to, sentAt)) {
+            return RequestStatus::AlreadySent;
+        }
+        return RequestStatus::Sent;
+    }
+
+    // Returns false if `sender` has no pending request to `recipient`.
+    bool acceptConnection(UserId recipient, UserId sender) {
+        if (recipient >= totalUsers() || sender >= totalUsers() || !pendingRequests().remove(sender, recipient)) {
+            return false;
+        }
+        if (!connected(recipient, sender)) {
+            if (deltaEdges.size() < totalUsers()) deltaEdges.resize(totalUsers());
+            deltaEdges[recipient].insert(sender);
+            deltaEdges[sender].insert(recipient);
+        }
+        for (UserId id : {recipient, sender}) {
+            auto it = materialized.find(id);
+            if (it != materialized.end()) it->second->setConnectionCount(degree(id));
+            if (!isBaseUser(id)) deltaUsers[id - base.userCount()]->setConnectionCount(degree(id));
+        }
+        return true;
+    }
+
+    void sendConnectionRequest(const std::string& fromUser, const std::string& toUser) {
+        OperationTimer timer(Operation::SendRequest);
+        expireRequests(Network::currentTime());
+        RequestStatus status = requestConnection(find(fromUser), find(toUser));
+        Renderer render(std::cout);
+        if (status == RequestStatus::Sent) {
+            render.message("Connection request sent to " + toUser + ".");
+        } else if (status == RequestStatus::AlreadySent) {
+            render.message("You have already sent a request to " + toUser + ".");
+        } else if (status == RequestStatus::AlreadyConnected) {
+            render.message("You are already connected with " + toUser + ".");
+        } else if (status == RequestStatus::Accepted) {
+            render.message(toUser + " had already sent you a request. You are now connected with " + toUser + ".");
+        } else {
+            render.message("User not found or you cannot connect with yourself.");
+        }
+    }
+
+    // Requests past the TTL are hidden here and removed by the next send or
+    // accept, as in Network.
+    void viewConnectionRequests(const std::string& username) {
+        OperationTimer timer(Operation::ViewRequests);
+        int64_t cutoff = requestTtl > 0 ? Network::currentTime() - requestTtl : INT64_MIN;
+        UserId id = find(username);
+        std::vector<UserId> incoming, outgoing;
+        if (id != NO_USER) {
+            const RequestStore& pending = pendingRequests();
+            pending.forEachIncoming(id, [&](const RequestStore::Request& r) {
+                if (r.sentAt > cutoff) incoming.push_back(r.from);
+            });
+            pending.forEachOutgoing(id, [&](const RequestStore::Request& r) {
+                if (r.sentAt > cutoff) outgoing.push_back(r.to);
+            });
+        }
+
+        Renderer render(std::cout);
+        if (incoming.empty()) {
+            render.message("You have no pending connection requests.");
+        } else {
+            render.heading("Pending Connection Requests");
+            for (UserId from : incoming) render.request(nameOf(from), true, mutualCount(id, from));
+        }
+
+        if (!outgoing.empty()) {
+            render.heading("Sent Requests Awaiting Reply");
+            for (UserId to : outgoing) render.request(nameOf(to), false, mutualCount(id, to));
+        }
+    }
+
+    void acceptConnectionRequest(const std::string& currentUser, const std::string& requestUser) {
+        OperationTimer timer(Operation::AcceptRequest);
+        expireRequests(Network::currentTime());
+        if (!acceptConnection(find(currentUser), find(requestUser))) {
+            Renderer(std::cout).message("No connection request found from " + requestUser + ".");
+            return;
+        }
+        Renderer(std::cout).message("You are now connected with " + requestUser + ".");
+    }
+
+    void createPost(const std::string& author, const std::string& content) {
+        OperationTimer timer(Operation::CreatePost);
+        UserId authorId = find(author);
+        if (authorId == NO_USER) return;
+        size_t index = postCount();
+        deltaPostsByAuthor[authorId].push_back(index);
+        int64_t now = Network::currentTime();
+        deltaPosts.append(authorId, now, content);
+        if (postIndex) postIndex->add(static_cast<uint32_t>(index), content);
+        if (trending) trending->addPost(content, now);
+        Renderer(std::cout).message("Post created successfully!");
+    }
+
+    FeedCursor viewNewsFeed(const std::string& username, FeedCursor cursor = FeedCursor()) {
+        OperationTimer timer(Operation::ViewNewsFeed);
+        UserId userId = find(username);
+        if (userId == NO_USER) return cursor;
+
+        bool first = cursor.atStart();
+        std::vector<size_t> page = queries::feedPage(*this, userId, cursor, FEED_PAGE_SIZE);
+        Metrics::count(Counter::FeedSources, degree(userId) + 1);
+        Metrics::count(Counter::FeedPosts, page.size());
+
+        Renderer render(std::cout);
+        render.heading(first ? "Your News Feed" : "Older Posts");
+        for (size_t index : page) {
+            renderPost(render, index);
+        }
+        if (page.empty()) {
+            render.message(first ? "No posts to show. Connect with people to see their posts!" : "No more posts.");
+        }
+        return cursor;
+    }
+
+    void toggleLike(const std::string& username, size_t post) {
+        UserId user = find(username);
+        if (user == NO_USER || post >= postCount()) {
+            Renderer(std::cout).message("Post not found.");
+            return;
+        }
+        // The pair is liked now if exactly one of the file and this session says so
+        uint64_t key = pairKey(user, static_cast<UserId>(post));
+        bool likedInBase = post < base.postCount() && base.liked(user, post);
+        bool flipped = toggledLikes.erase(key) == 0;
+        if (flipped) toggledLikes.insert(key);
+        int change = likedInBase != flipped ? 1 : -1;
+        if (post < base.postCount()) {
+            baseLikeDelta[post] += change;
+        } else if (change > 0) {
+            deltaPosts.like(post - base.postCount());
+        } else {
+            deltaPosts.unlike(post - base.postCount());
+        }
+        Renderer(std::cout).message((change > 0 ? "You liked post #" : "You unliked post #") + std::to_string(post) + ".");
+    }
+
+    void viewTopPosts(const std::string& username) {
+        OperationTimer timer(Operation::ViewTopPosts);
+        UserId userId = find(username);
+        if (userId == NO_USER) return;
+
+        std::vector<size_t> top = queries::topPosts(*this, userId, TOP_POSTS, Network::currentTime());
+        Renderer render(std::cout);
+        render.heading("Top Posts");
+        for (size_t index : top) {
+            renderPost(render, index);
+        }
+        if (top.empty()) {
+            render.message("No posts to show. Connect with people to see their posts!");
+        }
+    }
+
+    void viewSuggestions(const std::string& username) const {
+        OperationTimer timer(Operation::ViewSuggestions);
+        UserId userId = find(username);
+        if (userId == NO_USER) return;
+
+        Renderer render(std::cout);
+        render.heading("People You May Know");
+        for (const Suggestion& s : queries::suggestions(*this, userId, SUGGESTIONS)) {
+            render.suggestion(nameOf(s.user), fullNameOf(s.user), s.mutual);
+        }
+        if (degree(userId) == 0) {
+            render.message("No suggestions yet. Connect with someone first!");
+        }
+    }
+
+    void viewConnectionPath(const std::string& username, const std::string& target) const {
+        OperationTimer timer(Operation::ViewConnectionPath);
+        UserId userId = find(username);
+        UserId targetId = find(target);
+        if (userId == NO_USER) return;
+        Renderer render(std::cout);
+        if (targetId == NO_USER) {
+            render.message("User '" + target + "' not found.");
+            return;
+        }
+
+        PathResult result = queries::pathBetween(*this, userId, targetId, MAX_SEPARATION);
+        Metrics::count(Counter::PathVisited, result.visited);
+        if (!result.found) {
+            render.message("You and " + target + " are not connected within " + std::to_string(MAX_SEPARATION) + " steps.");
+            return;
+        }
+        std::vector<std::string_view> names;
+        for (UserId id : result.path) names.push_back(nameOf(id));
+        render.heading("How You're Connected");
+        render.path(names);
+    }
+
+    // The mapped layout carries no post index, so the first search builds one
+    // from every post; later posts are added as they are created.
+    void searchPosts(const std::string& username, const std::string& query) {
+        OperationTimer timer(Operation::SearchPosts);
+        UserId userId = find(username);
+        if (userId == NO_USER) return;
+        if (!postIndex) {
+            postIndex = std::make_unique<PostIndex>();
+            for (size_t i = 0; i < postCount(); i++) postIndex->add(static_cast<uint32_t>(i), contentOf(i));
+        }
+
+        std::vector<size_t> found = queries::findPosts(*this, *postIndex, userId, query, POST_SEARCH_RESULTS);
+        Renderer render(std::cout);
+        render.heading("Post Search Results");
+        for (size_t index : found) {
+            renderPost(render, index);
+        }
+        if (found.empty()) {
+            render.message("No posts found matching your query.");
+        } else if (found.size() == POST_SEARCH_RESULTS) {
+            render.message("Showing the newest " + std::to_string(POST_SEARCH_RESULTS) + " matches. Add words to narrow the search.");
+        }
+    }
+
+    // Like the post index, the hashtag counts are built on first use, from
+    // the posts made within the window; only their timestamps are read for
+    // the rest.
+    void viewTrending() {
+        OperationTimer timer(Operation::ViewTrending);
+        int64_t now = Network::currentTime();
+        if (!trending) {
+            trending = std::make_unique<TrendingTags>();
+            for (size_t i = 0; i < postCount(); i++) {
+                int64_t timestamp = timestampOf(i);
+                if (timestamp > now - trending->windowSeconds()) trending->addPost(contentOf(i), timestamp);
+            }
+        }
+
+        std::vector<std::pair<std::string, uint32_t>> tags = trending->top(TRENDING_TAGS, now);
+        Renderer render(std::cout);
+        render.heading("Trending Now");
+        for (const auto& tag : tags) {
+            render.trend(tag.first, tag.second);
+        }
+        if (tags.empty()) {
+            render.message("No hashtags in the last hour's posts.");
+        }
+    }
+
+    // Case-insensitive substring search by username or full name, as in
+    // Network. Mutual counts are counted per result rather than tracked.
+    void searchUsers(const std::string& query, size_t limit = 20, UserId viewer = NO_USER) {
+        OperationTimer timer(Operation::SearchUsers);
+        bool truncated = false;
+        std::vector<UserId> matches = userIndex().search(query, limit, truncated);
+        Metrics::count(Counter::SearchMatches, matches.size());
+
+        Renderer render(std::cout);
+        render.heading("Search Results");
+        for (UserId id : matches) {
+            if (viewer != NO_USER && id != viewer) {
+                render.user(nameOf(id), fullNameOf(id), mutualCount(viewer, id));
+            } else {
+                render.user(nameOf(id), fullNameOf(id));
+            }
+        }
+        if (matches.empty()) {
+            render.message("No users found matching your query.");
+        } else if (truncated) {
+            render.message("Showing the first " + std::to_string(limit) + " results. Refine your query to see more.");
+        }
+    }
+
+    void searchUsers(const std::string& username, const std::string& query) {
+        searchUsers(query, 20, find(username));
+    }
+};
+
+#endif // MAPPED_NETWORK_HPP
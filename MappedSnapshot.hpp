@@ -0,0 +1,438 @@
+#ifndef MAPPED_SNAPSHOT_HPP
+#define MAPPED_SNAPSHOT_HPP
+
+#include "Network.hpp"
+#include "BinaryIO.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Position-independent, read-only snapshot layout that is mmap'ed and queried
+// in place. Every section is 8-byte aligned and addressed by its offset from
+// the start of the file, so nothing has to be deserialised on open:
+//
+//   MappedHeader
+//   MappedUser[userCount]              (strings point into the pool)
+//   u32 usernameOrder[userCount]       (ids sorted by username, for lookup)
+//   u64 adjOffsets[userCount + 1]      (CSR over the connection graph)
+//   u32 adjacency[neighborCount]
+//   u64 requestOffsets[userCount + 1]  (pending requests, by recipient)
+//   u32 requestSenders[requestCount]
+//   i64 requestSentAt[requestCount]    (seconds since the epoch, as senders)
+//   MappedPost[postCount]
+//   u64 authorPostOffsets[userCount + 1]
+//   u32 authorPosts[postCount]         (post indices per author, ascending)
+//   u64 likePairs[likeCount]           (user << 32 | post, ascending)
+//   char strings[stringsSize]
+//
+// Integers are stored in host byte order; byteOrder guards against opening a
+// file written on a machine of the other endianness.
+
+struct MappedString {
+    uint64_t offset; // Relative to the string pool
+    uint32_t length;
+    uint32_t reserved;
+};
+
+struct MappedUser {
+    MappedString username;
+    MappedString password;
+    MappedString fullName;
+    MappedString detail1;
+    MappedString detail2;
+    uint32_t typeCode;
+    uint32_t reserved;
+};
+
+struct MappedPost {
+    MappedString content;
+    uint32_t author;
+    uint32_t likes;
+    int64_t timestamp; // Seconds since the epoch
+};
+
+struct MappedHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t fileSize;
+    uint64_t userCount;
+    uint64_t postCount;
+    uint64_t neighborCount;
+    uint64_t requestCount;
+    uint64_t usersOffset;
+    uint64_t usernameOrderOffset;
+    uint64_t adjOffsetsOffset;
+    uint64_t adjacencyOffset;
+    uint64_t requestOffsetsOffset;
+    uint64_t requestSendersOffset;
+    uint64_t postsOffset;
+    uint64_t authorPostOffsetsOffset;
+    uint64_t authorPostsOffset;
+    uint64_t likeCount;
+    uint64_t likePairsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t requestSentAtOffset;
+};
+
+class MappedSnapshot {
+private:
+    static constexpr char MAGIC[8] = {'C', 'C', 'M', 'A', 'P', 0, 0, 0};
+    static constexpr uint32_t VERSION = 3; // 2: post timestamps and like pairs; 3: request times
+    static constexpr uint32_t ORDER_MARK = 0x01020304u;
+
+    const char* base = nullptr;
+    size_t mappedSize = 0;
+    const MappedHeader* header = nullptr;
+
+    // One entry per user and per-user table: whether that user's slice has
+    // been checked yet. Filled in as slices are first read, so a snapshot is
+    // read from one thread at a time.
+    enum class Checked : uint8_t { No, Good, Bad };
+    mutable std::vector<Checked> adjChecked;
+    mutable std::vector<Checked> requestChecked;
+    mutable std::vector<Checked> authorPostsChecked;
+
+    template <typename T>
+    const T* section(uint64_t offset) const {
+        return reinterpret_cast<const T*>(base + offset);
+    }
+
+    // Checks that a section of `count` items of type T lies inside the file.
+    template <typename T>
+    bool fits(uint64_t offset, uint64_t count) const {
+        return offset % alignof(T) == 0 && offset <= mappedSize &&
+               count <= (mappedSize - offset) / sizeof(T);
+    }
+
+    // User `id`'s slice of a CSR table: offsets[id]..offsets[id + 1] into a
+    // section of `total` u32 values, each of which must be below `limit`.
+    // A slice that fails the checks reads as empty.
+    std::pair<const uint32_t*, const uint32_t*> slice(uint64_t offsetsOffset, uint64_t valuesOffset, uint64_t total,
+                                                      uint64_t limit, std::vector<Checked>& checked, UserId id) const {
+        const uint32_t* values = section<uint32_t>(valuesOffset);
+        if (id >= header->userCount) return {values, values};
+        const uint64_t* offsets = section<uint64_t>(offsetsOffset);
+        uint64_t from = offsets[id];
+        uint64_t to = offsets[id + 1];
+        if (checked[id] == Checked::No) {
+            bool good = from <= to && to <= total &&
+                        std::all_of(values + from, values + to, [&](uint32_t v) { return v < limit; });
+            checked[id] = good ? Checked::Good : Checked::Bad;
+        }
+        if (checked[id] == Checked::Bad) return {values, values};
+        return {values + from, values + to};
+    }
+
+    static void addString(uint64_t& poolSize, std::string_view s, MappedString& ref) {
+        ref.offset = poolSize;
+        ref.length = static_cast<uint32_t>(s.size());
+        ref.reserved = 0;
+        poolSize += s.size();
+    }
+
+public:
+    MappedSnapshot() = default;
+    MappedSnapshot(const MappedSnapshot&) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+    ~MappedSnapshot() {
+        close();
+    }
+
+    // Maps the file and checks the header and that every section lies inside
+    // it, without reading the sections, so opening costs the same for any
+    // size. Everything read afterwards is checked on access: ids and strings
+    // each time, per-user slices the first time they are read. A corrupt
+    // entry reads as empty rather than failing the open.
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(MappedHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) return false;
+
+        base = static_cast<const char*>(addr);
+        mappedSize = static_cast<size_t>(st.st_size);
+        header = section<MappedHeader>(0);
+
+        const MappedHeader& h = *header;
+        uint64_t n = h.userCount;
+        bool valid = std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 && h.version == VERSION &&
+                     h.byteOrder == ORDER_MARK && h.fileSize == mappedSize &&
+                     n < NO_USER && h.postCount <= UINT32_MAX &&
+                     fits<MappedUser>(h.usersOffset, n) &&
+                     fits<uint32_t>(h.usernameOrderOffset, n) &&
+                     fits<uint64_t>(h.adjOffsetsOffset, n + 1) &&
+                     fits<uint32_t>(h.adjacencyOffset, h.neighborCount) &&
+                     fits<uint64_t>(h.requestOffsetsOffset, n + 1) &&
+                     fits<uint32_t>(h.requestSendersOffset, h.requestCount) &&
+                     fits<int64_t>(h.requestSentAtOffset, h.requestCount) &&
+                     fits<MappedPost>(h.postsOffset, h.postCount) &&
+                     fits<uint64_t>(h.authorPostOffsetsOffset, n + 1) &&
+                     fits<uint32_t>(h.authorPostsOffset, h.postCount) &&
+                     fits<uint64_t>(h.likePairsOffset, h.likeCount) &&
+                     fits<char>(h.stringsOffset, h.stringsSize);
+        if (!valid) {
+            close();
+            return false;
+        }
+        adjChecked.assign(n, Checked::No);
+        requestChecked.assign(n, Checked::No);
+        authorPostsChecked.assign(n, Checked::No);
+        return true;
+    }
+
+    void close() {
+        if (base) {
+            ::munmap(const_cast<char*>(base), mappedSize);
+            base = nullptr;
+            header = nullptr;
+            mappedSize = 0;
+        }
+        adjChecked.clear();
+        requestChecked.clear();
+        authorPostsChecked.clear();
+    }
+
+    bool isOpen() const { return base != nullptr; }
+
+    size_t userCount() const { return header->userCount; }
+    size_t postCount() const { return header->postCount; }
+
+    std::string_view str(const MappedString& ref) const {
+        if (ref.offset > header->stringsSize || ref.length > header->stringsSize - ref.offset) {
+            return std::string_view();
+        }
+        return std::string_view(base + header->stringsOffset + ref.offset, ref.length);
+    }
+
+    // Callers pass ids below userCount() and indices below postCount().
+    const MappedUser& user(UserId id) const { return section<MappedUser>(header->usersOffset)[id]; }
+    const MappedPost& post(size_t index) const { return section<MappedPost>(header->postsOffset)[index]; }
+
+    // The author of post `index`, or NO_USER if the record names no user.
+    UserId authorOf(size_t index) const {
+        uint32_t author = post(index).author;
+        return author < header->userCount ? author : NO_USER;
+    }
+
+    // The id of the user at position `rank` in username order, or NO_USER if
+    // the entry is corrupt.
+    UserId usernameAt(size_t rank) const {
+        uint32_t id = section<uint32_t>(header->usernameOrderOffset)[rank];
+        return id < header->userCount ? id : NO_USER;
+    }
+
+    std::string_view usernameOf(UserId id) const {
+        return id < header->userCount ? str(user(id).username) : std::string_view();
+    }
+
+    // The first rank whose username is not less than `key`.
+    size_t lowerBound(std::string_view key) const {
+        const uint32_t* order = section<uint32_t>(header->usernameOrderOffset);
+        const uint32_t* it = std::lower_bound(order, order + header->userCount, key, [&](uint32_t id, std::string_view k) {
+            return usernameOf(id) < k;
+        });
+        return static_cast<size_t>(it - order);
+    }
+
+    UserId find(std::string_view username) const {
+        size_t rank = lowerBound(username);
+        if (rank < header->userCount) {
+            UserId id = usernameAt(rank);
+            if (id != NO_USER && usernameOf(id) == username) return id;
+        }
+        return NO_USER;
+    }
+
+    // Neighbours of `id`, sorted ascending.
+    std::pair<const uint32_t*, const uint32_t*> neighbors(UserId id) const {
+        return slice(header->adjOffsetsOffset, header->adjacencyOffset, header->neighborCount, header->userCount,
+                     adjChecked, id);
+    }
+
+    // Senders of the requests pending for `id`.
+    std::pair<const uint32_t*, const uint32_t*> requests(UserId id) const {
+        return slice(header->requestOffsetsOffset, header->requestSendersOffset, header->requestCount, header->userCount,
+                     requestChecked, id);
+    }
+
+    // Calls fn(from, to, sentAt) for every pending request, by recipient.
+    template <typename Fn>
+    void forEachRequest(Fn fn) const {
+        const uint32_t* senders = section<uint32_t>(header->requestSendersOffset);
+        const int64_t* sentAt = section<int64_t>(header->requestSentAtOffset);
+        for (UserId to = 0; to < header->userCount; to++) {
+            auto range = requests(to);
+            for (const uint32_t* it = range.first; it != range.second; ++it) fn(*it, to, sentAt[it - senders]);
+        }
+    }
+
+    // Post indices by `author`, ascending.
+    std::pair<const uint32_t*, const uint32_t*> posts(UserId author) const {
+        return slice(header->authorPostOffsetsOffset, header->authorPostsOffset, header->postCount, header->postCount,
+                     authorPostsChecked, author);
+    }
+
+    // Whether `user` liked `post` when the snapshot was written.
+    bool liked(UserId user, size_t post) const {
+        const uint64_t* pairs = section<uint64_t>(header->likePairsOffset);
+        uint64_t key = (static_cast<uint64_t>(user) << 32) | static_cast<uint32_t>(post);
+        return std::binary_search(pairs, pairs + header->likeCount, key);
+    }
+
+    // Writes the current state of `net` in this layout, streaming it through
+    // a FileWriter: records are written as they are visited, with string
+    // offsets counted ahead, and the strings follow in the same order. The
+    // header goes in last. Returns false on I/O error.
+    static bool write(const Network& net, const std::string& path) {
+        std::string tmp = path + ".tmp";
+        int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+
+        const size_t n = net.userCount();
+        const SortedAdjacency& csr = net.getGraph().snapshot();
+        FileWriter out(fd);
+        uint64_t poolSize = 0;
+        MappedHeader h{};
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.byteOrder = ORDER_MARK;
+        h.userCount = n;
+        h.postCount = net.postCount();
+        h.neighborCount = csr.edgeCount();
+        out.raw(&h, sizeof(h));
+
+        out.align(8);
+        h.usersOffset = out.size();
+        std::vector<uint32_t> order(n);
+        for (UserId id = 0; id < n; id++) {
+            const User& u = net.getUser(id);
+            MappedUser rec{};
+            addString(poolSize, u.getUsername(), rec.username);
+            addString(poolSize, u.getPassword(), rec.password);
+            addString(poolSize, u.getFullName(), rec.fullName);
+            addString(poolSize, u.getDetail1(), rec.detail1);
+            addString(poolSize, u.getDetail2(), rec.detail2);
+            rec.typeCode = static_cast<uint32_t>(u.getTypeCode());
+            out.raw(&rec, sizeof(rec));
+            order[id] = id;
+        }
+
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return net.getUser(a).getUsername() < net.getUser(b).getUsername();
+        });
+        h.usernameOrderOffset = out.size();
+        out.raw(order.data(), order.size() * sizeof(uint32_t));
+
+        out.align(8);
+        h.adjOffsetsOffset = out.size();
+        uint64_t offset = 0;
+        for (UserId id = 0; id <= n; id++) {
+            out.u64(offset);
+            if (id < n) offset += csr.degree(id);
+        }
+        h.adjacencyOffset = out.size();
+        for (UserId id = 0; id < n; id++) {
+            out.raw(csr.begin(id), csr.degree(id) * sizeof(uint32_t));
+        }
+
+        out.align(8);
+        h.requestOffsetsOffset = out.size();
+        offset = 0;
+        for (UserId id = 0; id <= n; id++) {
+            out.u64(offset);
+            if (id < n) offset += net.getRequests().incomingCount(id);
+        }
+        h.requestCount = offset;
+        h.requestSendersOffset = out.size();
+        for (UserId id = 0; id < n; id++) {
+            net.getRequests().forEachIncoming(id, [&](const RequestStore::Request& r) {
+                out.u32(r.from);
+            });
+        }
+        out.align(8);
+        h.requestSentAtOffset = out.size();
+        for (UserId id = 0; id < n; id++) {
+            net.getRequests().forEachIncoming(id, [&](const RequestStore::Request& r) {
+                out.u64(static_cast<uint64_t>(r.sentAt));
+            });
+        }
+
+        out.align(8);
+        h.postsOffset = out.size();
+        bool readable = true; // Every spilled post could be read back
+        for (size_t i = 0; i < net.postCount(); i++) {
+            PostView p = net.getPost(i);
+            readable = readable && p.readable;
+            MappedPost rec{};
+            addString(poolSize, p.getContent(), rec.content);
+            rec.author = p.getAuthor();
+            rec.likes = static_cast<uint32_t>(p.getLikes());
+            rec.timestamp = p.getTimestamp();
+            out.raw(&rec, sizeof(rec));
+        }
+
+        out.align(8);
+        h.authorPostOffsetsOffset = out.size();
+        offset = 0;
+        for (UserId id = 0; id <= n; id++) {
+            out.u64(offset);
+            if (id < n) offset += net.authorPosts(id).size();
+        }
+        h.authorPostsOffset = out.size();
+        for (UserId id = 0; id < n; id++) {
+            for (size_t index : net.postsOf(id)) out.u32(static_cast<uint32_t>(index));
+        }
+
+        std::vector<uint64_t> likePairs;
+        net.forEachLike([&](UserId user, size_t post) {
+            likePairs.push_back((static_cast<uint64_t>(user) << 32) | static_cast<uint32_t>(post));
+        });
+        std::sort(likePairs.begin(), likePairs.end());
+        out.align(8);
+        h.likeCount = likePairs.size();
+        h.likePairsOffset = out.size();
+        out.raw(likePairs.data(), likePairs.size() * sizeof(uint64_t));
+
+        // The pool, in the order its offsets were handed out above
+        out.align(8);
+        h.stringsOffset = out.size();
+        h.stringsSize = poolSize;
+        for (UserId id = 0; id < n; id++) {
+            const User& u = net.getUser(id);
+            for (const std::string* field : {&u.getUsername(), &u.getPassword(), &u.getFullName(), &u.getDetail1(), &u.getDetail2()}) {
+                out.raw(field->data(), field->size());
+            }
+        }
+        for (size_t i = 0; i < net.postCount(); i++) {
+            PostView p = net.getPost(i);
+            readable = readable && p.readable;
+            out.raw(p.content.data(), p.content.size());
+        }
+        h.fileSize = out.size();
+
+        bool good = readable && out.flush() && h.fileSize == h.stringsOffset + poolSize &&
+                    ::pwrite(fd, &h, sizeof(h), 0) == static_cast<ssize_t>(sizeof(h)) && ::fsync(fd) == 0;
+        ::close(fd);
+        return good && std::rename(tmp.c_str(), path.c_str()) == 0;
+    }
+};
+
+#endif // MAPPED_SNAPSHOT_HPP
@@ -0,0 +1,365 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include "Render.hpp"
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+// Latency and work counters for Network operations.
+//
+// Every thread records into its own slot: histograms and counters that only
+// that thread writes, with relaxed loads and stores rather than atomic
+// read-modify-writes, so recording never contends or takes a lock. A reader
+// merges all slots on demand (Metrics::snapshot). Slots outlive their
+// threads and are handed to the next thread that starts recording, so
+// nothing recorded is lost and the number of slots stays at the peak thread
+// count.
+
+enum class Operation {
+    Login, ViewNewsFeed, SearchUsers, CreatePost, SendRequest, ViewRequests, AcceptRequest, LikePost,
+    UnlikePost, ViewTopPosts, ViewSuggestions, ViewConnectionPath, SearchPosts,
+    ViewTrending,
+    COUNT
+};
+
+enum class Counter {
+    FeedSources,        // Per-author post lists merged into feed pages
+    FeedPosts,          // Posts shown on feed pages
+    TopPostCandidates,  // Feed posts scored for top posts
+    SearchMatches,      // Users returned by searches
+    PathVisited,        // Users reached by connection-path searches
+    RequestsExpired,
+    PostSearchScanned,  // Postings or feed posts examined by post searches
+    MutualPairsVisited, // Tracked pairs checked for a new mutual connection
+    COUNT
+};
+
+inline const char* operationName(Operation op) {
+    static const char* const names[] = {"login", "view_news_feed", "search_users", "create_post",
+                                        "send_request", "view_requests", "accept_request", "like_post",
+                                        "unlike_post", "view_top_posts", "view_suggestions", "view_connection_path",
+                                        "search_posts", "view_trending"};
+    return names[static_cast<size_t>(op)];
+}
+
+inline const char* counterName(Counter counter) {
+    static const char* const names[] = {"feed_sources", "feed_posts", "top_post_candidates", "search_matches",
+                                        "path_visited", "requests_expired", "post_search_scanned",
+                                        "mutual_pairs_visited"};
+    return names[static_cast<size_t>(counter)];
+}
+
+// Latencies in nanoseconds, counted in logarithmic buckets: each power of two
+// is split into SUB_BUCKETS equal parts, so a bucket is never wider than an
+// eighth of the values in it and percentiles are read to within that.
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 3;
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BITS;
+    static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    // Values below SUB_BUCKETS get a bucket each; above that, the bucket is
+    // the position of the top bit and the SUB_BITS bits after it.
+    static size_t bucketOf(uint64_t ns) {
+        if (ns < SUB_BUCKETS) return static_cast<size_t>(ns);
+        unsigned top = 63 - static_cast<unsigned>(__builtin_clzll(ns));
+        size_t sub = static_cast<size_t>(ns >> (top - SUB_BITS)) & (SUB_BUCKETS - 1);
+        return (top - SUB_BITS + 1) * SUB_BUCKETS + sub;
+    }
+
+    // The smallest value that falls in `bucket`.
+    static uint64_t lowerBound(size_t bucket) {
+        if (bucket < SUB_BUCKETS) return bucket;
+        size_t octave = bucket / SUB_BUCKETS;
+        return static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << (octave - 1);
+    }
+
+    void add(uint64_t ns) {
+        buckets[bucketOf(ns)]++;
+        total++;
+        sum += ns;
+        if (ns > largest) largest = ns;
+    }
+
+    void addBucket(size_t bucket, uint64_t n) {
+        buckets[bucket] += n;
+    }
+
+    void addTotals(uint64_t count, uint64_t sumNs, uint64_t maxNs) {
+        total += count;
+        sum += sumNs;
+        if (maxNs > largest) largest = maxNs;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t b = 0; b < BUCKETS; b++) buckets[b] += other.buckets[b];
+        addTotals(other.total, other.sum, other.largest);
+    }
+
+    // What was recorded after `earlier`, a copy of this histogram taken
+    // before; the maximum stays the all-time one.
+    LatencyHistogram since(const LatencyHistogram& earlier) const {
+        LatencyHistogram delta = *this;
+        for (size_t b = 0; b < BUCKETS; b++) delta.buckets[b] -= earlier.buckets[b];
+        delta.total -= earlier.total;
+        delta.sum -= earlier.sum;
+        return delta;
+    }
+
+    uint64_t count() const { return total; }
+    double meanNs() const { return total ? static_cast<double>(sum) / total : 0; }
+    uint64_t maxNs() const { return largest; }
+
+    // p in [0, 1]. The midpoint of the bucket holding that rank, capped at the maximum.
+    double percentileNs(double p) const {
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < BUCKETS; b++) {
+            seen += buckets[b];
+            if (seen >= rank) {
+                double low = static_cast<double>(lowerBound(b));
+                double high = b + 1 < BUCKETS ? static_cast<double>(lowerBound(b + 1)) : low;
+                return std::min((low + high) / 2, static_cast<double>(largest));
+            }
+        }
+        return static_cast<double>(largest);
+    }
+
+private:
+    std::array<uint64_t, BUCKETS> buckets{};
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t largest = 0;
+};
+
+struct MetricsSnapshot {
+    std::array<LatencyHistogram, static_cast<size_t>(Operation::COUNT)> operations;
+    std::array<uint64_t, static_cast<size_t>(Counter::COUNT)> counters{};
+
+    const LatencyHistogram& of(Operation op) const { return operations[static_cast<size_t>(op)]; }
+    uint64_t of(Counter counter) const { return counters[static_cast<size_t>(counter)]; }
+};
+
+class Metrics {
+private:
+    static constexpr size_t OPERATIONS = static_cast<size_t>(Operation::COUNT);
+    static constexpr size_t COUNTERS = static_cast<size_t>(Counter::COUNT);
+
+    // Written by one thread at a time, read by snapshot() at any time
+    struct Slot {
+        std::atomic<uint64_t> buckets[OPERATIONS][LatencyHistogram::BUCKETS];
+        std::atomic<uint64_t> counts[OPERATIONS];
+        std::atomic<uint64_t> sums[OPERATIONS];
+        std::atomic<uint64_t> maxes[OPERATIONS];
+        std::atomic<uint64_t> counters[COUNTERS];
+
+        Slot() {
+            for (auto& op : buckets) for (auto& b : op) b.store(0, std::memory_order_relaxed);
+            for (size_t i = 0; i < OPERATIONS; i++) {
+                counts[i].store(0, std::memory_order_relaxed);
+                sums[i].store(0, std::memory_order_relaxed);
+                maxes[i].store(0, std::memory_order_relaxed);
+            }
+            for (auto& c : counters) c.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    struct Registry {
+        std::mutex lock;
+        std::vector<std::unique_ptr<Slot>> slots;
+        std::vector<Slot*> free; // Slots whose threads have exited
+    };
+
+    static Registry& registry() {
+        static Registry* instance = new Registry(); // Never destroyed: threads may still record at exit
+        return *instance;
+    }
+
+    // Borrows a slot for the life of the calling thread.
+    class Lease {
+    public:
+        Slot* slot;
+
+        Lease() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> guard(r.lock);
+            if (!r.free.empty()) {
+                slot = r.free.back();
+                r.free.pop_back();
+            } else {
+                r.slots.push_back(std::make_unique<Slot>());
+                slot = r.slots.back().get();
+            }
+        }
+
+        ~Lease() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> guard(r.lock);
+            r.free.push_back(slot);
+        }
+    };
+
+    static Slot& mine() {
+        static thread_local Lease lease;
+        return *lease.slot;
+    }
+
+    // Only the slot's own thread writes, so a plain load and store is enough
+    static void bump(std::atomic<uint64_t>& value, uint64_t by) {
+        value.store(value.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    static std::atomic<bool>& enabledFlag() {
+        static std::atomic<bool> flag{true};
+        return flag;
+    }
+
+public:
+    // Recording is on by default; turning it off makes timers and counters
+    // no-ops (used to measure their overhead).
+    static bool enabled() { return enabledFlag().load(std::memory_order_relaxed); }
+    static void setEnabled(bool on) { enabledFlag().store(on, std::memory_order_relaxed); }
+
+    static void record(Operation op, uint64_t ns) {
+        Slot& slot = mine();
+        size_t i = static_cast<size_t>(op);
+        bump(slot.buckets[i][LatencyHistogram::bucketOf(ns)], 1);
+        bump(slot.counts[i], 1);
+        bump(slot.sums[i], ns);
+        if (ns > slot.maxes[i].load(std::memory_order_relaxed)) slot.maxes[i].store(ns, std::memory_order_relaxed);
+    }
+
+    static void count(Counter counter, uint64_t n = 1) {
+        if (enabled()) bump(mine().counters[static_cast<size_t>(counter)], n);
+    }
+
+    // Everything recorded so far, by every thread.
+    static MetricsSnapshot snapshot() {
+        MetricsSnapshot result;
+        Registry& r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        for (const auto& slot : r.slots) {
+            for (size_t i = 0; i < OPERATIONS; i++) {
+                LatencyHistogram& h = result.operations[i];
+                for (size_t b = 0; b < LatencyHistogram::BUCKETS; b++) {
+                    uint64_t n = slot->buckets[i][b].load(std::memory_order_relaxed);
+                    if (n) h.addBucket(b, n);
+                }
+                h.addTotals(slot->counts[i].load(std::memory_order_relaxed), slot->sums[i].load(std::memory_order_relaxed),
+                            slot->maxes[i].load(std::memory_order_relaxed));
+            }
+            for (size_t c = 0; c < COUNTERS; c++) {
+                result.counters[c] += slot->counters[c].load(std::memory_order_relaxed);
+            }
+        }
+        return result;
+    }
+};
+
+// Times one operation, from construction to the end of the enclosing scope.
+class OperationTimer {
+private:
+    Operation op;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit OperationTimer(Operation operation) : op(operation), active(Metrics::enabled()) {
+        if (active) start = std::chrono::steady_clock::now();
+    }
+
+    OperationTimer(const OperationTimer&) = delete;
+    OperationTimer& operator=(const OperationTimer&) = delete;
+
+    ~OperationTimer() {
+        if (!active) return;
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        Metrics::record(op, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+};
+
+// Renders every operation that has run and every counter.
+inline void viewStats(std::ostream& out = std::cout) {
+    MetricsSnapshot stats = Metrics::snapshot();
+    Renderer render(out);
+    render.heading("Performance Stats");
+    bool any = false;
+    for (size_t i = 0; i < stats.operations.size(); i++) {
+        const LatencyHistogram& h = stats.operations[i];
+        if (h.count() == 0) continue;
+        render.stat(operationName(static_cast<Operation>(i)), h.count(), h.meanNs() / 1000,
+                    h.percentileNs(0.50) / 1000, h.percentileNs(0.99) / 1000, static_cast<double>(h.maxNs()) / 1000);
+        any = true;
+    }
+    if (!any) render.message("No operations recorded yet.");
+    for (size_t c = 0; c < stats.counters.size(); c++) {
+        render.counter(counterName(static_cast<Counter>(c)), stats.counters[c]);
+    }
+}
+
+// Rewrites a file with the current stats as JSON lines every `interval`,
+// and once more when stopped. Each dump goes to a temporary file that is
+// renamed over the old one, so readers never see half a dump.
+class MetricsDumper {
+private:
+    std::string path;
+    std::chrono::milliseconds interval;
+    std::mutex lock;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread thread;
+
+    void dump() {
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream file(tmp, std::ios::trunc);
+            if (!file) return;
+            setOutputFormat(file, OutputFormat::JsonLines);
+            viewStats(file);
+            if (!file) return;
+        }
+        std::rename(tmp.c_str(), path.c_str());
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> guard(lock);
+        while (!stopping) {
+            wake.wait_for(guard, interval, [&] { return stopping; });
+            guard.unlock();
+            dump();
+            guard.lock();
+        }
+    }
+
+public:
+    MetricsDumper(const std::string& file, std::chrono::milliseconds every) : path(file), interval(every) {
+        thread = std::thread([this] { run(); });
+    }
+
+    MetricsDumper(const MetricsDumper&) = delete;
+    MetricsDumper& operator=(const MetricsDumper&) = delete;
+
+    ~MetricsDumper() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
+};
+
+#endif // METRICS_HPP
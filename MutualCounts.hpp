@@ -0,0 +1,288 @@
+#ifndef MUTUAL_COUNTS_HPP
+#define MUTUAL_COUNTS_HPP
+
+#include "ConnectionGraph.hpp"
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+// Open-addressing (linear probing) map from an unordered pair of users to
+// their mutual-connection count and how many reasons there are to keep it.
+// 16 bytes a pair; erasing shifts the rest of the probe chain back, so there
+// are no tombstones.
+class PairCounts {
+public:
+    struct Entry {
+        uint64_t key;
+        uint32_t count;
+        uint32_t refs;
+    };
+
+private:
+    static constexpr uint64_t EMPTY = UINT64_MAX;
+    std::vector<Entry> slots;
+    size_t used = 0;
+
+    static size_t hash(uint64_t key) {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Entry> old = std::move(slots);
+        slots.assign(capacity, Entry{EMPTY, 0, 0});
+        used = 0;
+        for (const Entry& e : old) {
+            if (e.key != EMPTY) *insert(e.key) = e;
+        }
+    }
+
+public:
+    // Lower id in the high half, so (a, b) and (b, a) are one pair
+    static uint64_t key(UserId a, UserId b) {
+        if (a > b) std::swap(a, b);
+        return (static_cast<uint64_t>(a) << 32) | b;
+    }
+
+    size_t size() const { return used; }
+    size_t memoryBytes() const { return slots.capacity() * sizeof(Entry); }
+
+    Entry* find(uint64_t key) {
+        if (slots.empty()) return nullptr;
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(key) & mask;; i = (i + 1) & mask) {
+            if (slots[i].key == key) return &slots[i];
+            if (slots[i].key == EMPTY) return nullptr;
+        }
+    }
+
+    const Entry* find(uint64_t key) const {
+        return const_cast<PairCounts*>(this)->find(key);
+    }
+
+    // The entry for `key`, added with no count or refs if it was missing.
+    Entry* insert(uint64_t key) {
+        // Keep the load factor under 1/2 so probe chains stay short
+        if ((used + 1) * 2 > slots.size()) rehash(slots.empty() ? 16 : slots.size() * 2);
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(key) & mask;; i = (i + 1) & mask) {
+            if (slots[i].key == key) return &slots[i];
+            if (slots[i].key == EMPTY) {
+                slots[i] = Entry{key, 0, 0};
+                used++;
+                return &slots[i];
+            }
+        }
+    }
+
+    void erase(uint64_t key) {
+        if (slots.empty()) return;
+        size_t mask = slots.size() - 1;
+        size_t i = hash(key) & mask;
+        while (slots[i].key != key) {
+            if (slots[i].key == EMPTY) return;
+            i = (i + 1) & mask;
+        }
+        // Move back any later entry whose home slot is at or before the hole
+        for (size_t j = (i + 1) & mask; slots[j].key != EMPTY; j = (j + 1) & mask) {
+            size_t home = hash(slots[j].key) & mask;
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i].key = EMPTY;
+        used--;
+    }
+
+    template <typename Fn>
+    void forEach(Fn fn) {
+        for (Entry& e : slots) {
+            if (e.key != EMPTY) fn(e);
+        }
+    }
+};
+
+// Mutual-connection counts kept up to date for the pairs of users that views
+// show them for: both ends of each pending request, and each user's most
+// recent search results. Network reports every new edge, and a count is
+// looked up in O(1) instead of intersecting two neighbour sets per view.
+//
+// A new edge (a, b) gives a tracked pair (a, y) one more mutual connection
+// if y is connected to b, and likewise for pairs (b, x). Only tracked pairs
+// are visited, never a's or b's neighbours, so the cost per edge is bounded
+// by MAX_PARTNERS however well connected a and b are. A pair whose user
+// already has MAX_PARTNERS tracked partners is not tracked, and count()
+// works it out from the graph instead.
+//
+// Searches may add pairs while other read-only calls run, so every call
+// takes the one lock. Edges are only added by Network's single writer.
+class MutualCounts {
+public:
+    static constexpr size_t MAX_PARTNERS = 256;   // Tracked pairs per user
+    static constexpr size_t RECENT_SEARCHES = 4096; // Users whose last search is tracked
+
+private:
+    struct Search {
+        UserId viewer = NO_USER;
+        std::vector<UserId> results;
+    };
+
+    mutable std::mutex lock;
+    PairCounts pairs;
+    std::unordered_map<UserId, std::vector<UserId>> partners; // Both ends of every tracked pair
+    std::vector<Search> searches;                            // Ring of RECENT_SEARCHES
+    std::unordered_map<UserId, size_t> searchSlot;           // Viewer -> index in `searches`
+    size_t nextSearch = 0;
+
+    static uint32_t intersect(const ConnectionGraph& graph, UserId a, UserId b) {
+        if (graph.degree(a) > graph.degree(b)) std::swap(a, b);
+        uint32_t count = 0;
+        graph.forEachNeighbor(a, [&](UserId n) {
+            if (graph.connected(b, n)) count++;
+        });
+        return count;
+    }
+
+    size_t partnerCount(UserId id) const {
+        auto it = partners.find(id);
+        return it == partners.end() ? 0 : it->second.size();
+    }
+
+    static void removePartner(std::vector<UserId>& list, UserId id) {
+        auto it = std::find(list.begin(), list.end(), id);
+        if (it == list.end()) return;
+        *it = list.back();
+        list.pop_back();
+    }
+
+    void trackLocked(const ConnectionGraph& graph, UserId a, UserId b) {
+        uint64_t k = PairCounts::key(a, b);
+        if (PairCounts::Entry* e = pairs.find(k)) {
+            e->refs++;
+            return;
+        }
+        if (partnerCount(a) >= MAX_PARTNERS || partnerCount(b) >= MAX_PARTNERS) return;
+        PairCounts::Entry* e = pairs.insert(k);
+        e->count = intersect(graph, a, b);
+        e->refs = 1;
+        partners[a].push_back(b);
+        partners[b].push_back(a);
+    }
+
+    void untrackLocked(UserId a, UserId b) {
+        uint64_t k = PairCounts::key(a, b);
+        PairCounts::Entry* e = pairs.find(k);
+        if (!e || --e->refs > 0) return;
+        pairs.erase(k);
+        for (int side = 0; side < 2; side++) {
+            UserId self = side ? b : a, other = side ? a : b;
+            auto it = partners.find(self);
+            removePartner(it->second, other);
+            if (it->second.empty()) partners.erase(it);
+        }
+    }
+
+public:
+    MutualCounts() : searches(RECENT_SEARCHES) {}
+
+    MutualCounts(const MutualCounts&) = delete;
+    MutualCounts& operator=(const MutualCounts&) = delete;
+
+    // Keeps (a, b) up to date until a matching untrack. Pairs tracked
+    // several times need as many untracks.
+    void track(const ConnectionGraph& graph, UserId a, UserId b) {
+        std::lock_guard<std::mutex> guard(lock);
+        trackLocked(graph, a, b);
+    }
+
+    void untrack(UserId a, UserId b) {
+        std::lock_guard<std::mutex> guard(lock);
+        untrackLocked(a, b);
+    }
+
+    // Tracks (viewer, r) for each r in `results` in place of the viewer's
+    // previous search. The oldest search is dropped once RECENT_SEARCHES
+    // users have one.
+    void trackSearch(const ConnectionGraph& graph, UserId viewer, const std::vector<UserId>& results) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = searchSlot.find(viewer);
+        size_t slot;
+        if (found != searchSlot.end()) {
+            slot = found->second;
+        } else {
+            slot = nextSearch;
+            nextSearch = (nextSearch + 1) % RECENT_SEARCHES;
+            if (searches[slot].viewer != NO_USER) searchSlot.erase(searches[slot].viewer);
+            searchSlot[viewer] = slot;
+        }
+
+        Search& search = searches[slot];
+        // Track the new pairs first so ones in both searches keep their counts
+        for (UserId r : results) {
+            if (r != viewer) trackLocked(graph, viewer, r);
+        }
+        for (UserId r : search.results) {
+            if (r != search.viewer) untrackLocked(search.viewer, r);
+        }
+        search.viewer = viewer;
+        search.results = results;
+    }
+
+    // Call after graph.addEdge(a, b) added a new edge. Returns how many
+    // tracked pairs it looked at.
+    size_t addEdge(const ConnectionGraph& graph, UserId a, UserId b) {
+        std::lock_guard<std::mutex> guard(lock);
+        size_t visited = 0;
+        for (int side = 0; side < 2; side++) {
+            UserId self = side ? b : a, other = side ? a : b;
+            auto it = partners.find(self);
+            if (it == partners.end()) continue;
+            for (UserId partner : it->second) {
+                if (partner != other && graph.connected(partner, other)) pairs.find(PairCounts::key(self, partner))->count++;
+            }
+            visited += it->second.size();
+        }
+        return visited;
+    }
+
+    // Recounts every tracked pair, after edges were added in bulk.
+    void recountAll(const ConnectionGraph& graph) {
+        std::lock_guard<std::mutex> guard(lock);
+        pairs.forEach([&](PairCounts::Entry& e) {
+            e.count = intersect(graph, static_cast<UserId>(e.key >> 32), static_cast<UserId>(e.key));
+        });
+    }
+
+    // Connections a and b have in common: O(1) if the pair is tracked.
+    size_t count(const ConnectionGraph& graph, UserId a, UserId b) const {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            const PairCounts::Entry* e = pairs.find(PairCounts::key(a, b));
+            if (e) return e->count;
+        }
+        return intersect(graph, a, b);
+    }
+
+    bool tracked(UserId a, UserId b) const {
+        std::lock_guard<std::mutex> guard(lock);
+        return pairs.find(PairCounts::key(a, b)) != nullptr;
+    }
+
+    size_t trackedPairs() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return pairs.size();
+    }
+
+    size_t memoryBytes() const {
+        std::lock_guard<std::mutex> guard(lock);
+        size_t bytes = pairs.memoryBytes() + searches.capacity() * sizeof(Search);
+        for (const auto& entry : partners) bytes += sizeof(entry) + entry.second.capacity() * sizeof(UserId);
+        for (const Search& search : searches) bytes += search.results.capacity() * sizeof(UserId);
+        return bytes;
+    }
+};
+
+#endif // MUTUAL_COUNTS_HPP
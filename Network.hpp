@@ -1,131 +1,1071 @@
-#ifndef NETWORK_HPP
-#define NETWORK_HPP
-
-#include "User.hpp"
-#include <vector>
-#include <string>
-#include <memory>
-#include <map>
-
-class Network {
-private:
-    // Using a map for efficient user lookup by username.
-    // Using unique_ptr for automatic memory management of User objects.
-    std::map<std::string, std::unique_ptr<User>> users;
-    std::vector<Post> posts;
-    std::map<std::string, std::vector<std::string>> connectionRequests; // Key: recipient, Value: list of senders
-
-public:
-    Network() = default;
-
-    User* findUser(const std::string& username) {
-        auto it = users.find(username);
-        if (it != users.end()) {
-            return it->second.get();
-        }
-        return nullptr;
-    }
-
-    bool addUser(std::unique_ptr<User> newUser) {
-        if (!newUser || findUser(newUser->getUsername())) {
-            return false; // User already exists or is null
-        }
-        users[newUser->getUsername()] = std::move(newUser);
-        return true;
-    }
-
-    User* login(const std::string& username, const std::string& password) {
-        User* user = findUser(username);
-        if (user && user->checkPassword(password)) {
-            return user;
-        }
-        return nullptr;
-    }
-
-    void sendConnectionRequest(const std::string& fromUser, const std::string& toUser) {
-        if (findUser(toUser) && fromUser != toUser) {
-            // Avoid duplicate requests
-            auto& requests = connectionRequests[toUser];
-            if (std::find(requests.begin(), requests.end(), fromUser) == requests.end()) {
-                requests.push_back(fromUser);
-                std::cout << "Connection request sent to " << toUser << ".\n";
-            } else {
-                std::cout << "You have already sent a request to " << toUser << ".\n";
-            }
-        } else {
-            std::cout << "User not found or you cannot connect with yourself.\n";
-        }
-    }
-
-    void viewConnectionRequests(const std::string& username) {
-        if (connectionRequests.find(username) == connectionRequests.end() || connectionRequests[username].empty()) {
-            std::cout << "You have no pending connection requests.\n";
-            return;
-        }
-
-        std::cout << "\n--- Pending Connection Requests ---\n";
-        for (const auto& sender : connectionRequests[username]) {
-            std::cout << "- " << sender << std::endl;
-        }
-    }
-
-    void acceptConnectionRequest(const std::string& currentUser, const std::string& requestUser) {
-        auto& requests = connectionRequests[currentUser];
-        auto it = std::find(requests.begin(), requests.end(), requestUser);
-
-        if (it != requests.end()) {
-            User* user1 = findUser(currentUser);
-            User* user2 = findUser(requestUser);
-            if (user1 && user2) {
-                user1->addConnection(requestUser);
-                user2->addConnection(currentUser);
-                requests.erase(it); // Remove the request
-                std::cout << "You are now connected with " << requestUser << ".\n";
-            }
-        } else {
-            std::cout << "No connection request found from " << requestUser << ".\n";
-        }
-    }
-
-    void createPost(const std::string& author, const std::string& content) {
-        posts.emplace_back(author, content);
-        std::cout << "Post created successfully!\n";
-    }
-
-    void viewNewsFeed(const std::string& username) {
-        User* user = findUser(username);
-        if (!user) return;
-
-        std::cout << "\n--- Your News Feed ---\n";
-        bool foundPosts = false;
-        for (const auto& post : posts) {
-            // Show posts from self or connections
-            if (post.getAuthor() == username || user->isConnectedTo(post.getAuthor())) {
-                post.display();
-                std::cout << "------------------------\n";
-                foundPosts = true;
-            }
-        }
-
-        if (!foundPosts) {
-            std::cout << "No posts to show. Connect with people to see their posts!\n";
-        }
-    }
-
-    void searchUsers(const std::string& query) {
-        std::cout << "\n--- Search Results ---\n";
-        bool found = false;
-        for (const auto& pair : users) {
-            // Simple search by username or full name
-            if (pair.first.find(query) != std::string::npos || pair.second->getFullName().find(query) != std::string::npos) {
-                std::cout << "- @" << pair.first << " (" << pair.second->getFullName() << ")\n";
-                found = true;
-            }
-        }
-        if (!found) {
-            std::cout << "No users found matching your query.\n";
-        }
-    }
-};
-
+#ifndef NETWORK_HPP
+#define NETWORK_HPP
+
+#include "User.hpp"
+#include "UsernameTable.hpp"
+#include "ConnectionGraph.hpp"
+#include "MutualCounts.hpp"
+#include "NgramIndex.hpp"
+#include "PostIndex.hpp"
+#include "TrendingTags.hpp"
+#include "RequestStore.hpp"
+#include "PostStore.hpp"
+#include "FeedMerge.hpp"
+#include "Timeline.hpp"
+#include "NetworkQueries.hpp"
+#include "LikeSet.hpp"
+#include "TopK.hpp"
+#include "FriendSuggestions.hpp"
+#include "PathFinder.hpp"
+#include "BinaryIO.hpp"
+#include "Render.hpp"
+#include "Metrics.hpp"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <chrono>
+#include <cstdint>
+
+// Notified after each successful mutation, e.g. so Storage can log it.
+class NetworkObserver {
+public:
+    virtual ~NetworkObserver() = default;
+    virtual void userAdded(const User& user) = 0;
+    virtual void postCreated(UserId author, const std::string& content, int64_t timestamp) = 0;
+    virtual void requestSent(UserId from, UserId to, int64_t sentAt) = 0;
+    virtual void requestAccepted(UserId recipient, UserId sender) = 0;
+    virtual void requestExpired(UserId from, UserId to) = 0;
+    virtual void postLiked(UserId user, size_t post) = 0;
+    virtual void postUnliked(UserId user, size_t post) = 0;
+};
+
+enum class RequestStatus {
+    Sent,
+    AlreadySent,
+    AlreadyConnected,
+    Accepted, // The other user had already asked, so the two are now connected
+    Deferred, // As Accepted, but connecting was not allowed; nothing changed
+    Invalid
+};
+
+// One post for Network::importPosts. The content is copied into the store.
+struct ImportedPost {
+    UserId author;
+    int64_t timestamp;
+    std::string_view content;
+};
+
+class Network {
+private:
+    // Each username is interned once in addUser; everything below is keyed by
+    // the resulting dense UserId. Using unique_ptr for automatic memory
+    // management of User objects.
+    UsernameTable usernames;
+    std::vector<std::unique_ptr<User>> users; // Indexed by UserId
+    PostStore posts;
+    mutable LikeSet likes; // Who likes what; the counts live in `posts`
+    RequestStore requests; // Pending connection requests
+    int64_t requestTtl = RequestStore::DEFAULT_TTL;
+
+    ConnectionGraph graph;
+    mutable MutualCounts mutual; // For pending requests and recent searches
+    NgramIndex searchIndex; // Usernames and full names, for searchUsers
+    PostIndex postIndex;    // Words of every post, for findPosts
+    TrendingTags trending;  // Hashtags of the last hour's posts
+
+    // Deeper feed pages are merged at read time from these per-author lists.
+    // Indexed by UserId.
+    PostingLists postsByAuthor; // Indices into posts, ascending
+
+    // Fan-out-on-write: each user's timeline holds references to the newest
+    // posts from themselves and their connections, so the first page of a
+    // feed is read from one ring. High-degree authors are not fanned out;
+    // their connections pull them in at read time instead. Both are indexed
+    // by UserId.
+    std::vector<Timeline> timelines;
+    std::vector<std::vector<UserId>> pulledAuthors; // High-degree connections
+
+    // Feed reads may run alongside a writer (see viewNewsFeed), so what they
+    // read per user is guarded by a stripe of these locks, by UserId: the
+    // user's timeline, pull list, posts in postsByAuthor and adjacency.
+    // Writers still run one at a time, and lock the stripe of each user they
+    // change; adding users locks every stripe, as it may move the vectors.
+    static constexpr size_t USER_STRIPES = 32;
+    mutable std::shared_mutex userLocks[USER_STRIPES];
+
+    // With a retention budget, old posts' index blocks (per author and per
+    // term) follow their bodies to disk, here
+    PagedFile spilledIndex;
+    size_t retentionLimit = 0;
+
+    NetworkObserver* observer = nullptr;
+
+    static constexpr size_t FEED_PAGE_SIZE = 10;
+    // Authors with more connections than this are not fanned out on write
+    static constexpr size_t FANOUT_LIMIT = 1000;
+    static constexpr size_t TIMELINE_CAPACITY = 200;
+    static constexpr size_t TOP_POSTS = 10;
+    static constexpr size_t SUGGESTIONS = 10;
+    static constexpr size_t POST_SEARCH_RESULTS = 20;
+    static constexpr size_t TRENDING_TAGS = 10;
+    static constexpr size_t MAX_SEPARATION = 6; // Hops searched by viewConnectionPath
+
+    static constexpr uint64_t SNAPSHOT_MAGIC_V1 = 0x31304E5350414E53ull; // "SNAPSN01"
+    static constexpr uint64_t SNAPSHOT_MAGIC_V2 = 0x32304E5350414E53ull; // "SNAPSN02": requests carry sentAt
+    static constexpr uint64_t SNAPSHOT_MAGIC_V3 = 0x33304E5350414E53ull; // "SNAPSN03": posts carry timestamps
+    static constexpr uint64_t SNAPSHOT_MAGIC_V4 = 0x34304E5350414E53ull; // "SNAPSN04": who likes which post
+    static constexpr uint64_t SNAPSHOT_MAGIC = 0x35304E5350414E53ull;    // "SNAPSN05": spilled bodies stay in segment files
+
+    using UserLock = std::unique_lock<std::shared_mutex>;
+    using SharedUserLock = std::shared_lock<std::shared_mutex>;
+
+    std::shared_mutex& stripeOf(UserId id) const { return userLocks[id % USER_STRIPES]; }
+
+    // Locks the stripes of `a` and `b`, lower stripe first.
+    std::pair<UserLock, UserLock> lockUsers(UserId a, UserId b) const {
+        size_t x = a % USER_STRIPES, y = b % USER_STRIPES;
+        UserLock first(userLocks[std::min(x, y)]);
+        UserLock second;
+        if (x != y) second = UserLock(userLocks[std::max(x, y)]);
+        return {std::move(first), std::move(second)};
+    }
+
+    // Locks every stripe, in order, until the result is destroyed.
+    std::vector<UserLock> lockAllUsers() const {
+        std::vector<UserLock> held;
+        held.reserve(USER_STRIPES);
+        for (auto& stripe : userLocks) held.emplace_back(stripe);
+        return held;
+    }
+
+    // Writers only, which see the graph as it is
+    bool isHighDegree(UserId id) const { return graph.degree(id) > FANOUT_LIMIT; }
+
+    // The newest `n` posts by an author, oldest first.
+    std::vector<size_t> recentPostsBy(UserId author, size_t n) const {
+        AuthorPosts list = authorPosts(author);
+        size_t skip = list.size() > n ? list.size() - n : 0;
+        std::vector<size_t> recent;
+        recent.reserve(list.size() - skip);
+        for (size_t i = skip; i < list.size(); i++) recent.push_back(list[i]);
+        return recent;
+    }
+
+    // Updates the pull lists for a new edge between `a` and `b`. An author
+    // who has just become high-degree starts being pulled by everyone.
+    void notePulledAuthors(UserId a, UserId b) {
+        auto pull = [&](UserId reader, UserId author) {
+            UserLock held(stripeOf(reader));
+            pulledAuthors[reader].push_back(author);
+        };
+        for (auto [author, reader] : {std::pair<UserId, UserId>(a, b), std::pair<UserId, UserId>(b, a)}) {
+            if (graph.degree(author) == FANOUT_LIMIT + 1) {
+                graph.forEachNeighbor(author, [&](UserId conn) { pull(conn, author); });
+            } else if (isHighDegree(author)) {
+                pull(reader, author);
+            }
+        }
+    }
+
+    // Recomputes every pull list, and with `refill` every timeline, from the
+    // graph and the posts, after edges were added without acceptConnection.
+    void rebuildTimelines(bool refill) {
+        for (UserId id = 0; id < users.size(); id++) {
+            std::vector<UserId> pulled;
+            graph.forEachNeighbor(id, [&](UserId conn) {
+                if (isHighDegree(conn)) pulled.push_back(conn);
+            });
+            Timeline timeline(TIMELINE_CAPACITY);
+            if (refill) {
+                FeedCursor cursor;
+                std::vector<size_t> recent = queries::feedPage(*this, id, cursor, TIMELINE_CAPACITY);
+                std::reverse(recent.begin(), recent.end());
+                timeline.merge(recent);
+            }
+            UserLock held(stripeOf(id));
+            pulledAuthors[id] = std::move(pulled);
+            if (refill) timelines[id] = std::move(timeline);
+        }
+    }
+
+    // Files post `index`, already in the store, under its author, words and
+    // tags, and in the timelines of the author and their connections.
+    void indexPost(size_t index, UserId author, int64_t timestamp, std::string_view content) {
+        {
+            UserLock held(stripeOf(author));
+            postsByAuthor.add(author, static_cast<uint32_t>(index));
+            timelines[author].push(index);
+        }
+        // High-degree authors skip the fan-out; readers pull their posts instead
+        if (!isHighDegree(author)) {
+            graph.forEachNeighbor(author, [&](UserId conn) {
+                UserLock held(stripeOf(conn));
+                timelines[conn].push(index);
+            });
+        }
+        postIndex.add(static_cast<uint32_t>(index), content);
+        trending.addPost(content, timestamp);
+    }
+
+    // Moves the index blocks of posts the store has spilled to disk.
+    void spillIndexes() {
+        postsByAuthor.spillBefore(posts.spilledPosts(), [&](uint32_t author) { return UserLock(stripeOf(author)); });
+        postIndex.spillBefore(posts.spilledPosts());
+    }
+
+    // addUser without the observer, for callers holding lockAllUsers().
+    bool addUserLocked(std::unique_ptr<User>& newUser) {
+        if (!newUser || findUser(newUser->getUsername())) {
+            return false; // User already exists or is null
+        }
+        UserId id = usernames.intern(newUser->getUsername());
+        newUser->setId(id);
+        searchIndex.add(id, newUser->getUsername(), newUser->getFullName());
+        graph.addVertex();
+        postsByAuthor.addList();
+        timelines.emplace_back(TIMELINE_CAPACITY);
+        pulledAuthors.emplace_back();
+        users.push_back(std::move(newUser));
+        return true;
+    }
+
+    // The number of high-degree connections a first feed page pulls from
+    size_t pulledCount(UserId id) const {
+        SharedUserLock held(stripeOf(id));
+        return pulledAuthors[id].size();
+    }
+
+    size_t appendPost(UserId authorId, std::string_view content, int likeCount, int64_t timestamp) {
+        size_t index = posts.append(authorId, timestamp, content, likeCount);
+        indexPost(index, authorId, timestamp, content);
+        if (retentionLimit > 0) {
+            while (residentPostBytes() > retentionLimit && posts.spillOldest()) {}
+            spillIndexes();
+            spilledIndex.flush();
+        }
+        return index;
+    }
+
+    // Shows post `index`, or says it could not be read.
+    void showPost(Renderer& render, size_t index) const {
+        auto pinned = posts.pin();
+        PostView post = posts.get(index);
+        if (post.readable) render.post(post, usernames.nameOf(post.getAuthor()));
+        else render.unreadablePost(index);
+    }
+
+public:
+    Network() = default;
+
+    // Pass nullptr to detach. Only one observer is supported.
+    void setObserver(NetworkObserver* newObserver) {
+        observer = newObserver;
+    }
+
+    User* findUser(UserId id) {
+        return id < users.size() ? users[id].get() : nullptr;
+    }
+
+    User* findUser(const std::string& username) {
+        return findUser(usernames.find(username));
+    }
+
+    UserId idOf(const std::string& username) const {
+        return usernames.find(username);
+    }
+
+    const std::string& usernameOf(UserId id) const {
+        return usernames.nameOf(id);
+    }
+
+    size_t userCount() const { return users.size(); }
+    size_t postCount() const { return posts.size(); }
+
+    // Keeps about `residentBytes` of posts in memory, counting their bodies,
+    // columns and index entries, and moves older ones to files in
+    // `directory` (see PostStore and PostingLists). Durable segment files are
+    // named by snapshots rather than copied into them, so use it with the
+    // Storage directory. Call at most once, before loading.
+    bool setPostRetention(const std::string& directory, size_t residentBytes, bool durable = false) {
+        if (!posts.setRetention(directory, residentBytes, durable) ||
+            !spilledIndex.open(directory, "cache-index.tmp")) {
+            return false;
+        }
+        postsByAuthor.spillTo(&spilledIndex);
+        postIndex.spillTo(&spilledIndex);
+        retentionLimit = std::max<size_t>(residentBytes, 1);
+        return true;
+    }
+
+    // Bytes of memory that grow with the posts kept resident, which the
+    // retention budget bounds. What stays per user or per distinct word is
+    // not counted, nor is the fixed-size trending sketch.
+    size_t residentPostBytes() const {
+        return posts.residentBytes() + postsByAuthor.memoryBytes() + postIndex.memoryBytes();
+    }
+
+    // Flushes spilled post bodies to disk; call before writing a snapshot.
+    bool syncPostSegments() {
+        return posts.syncSegments();
+    }
+
+    // Read-only views, e.g. for exporting a mapped snapshot
+    const User& getUser(UserId id) const { return *users[id]; }
+    PostView getPost(size_t index) const { return posts.get(index); }
+    const PostStore& getPosts() const { return posts; }
+    // A copy of one author's posts, ascending
+    std::vector<size_t> postsOf(UserId author) const {
+        AuthorPosts list = authorPosts(author);
+        std::vector<size_t> copy(list.size());
+        for (size_t i = 0; i < copy.size(); i++) copy[i] = list[i];
+        return copy;
+    }
+    const RequestStore& getRequests() const { return requests; }
+    const ConnectionGraph& getGraph() const { return graph; }
+    const PostIndex& getPostIndex() const { return postIndex; }
+    const TrendingTags& getTrending() const { return trending; }
+    const MutualCounts& getMutualCounts() const { return mutual; }
+
+    // One author's posts, ascending, as NetworkQueries takes them.
+    using AuthorPosts = PostingReader;
+
+    // --- The source interface of NetworkQueries.hpp ---
+    // These lock the users' stripes, so feed pages may be read alongside a
+    // writer.
+    size_t degree(UserId id) const {
+        SharedUserLock held(stripeOf(id));
+        return graph.degree(id);
+    }
+    bool connected(UserId a, UserId b) const {
+        SharedUserLock held(stripeOf(a));
+        return graph.connected(a, b);
+    }
+    // Calls fn with no lock held, on a copy of the neighbours
+    template <typename Fn>
+    void forEachNeighbor(UserId id, Fn fn) const {
+        std::vector<UserId> neighbors;
+        {
+            SharedUserLock held(stripeOf(id));
+            neighbors.reserve(graph.degree(id));
+            graph.forEachNeighbor(id, [&](UserId conn) { neighbors.push_back(conn); });
+        }
+        for (UserId conn : neighbors) fn(conn);
+    }
+    AuthorPosts authorPosts(UserId author) const { return AuthorPosts(postsByAuthor[author], &stripeOf(author)); }
+    UserId authorOf(size_t post) const { return posts.author(post); }
+    int likesOf(size_t post) const { return posts.likes(post); }
+    int64_t timestampOf(size_t post) const { return posts.timestamp(post); }
+    const SortedAdjacency& adjacency() const { return graph.snapshot(); }
+
+    // Connections `a` and `b` have in common: O(1) for the pairs views show
+    // (see MutualCounts), counted from the graph for any other.
+    size_t mutualConnections(UserId a, UserId b) const {
+        return mutual.count(graph, a, b);
+    }
+
+    bool addUser(std::unique_ptr<User> newUser) {
+        {
+            auto held = lockAllUsers();
+            if (!addUserLocked(newUser)) return false;
+        }
+        if (observer) observer->userAdded(*users.back());
+        return true;
+    }
+
+    User* login(const std::string& username, const std::string& password) {
+        OperationTimer timer(Operation::Login);
+        User* user = findUser(username);
+        if (user && user->checkPassword(password)) {
+            return user;
+        }
+        return nullptr;
+    }
+
+    // --- Core operations: validate, mutate and notify the observer, without printing ---
+
+    static int64_t currentTime() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+                   std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    // Requests older than this many seconds expire; 0 keeps them forever.
+    void setRequestTtl(int64_t seconds) {
+        requestTtl = seconds;
+    }
+
+    // --- Bulk loading (see BulkImport.hpp) ---
+    // Like addUser, acceptConnection and addPost for many items at once, with
+    // room reserved up front. The observer is not notified, so a Storage
+    // should checkpoint afterwards. Each returns how many items were added.
+
+    // Users whose username is taken are skipped.
+    size_t importUsers(std::vector<std::unique_ptr<User>>& batch) {
+        auto held = lockAllUsers();
+        size_t total = users.size() + batch.size();
+        usernames.reserve(total);
+        users.reserve(total);
+        timelines.reserve(total);
+        pulledAuthors.reserve(total);
+        graph.reserveVertices(total);
+
+        size_t added = 0;
+        for (auto& user : batch) {
+            if (addUserLocked(user)) added++;
+        }
+        return added;
+    }
+
+    // Connects each pair directly, on up to `threads` threads. Pairs that are
+    // already connected, repeated or invalid are skipped.
+    size_t importConnections(const std::vector<std::pair<UserId, UserId>>& edges, size_t threads) {
+        size_t added;
+        {
+            auto held = lockAllUsers();
+            added = graph.addEdges(edges, threads);
+        }
+        for (UserId id = 0; id < users.size(); id++) {
+            users[id]->setConnectionCount(graph.degree(id));
+        }
+        mutual.recountAll(graph);
+        if (added > 0) rebuildTimelines(posts.size() > 0);
+        return added;
+    }
+
+    // Appends the posts in the order given, after any existing ones. Posts by
+    // unknown authors are skipped.
+    size_t importPosts(const std::vector<ImportedPost>& batch) {
+        size_t added = 0;
+        for (const ImportedPost& post : batch) {
+            if (post.author >= users.size()) continue;
+            appendPost(post.author, post.content, 0, post.timestamp);
+            added++;
+        }
+        return added;
+    }
+
+    // If `to` has already asked to connect with `from`, this accepts that
+    // request instead of sending a new one. Sending may run on several
+    // threads at once, alongside read-only calls, when `mayConnect` is
+    // false: a request that would connect the two then returns Deferred
+    // without changing anything, to be retried with no other mutation
+    // running.
+    RequestStatus requestConnection(UserId from, UserId to, int64_t sentAt = currentTime(), bool mayConnect = true) {
+        if (from >= users.size() || to >= users.size() || from == to) {
+            return RequestStatus::Invalid;
+        }
+        if (graph.connected(from, to)) {
+            return RequestStatus::AlreadyConnected;
+        }
+        // Tracked and logged under the pair's shard locks, so they are
+        // ordered like the store
+        RequestStore::Insertion result = requests.insert(from, to, sentAt, true, [&] {
+            mutual.track(graph, from, to);
+            if (observer) observer->requestSent(from, to, sentAt);
+        });
+        if (result == RequestStore::Insertion::ReversePending) {
+            if (!mayConnect) return RequestStatus::Deferred;
+            acceptConnection(from, to);
+            return RequestStatus::Accepted;
+        }
+        return result == RequestStore::Insertion::Added ? RequestStatus::Sent : RequestStatus::AlreadySent;
+    }
+
+    // Returns false if `sender` has no pending request to `recipient`.
+    bool acceptConnection(UserId recipient, UserId sender) {
+        if (recipient >= users.size() || sender >= users.size() ||
+            !requests.remove(sender, recipient, [&] { mutual.untrack(sender, recipient); })) {
+            return false;
+        }
+
+        bool added;
+        {
+            auto held = lockUsers(recipient, sender);
+            added = graph.addEdge(recipient, sender);
+        }
+        if (added) {
+            Metrics::count(Counter::MutualPairsVisited, mutual.addEdge(graph, recipient, sender));
+            notePulledAuthors(recipient, sender);
+            // Backfill both timelines with the other side's recent posts
+            for (auto [reader, author] : {std::pair<UserId, UserId>(recipient, sender), std::pair<UserId, UserId>(sender, recipient)}) {
+                std::vector<size_t> recent = recentPostsBy(author, TIMELINE_CAPACITY);
+                UserLock held(stripeOf(reader));
+                timelines[reader].merge(recent);
+            }
+        }
+        users[recipient]->setConnectionCount(graph.degree(recipient));
+        users[sender]->setConnectionCount(graph.degree(sender));
+
+        if (observer) observer->requestAccepted(recipient, sender);
+        return true;
+    }
+
+    // Up to `limit` posts by `userId` and their connections that come after
+    // `cursor`, newest first; `cursor` is advanced to the next page. A first
+    // page shorter than a timeline comes from the user's timeline and their
+    // high-degree connections' newest posts; any other page is merged from
+    // the per-author lists.
+    std::vector<size_t> feedPage(UserId userId, FeedCursor& cursor, size_t limit) const {
+        if (!cursor.atStart() || limit >= TIMELINE_CAPACITY) {
+            return queries::feedPage(*this, userId, cursor, limit);
+        }
+        // One past the page, so the cursor can tell whether older posts remain.
+        // A timeline holding no more than that has never dropped a post.
+        std::vector<size_t> newest;
+        std::vector<UserId> pulled;
+        {
+            SharedUserLock held(stripeOf(userId));
+            newest = timelines[userId].newest(limit + 1);
+            pulled = pulledAuthors[userId];
+        }
+        Timeline recent(limit + 1);
+        recent.merge(newest);
+        for (UserId author : pulled) recent.merge(recentPostsBy(author, limit + 1));
+        FeedMerge<Timeline> merge;
+        merge.add(recent);
+        return merge.page(cursor, limit);
+    }
+
+    // Likes may run on several threads at once, alongside read-only calls
+    // and requestConnection, but not alongside other mutations. Each (user, post) pair counts once.
+    // Returns false if the user or post does not exist or already liked it.
+    bool addLike(UserId user, size_t post) {
+        if (user >= users.size() || post >= posts.size()) {
+            return false;
+        }
+        // Logged under the pair's shard lock, so the log orders a like and an
+        // unlike of the same pair the way memory does
+        return likes.insert(user, post, [&] {
+            posts.like(post);
+            if (observer) observer->postLiked(user, post);
+        });
+    }
+
+    // Returns false if the user did not like the post.
+    bool removeLike(UserId user, size_t post) {
+        if (user >= users.size() || post >= posts.size()) {
+            return false;
+        }
+        return likes.erase(user, post, [&] {
+            posts.unlike(post);
+            if (observer) observer->postUnliked(user, post);
+        });
+    }
+
+    bool hasLiked(UserId user, size_t post) const {
+        return likes.contains(user, post);
+    }
+
+    // Calls fn(UserId, size_t) for every like. Blocks likes meanwhile.
+    template <typename Fn>
+    void forEachLike(Fn fn) const {
+        auto held = likes.lockAll();
+        likes.forEachLocked(fn);
+    }
+
+    // Users `userId` may know, by mutual connections, best first.
+    std::vector<Suggestion> suggestions(UserId userId, size_t k) const {
+        return queries::suggestions(*this, userId, k);
+    }
+
+    // A shortest chain of connections between two users, if one has at most
+    // `maxHops` links.
+    PathResult pathBetween(UserId from, UserId to, size_t maxHops) const {
+        return queries::pathBetween(*this, from, to, maxHops);
+    }
+
+    // The `k` highest-scoring posts among the newest of the user's feed (see
+    // queries::topPosts), best first.
+    std::vector<size_t> topPosts(UserId userId, size_t k, int64_t now) const {
+        return queries::topPosts(*this, userId, k, now);
+    }
+
+    // Up to `limit` visible posts matching `query`, newest first (see
+    // queries::findPosts).
+    std::vector<size_t> findPosts(UserId userId, const std::string& query, size_t limit) const {
+        return queries::findPosts(*this, postIndex, userId, query, limit);
+    }
+
+    // Drops one pending request. Returns false if there was none.
+    bool expireRequest(UserId from, UserId to) {
+        return requests.remove(from, to, [&] {
+            mutual.untrack(from, to);
+            if (observer) observer->requestExpired(from, to);
+        });
+    }
+
+    // Drops every request older than the TTL at time `now`. Expiry is logged
+    // like any other mutation, so replaying a log does not depend on the clock.
+    // May run alongside requestConnection and read-only calls.
+    size_t expireRequests(int64_t now) {
+        if (requestTtl <= 0) return 0;
+        size_t expired = requests.expire(now - requestTtl, [&](const RequestStore::Request& r) {
+            mutual.untrack(r.from, r.to);
+            if (observer) observer->requestExpired(r.from, r.to);
+        });
+        Metrics::count(Counter::RequestsExpired, expired);
+        return expired;
+    }
+
+    // Returns false if the author does not exist.
+    bool addPost(UserId author, const std::string& content, int64_t timestamp = currentTime()) {
+        if (author >= users.size()) {
+            return false;
+        }
+        appendPost(author, content, 0, timestamp);
+        if (observer) observer->postCreated(author, content, timestamp);
+        return true;
+    }
+
+    // --- Menu operations: resolve usernames and render the outcome to `out` ---
+    // (in the stream's OutputFormat, see Render.hpp)
+
+    // With `mayConnect` false it may run alongside other requests, as
+    // requestConnection; if `toUser` had already asked it shows nothing and
+    // returns false, and should be run again with no other mutation running.
+    bool sendConnectionRequest(const std::string& fromUser, const std::string& toUser, std::ostream& out = std::cout,
+                               bool mayConnect = true) {
+        OperationTimer timer(Operation::SendRequest);
+        expireRequests(currentTime());
+        RequestStatus status = requestConnection(usernames.find(fromUser), usernames.find(toUser), currentTime(), mayConnect);
+        if (status == RequestStatus::Deferred) return false;
+        Renderer render(out);
+        if (status == RequestStatus::Sent) {
+            render.message("Connection request sent to " + toUser + ".");
+        } else if (status == RequestStatus::AlreadySent) {
+            render.message("You have already sent a request to " + toUser + ".");
+        } else if (status == RequestStatus::AlreadyConnected) {
+            render.message("You are already connected with " + toUser + ".");
+        } else if (status == RequestStatus::Accepted) {
+            render.message(toUser + " had already sent you a request. You are now connected with " + toUser + ".");
+        } else {
+            render.message("User not found or you cannot connect with yourself.");
+        }
+        return true;
+    }
+
+    // Read-only, so it may run alongside other readers: requests past the
+    // TTL are hidden here and removed by the next send or accept.
+    void viewConnectionRequests(const std::string& username, std::ostream& out = std::cout) const {
+        OperationTimer timer(Operation::ViewRequests);
+        int64_t cutoff = requestTtl > 0 ? currentTime() - requestTtl : INT64_MIN;
+        UserId id = usernames.find(username);
+        std::vector<UserId> incoming, outgoing;
+        if (id != NO_USER) {
+            requests.forEachIncoming(id, [&](const RequestStore::Request& r) {
+                if (r.sentAt > cutoff) incoming.push_back(r.from);
+            });
+            requests.forEachOutgoing(id, [&](const RequestStore::Request& r) {
+                if (r.sentAt > cutoff) outgoing.push_back(r.to);
+            });
+        }
+
+        Renderer render(out);
+        if (incoming.empty()) {
+            render.message("You have no pending connection requests.");
+        } else {
+            render.heading("Pending Connection Requests");
+            for (UserId from : incoming) render.request(usernames.nameOf(from), true, mutual.count(graph, id, from));
+        }
+
+        if (!outgoing.empty()) {
+            render.heading("Sent Requests Awaiting Reply");
+            for (UserId to : outgoing) render.request(usernames.nameOf(to), false, mutual.count(graph, id, to));
+        }
+    }
+
+    void acceptConnectionRequest(const std::string& currentUser, const std::string& requestUser, std::ostream& out = std::cout) {
+        OperationTimer timer(Operation::AcceptRequest);
+        expireRequests(currentTime());
+        if (acceptConnection(usernames.find(currentUser), usernames.find(requestUser))) {
+            Renderer(out).message("You are now connected with " + requestUser + ".");
+        } else {
+            Renderer(out).message("No connection request found from " + requestUser + ".");
+        }
+    }
+
+    void createPost(const std::string& author, const std::string& content, std::ostream& out = std::cout) {
+        OperationTimer timer(Operation::CreatePost);
+        if (addPost(usernames.find(author), content)) {
+            Renderer(out).message("Post created successfully!");
+        }
+    }
+
+    // Prints one page of the feed, newest first, and returns the cursor for
+    // the next page (atEnd() once nothing older remains). Takes only the
+    // locks of the users and posts it reads, so it may run alongside any
+    // other call, mutations included.
+    FeedCursor viewNewsFeed(const std::string& username, FeedCursor cursor = FeedCursor(),
+                            std::ostream& out = std::cout) const {
+        OperationTimer timer(Operation::ViewNewsFeed);
+        UserId userId = usernames.find(username);
+        if (userId == NO_USER) return cursor;
+
+        bool first = cursor.atStart();
+        std::vector<size_t> page = feedPage(userId, cursor, FEED_PAGE_SIZE);
+        // A first page reads the timeline and the pulled authors only
+        Metrics::count(Counter::FeedSources, first ? pulledCount(userId) + 1 : degree(userId) + 1);
+        Metrics::count(Counter::FeedPosts, page.size());
+
+        Renderer render(out);
+        render.heading(first ? "Your News Feed" : "Older Posts");
+        for (size_t index : page) {
+            showPost(render, index);
+        }
+
+        if (page.empty()) {
+            render.message(first ? "No posts to show. Connect with people to see their posts!" : "No more posts.");
+        }
+        return cursor;
+    }
+
+    void likePost(const std::string& username, size_t post, std::ostream& out = std::cout) {
+        OperationTimer timer(Operation::LikePost);
+        UserId user = usernames.find(username);
+        Renderer render(out);
+        if (user == NO_USER || post >= posts.size()) {
+            render.message("Post not found.");
+        } else if (addLike(user, post)) {
+            render.message("You liked post #" + std::to_string(post) + ".");
+        } else {
+            render.message("You already like post #" + std::to_string(post) + ".");
+        }
+    }
+
+    void unlikePost(const std::string& username, size_t post, std::ostream& out = std::cout) {
+        OperationTimer timer(Operation::UnlikePost);
+        UserId user = usernames.find(username);
+        Renderer render(out);
+        if (user == NO_USER || post >= posts.size()) {
+            render.message("Post not found.");
+        } else if (removeLike(user, post)) {
+            render.message("You unliked post #" + std::to_string(post) + ".");
+        } else {
+            render.message("You have not liked post #" + std::to_string(post) + ".");
+        }
+    }
+
+    // Likes the post, or unlikes it if the user already likes it.
+    void toggleLike(const std::string& username, size_t post, std::ostream& out = std::cout) {
+        UserId user = usernames.find(username);
+        if (user != NO_USER && post < posts.size() && hasLiked(user, post)) {
+            unlikePost(username, post, out);
+        } else {
+            likePost(username, post, out);
+        }
+    }
+
+    // The feed ranked by engagement instead of time
+    void viewTopPosts(const std::string& username, std::ostream& out = std::cout) const {
+        OperationTimer timer(Operation::ViewTopPosts);
+        UserId userId = usernames.find(username);
+        if (userId == NO_USER) return;
+
+        std::vector<size_t> top = topPosts(userId, TOP_POSTS, currentTime());
+        Renderer render(out);
+        render.heading("Top Posts");
+        for (size_t index : top) {
+            showPost(render, index);
+        }
+        if (top.empty()) {
+            render.message("No posts to show. Connect with people to see their posts!");
+        }
+    }
+
+    void viewSuggestions(const std::string& username, std::ostream& out = std::cout) const {
+        OperationTimer timer(Operation::ViewSuggestions);
+        UserId userId = usernames.find(username);
+        if (userId == NO_USER) return;
+
+        Renderer render(out);
+        render.heading("People You May Know");
+        for (const Suggestion& s : suggestions(userId, SUGGESTIONS)) {
+            render.suggestion(users[s.user]->getUsername(), users[s.user]->getFullName(), s.mutual);
+        }
+        if (graph.degree(userId) == 0) {
+            render.message("No suggestions yet. Connect with someone first!");
+        }
+    }
+
+    // Shows one shortest chain of connections from `username` to `target`.
+    void viewConnectionPath(const std::string& username, const std::string& target, std::ostream& out = std::cout) const {
+        OperationTimer timer(Operation::ViewConnectionPath);
+        UserId userId = usernames.find(username);
+        UserId targetId = usernames.find(target);
+        if (userId == NO_USER) return;
+        Renderer render(out);
+        if (targetId == NO_USER) {
+            render.message("User '" + target + "' not found.");
+            return;
+        }
+
+        PathResult result = pathBetween(userId, targetId, MAX_SEPARATION);
+        Metrics::count(Counter::PathVisited, result.visited);
+        if (!result.found) {
+            render.message("You and " + target + " are not connected within " + std::to_string(MAX_SEPARATION) + " steps.");
+            return;
+        }
+        std::vector<std::string_view> names;
+        for (UserId id : result.path) names.push_back(usernames.nameOf(id));
+        render.heading("How You're Connected");
+        render.path(names);
+    }
+
+    // Case-insensitive substring search by username or full name. Given a
+    // `viewer`, each result shows the connections it shares with them, and
+    // those counts are kept up to date until the viewer's next search.
+    void searchUsers(const std::string& query, size_t limit = 20, std::ostream& out = std::cout,
+                     UserId viewer = NO_USER) {
+        OperationTimer timer(Operation::SearchUsers);
+        bool truncated = false;
+        std::vector<UserId> matches = searchIndex.search(query, limit, truncated);
+        Metrics::count(Counter::SearchMatches, matches.size());
+        if (viewer != NO_USER) mutual.trackSearch(graph, viewer, matches);
+
+        Renderer render(out);
+        render.heading("Search Results");
+        for (UserId id : matches) {
+            if (viewer != NO_USER && id != viewer) {
+                render.user(users[id]->getUsername(), users[id]->getFullName(), mutual.count(graph, viewer, id));
+            } else {
+                render.user(users[id]->getUsername(), users[id]->getFullName());
+            }
+        }
+        if (matches.empty()) {
+            render.message("No users found matching your query.");
+        } else if (truncated) {
+            render.message("Showing the first " + std::to_string(limit) + " results. Refine your query to see more.");
+        }
+    }
+
+    void searchUsers(const std::string& username, const std::string& query, std::ostream& out = std::cout) {
+        searchUsers(query, 20, out, usernames.find(username));
+    }
+
+    // Posts you can see (yours and your connections') containing the query's words
+    void searchPosts(const std::string& username, const std::string& query, std::ostream& out = std::cout) const {
+        OperationTimer timer(Operation::SearchPosts);
+        UserId userId = usernames.find(username);
+        if (userId == NO_USER) return;
+
+        std::vector<size_t> found = findPosts(userId, query, POST_SEARCH_RESULTS);
+        Renderer render(out);
+        render.heading("Post Search Results");
+        for (size_t index : found) {
+            showPost(render, index);
+        }
+        if (found.empty()) {
+            render.message("No posts found matching your query.");
+        } else if (found.size() == POST_SEARCH_RESULTS) {
+            render.message("Showing the newest " + std::to_string(POST_SEARCH_RESULTS) + " matches. Add words to narrow the search.");
+        }
+    }
+
+    // The hashtags used by the most posts in the last hour
+    void viewTrending(std::ostream& out = std::cout) const {
+        OperationTimer timer(Operation::ViewTrending);
+        std::vector<std::pair<std::string, uint32_t>> tags = trending.top(TRENDING_TAGS, currentTime());
+        Renderer render(out);
+        render.heading("Trending Now");
+        for (const auto& tag : tags) {
+            render.trend(tag.first, tag.second);
+        }
+        if (tags.empty()) {
+            render.message("No hashtags in the last hour's posts.");
+        }
+    }
+
+    // --- Snapshots ---
+
+    // Streams the full state to `out`. `lastLsn` is the last log record it
+    // covers. Bodies spilled to durable segment files are not copied: the
+    // snapshot records the files' sizes instead, so syncPostSegments() must
+    // come first. Returns false if a spilled post cannot be read back.
+    bool writeSnapshot(FileWriter& out, uint64_t lastLsn) const {
+        // Likes may change concurrently; hold them still so the per-post
+        // counts and the (user, post) pairs agree
+        auto likesHeld = likes.lockAll();
+
+        out.u64(SNAPSHOT_MAGIC);
+        out.u64(lastLsn);
+
+        out.u32(static_cast<uint32_t>(users.size()));
+        for (const auto& user : users) {
+            out.u8(static_cast<uint8_t>(user->getTypeCode()));
+            out.str(user->getUsername());
+            out.str(user->getPassword());
+            out.str(user->getFullName());
+            out.str(user->getDetail1());
+            out.str(user->getDetail2());
+        }
+
+        // Each undirected edge once, from its lower id
+        const SortedAdjacency& csr = graph.snapshot();
+        out.u32(static_cast<uint32_t>(csr.edgeCount() / 2));
+        for (UserId a = 0; a < csr.vertexCount(); a++) {
+            for (const UserId* b = csr.begin(a); b != csr.end(a); ++b) {
+                if (a < *b) {
+                    out.u32(a);
+                    out.u32(*b);
+                }
+            }
+        }
+
+        // In send order, so expiry order survives a reload
+        out.u32(static_cast<uint32_t>(requests.size()));
+        requests.forEach([&](const RequestStore::Request& r) {
+            out.u32(r.from);
+            out.u32(r.to);
+            out.u64(static_cast<uint64_t>(r.sentAt));
+        });
+
+        // A cache's files go with this process, so those bodies are copied
+        const PostSegments& segments = posts.getSegments();
+        size_t stored = segments.isDurable() ? posts.spilledPosts() : 0;
+        out.u32(static_cast<uint32_t>(posts.size()));
+        out.u32(static_cast<uint32_t>(stored));
+        out.u32(static_cast<uint32_t>(stored > 0 ? segments.fileCount() : 0));
+        for (size_t f = 0; stored > 0 && f < segments.fileCount(); f++) out.u64(segments.fileSizes()[f]);
+        for (size_t i = 0; i < posts.size(); i++) {
+            UserId author = posts.author(i);
+            std::string_view content;
+            if (author == NO_USER || (i >= stored && !posts.content(i, content))) return false;
+            out.u32(author);
+            out.u32(static_cast<uint32_t>(posts.likes(i)));
+            out.u64(static_cast<uint64_t>(posts.timestamp(i)));
+            if (i >= stored) out.str(content);
+        }
+
+        out.u32(static_cast<uint32_t>(likes.sizeLocked()));
+        likes.forEachLocked([&](UserId user, size_t post) {
+            out.u32(user);
+            out.u32(static_cast<uint32_t>(post));
+        });
+
+        out.flush();
+        out.u32(out.checksum());
+        return true;
+    }
+
+    // Loads the snapshot in file `fd` into an empty Network without notifying
+    // the observer, checking its CRC first and then decoding it a piece at a
+    // time. Segment files it names are looked for in `segmentDirectory`
+    // unless setPostRetention chose one. Returns false if the data is
+    // malformed; `lastLsn` receives the covered lsn.
+    bool readSnapshot(int fd, uint64_t& lastLsn, const std::string& segmentDirectory) {
+        uint64_t size;
+        if (!fileCrcMatches(fd, size)) return false;
+        FileReader in(fd, size);
+        uint64_t magic = in.u64();
+        if (magic != SNAPSHOT_MAGIC && magic != SNAPSHOT_MAGIC_V4 && magic != SNAPSHOT_MAGIC_V3 &&
+            magic != SNAPSHOT_MAGIC_V2 && magic != SNAPSHOT_MAGIC_V1) {
+            return false;
+        }
+        int64_t loadedAt = currentTime(); // For records older formats did not timestamp
+        lastLsn = in.u64();
+
+        NetworkObserver* saved = observer;
+        observer = nullptr;
+
+        {
+            auto held = lockAllUsers();
+            uint32_t userTotal = in.u32();
+            for (uint32_t i = 0; i < userTotal && in.ok(); i++) {
+                char type = static_cast<char>(in.u8());
+                std::string uname = in.str();
+                std::string pwd = in.str();
+                std::string name = in.str();
+                std::string detail1 = in.str();
+                std::string detail2 = in.str();
+                auto user = makeUser(type, uname, pwd, name, detail1, detail2);
+                addUserLocked(user);
+            }
+
+            uint32_t edgeTotal = in.u32();
+            for (uint32_t i = 0; i < edgeTotal && in.ok(); i++) {
+                UserId a = in.u32();
+                UserId b = in.u32();
+                if (a < users.size() && b < users.size()) graph.addEdge(a, b);
+            }
+        }
+        for (UserId id = 0; id < users.size(); id++) {
+            users[id]->setConnectionCount(graph.degree(id));
+        }
+        // The posts below fill the timelines
+        rebuildTimelines(false);
+
+        uint32_t requestTotal = in.u32();
+        for (uint32_t i = 0; i < requestTotal && in.ok(); i++) {
+            UserId from = in.u32();
+            UserId to = in.u32();
+            int64_t sentAt = magic != SNAPSHOT_MAGIC_V1 ? static_cast<int64_t>(in.u64()) : loadedAt;
+            requestConnection(from, to, sentAt);
+        }
+
+        uint32_t postTotal = in.u32();
+        uint32_t storedTotal = 0; // Posts whose bodies are in segment files
+        std::vector<uint64_t> segmentSizes;
+        if (magic == SNAPSHOT_MAGIC) {
+            storedTotal = in.u32();
+            uint32_t fileTotal = in.u32();
+            for (uint32_t f = 0; f < fileTotal && in.ok(); f++) segmentSizes.push_back(in.u64());
+        }
+        if (!in.ok() || storedTotal > postTotal ||
+            !posts.adoptSegments(segmentDirectory, segmentSizes, storedTotal)) {
+            observer = saved;
+            return false;
+        }
+        for (uint32_t i = 0; i < postTotal && in.ok(); i++) {
+            UserId author = in.u32();
+            int likeCount = static_cast<int>(in.u32());
+            // Likes and segment files refer to posts by position, so a post
+            // cannot be dropped without pointing them at the wrong ones
+            if (!in.ok() || author >= users.size()) {
+                observer = saved;
+                return false;
+            }
+            if (magic == SNAPSHOT_MAGIC) {
+                int64_t timestamp = static_cast<int64_t>(in.u64());
+                if (i < storedTotal) {
+                    // Its body is already on disk under this post number
+                    size_t index = posts.appendStored(author, timestamp, likeCount);
+                    std::string_view content;
+                    if (index == SIZE_MAX || !posts.content(index, content)) {
+                        observer = saved;
+                        return false;
+                    }
+                    indexPost(index, author, timestamp, content);
+                    if (retentionLimit > 0) spillIndexes();
+                } else {
+                    appendPost(author, in.str(), likeCount, timestamp);
+                }
+                continue;
+            }
+            std::string content = in.str();
+            bool timed = magic == SNAPSHOT_MAGIC_V4 || magic == SNAPSHOT_MAGIC_V3;
+            int64_t timestamp = timed ? static_cast<int64_t>(in.u64()) : loadedAt;
+            appendPost(author, content, likeCount, timestamp);
+        }
+
+        // The counts above already include these likes
+        uint32_t likeTotal = magic == SNAPSHOT_MAGIC || magic == SNAPSHOT_MAGIC_V4 ? in.u32() : 0;
+        for (uint32_t i = 0; i < likeTotal && in.ok(); i++) {
+            UserId user = in.u32();
+            size_t post = in.u32();
+            if (in.ok() && (user >= users.size() || post >= posts.size())) {
+                observer = saved;
+                return false;
+            }
+            likes.insert(user, post, [] {});
+        }
+
+        observer = saved;
+        return spilledIndex.flush() && in.ok();
+    }
+};
+
 #endif // NETWORK_HPP
\ No newline at end of file
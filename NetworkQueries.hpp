@@ -0,0 +1,122 @@
+#ifndef NETWORK_QUERIES_HPP
+#define NETWORK_QUERIES_HPP
+
+#include "FeedMerge.hpp"
+#include "PostIndex.hpp"
+#include "TopK.hpp"
+#include "FriendSuggestions.hpp"
+#include "PathFinder.hpp"
+#include "Metrics.hpp"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// The read-side algorithms of a network, shared by Network and MappedNetwork.
+//
+// `Source` is any network that keeps one ascending list of post indices per
+// author and provides:
+//   userCount(), postCount()
+//   degree(id), forEachNeighbor(id, fn), connected(a, b)
+//   authorPosts(author): that author's list by value, a cheap view with
+//   size() and operator[]
+//   authorOf(post), likesOf(post), timestampOf(post)
+//   adjacency(): a CSR view of the graph, as suggestConnections and
+//   PathFinder take it
+namespace queries {
+
+// Newest posts considered by topPosts
+constexpr size_t TOP_POST_CANDIDATES = 500;
+// Past this many authors findPosts estimates how many posts a user can see
+constexpr size_t EXACT_VISIBLE_SOURCES = 256;
+
+// Up to `limit` posts by `user` and their connections that come after
+// `cursor`, newest first; `cursor` is advanced to the next page.
+template <typename Source>
+std::vector<size_t> feedPage(const Source& source, UserId user, FeedCursor& cursor, size_t limit) {
+    using List = decltype(source.authorPosts(user));
+    std::vector<List> lists;
+    lists.reserve(source.degree(user) + 1);
+    lists.push_back(source.authorPosts(user));
+    source.forEachNeighbor(user, [&](UserId conn) { lists.push_back(source.authorPosts(conn)); });
+
+    FeedMerge<List> merge;
+    for (const List& list : lists) merge.add(list);
+    return merge.page(cursor, limit);
+}
+
+// The `k` highest-scoring posts among the newest TOP_POST_CANDIDATES of the
+// user's feed, ranked by engagementScore at time `now`, best first.
+template <typename Source>
+std::vector<size_t> topPosts(const Source& source, UserId user, size_t k, int64_t now) {
+    FeedCursor cursor;
+    TopK<size_t> best(k);
+    std::vector<size_t> candidates = feedPage(source, user, cursor, TOP_POST_CANDIDATES);
+    for (size_t index : candidates) {
+        best.offer(engagementScore(source.likesOf(index), now - source.timestampOf(index)), index);
+    }
+    Metrics::count(Counter::FeedSources, source.degree(user) + 1);
+    Metrics::count(Counter::TopPostCandidates, candidates.size());
+    std::vector<size_t> result;
+    for (const auto& entry : best.sorted()) result.push_back(entry.second);
+    return result;
+}
+
+// Up to `limit` posts by `user` or their connections that match `query`
+// (see PostIndex::parse), newest first. Walks whichever should reach `limit`
+// matches sooner: the posts the user can see, testing each against `index`,
+// or the query's posting lists, testing each post's author.
+template <typename Source>
+std::vector<size_t> findPosts(const Source& source, const PostIndex& index, UserId user,
+                              const std::string& query, size_t limit) {
+    std::vector<size_t> result;
+    PostQuery parsed = index.parse(query);
+    if (user >= source.userCount() || parsed.empty()) return result;
+
+    // Counting exactly would touch every connection's list, so past
+    // EXACT_VISIBLE_SOURCES authors the average per user stands in
+    size_t sources = source.degree(user) + 1;
+    size_t visibleCount = sources * source.postCount() / source.userCount();
+    if (sources <= EXACT_VISIBLE_SOURCES) {
+        visibleCount = source.authorPosts(user).size();
+        source.forEachNeighbor(user, [&](UserId conn) { visibleCount += source.authorPosts(conn).size(); });
+    }
+
+    size_t scanned = 0;
+    if (parsed.preferVisibleWalk(visibleCount, sources, source.postCount(), limit)) {
+        FeedCursor cursor;
+        for (size_t page = 256; result.size() < limit && !cursor.atEnd(); page *= 2) {
+            for (size_t post : feedPage(source, user, cursor, page)) {
+                scanned++;
+                if (!parsed.matches(static_cast<uint32_t>(post))) continue;
+                result.push_back(post);
+                if (result.size() == limit) break;
+            }
+        }
+    } else {
+        auto visible = [&](uint32_t post) {
+            UserId author = source.authorOf(post);
+            return author == user || source.connected(user, author);
+        };
+        for (uint32_t post : parsed.newest(limit, visible, scanned)) result.push_back(post);
+    }
+    Metrics::count(Counter::PostSearchScanned, scanned);
+    return result;
+}
+
+// Users `user` may know, by mutual connections, best first.
+template <typename Source>
+std::vector<Suggestion> suggestions(const Source& source, UserId user, size_t k) {
+    return suggestConnections(source.adjacency(), user, k);
+}
+
+// A shortest chain of connections between two users, if one has at most
+// `maxHops` links. Each thread reuses its own search buffers.
+template <typename Source>
+PathResult pathBetween(const Source& source, UserId from, UserId to, size_t maxHops) {
+    static thread_local PathFinder finder;
+    return finder.find(source.adjacency(), from, to, maxHops);
+}
+
+} // namespace queries
+
+#endif // NETWORK_QUERIES_HPP
@@ -0,0 +1,132 @@
+#ifndef NGRAM_INDEX_HPP
+#define NGRAM_INDEX_HPP
+
+#include "UsernameTable.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+
+// Case-insensitive inverted index over usernames and full names.
+// Every 1-, 2- and 3-gram of the lowercased fields maps to an ascending posting
+// list of UserIds. A query of up to three characters is answered directly from
+// its own posting list; longer queries intersect the lists of their trigrams,
+// starting from the shortest, and only the surviving candidates are verified.
+class NgramIndex {
+private:
+    struct Entry {
+        std::string username; // Lowercased
+        std::string fullName; // Lowercased
+    };
+
+    std::unordered_map<uint32_t, std::vector<UserId>> postings;
+    std::vector<Entry> entries; // Indexed by UserId
+
+    static std::string lower(const std::string& s) {
+        std::string out(s);
+        for (char& c : out) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return out;
+    }
+
+    // Packs an n-gram (n <= 3) and its length into a single key.
+    static uint32_t gramKey(const char* p, size_t n) {
+        uint32_t key = static_cast<uint32_t>(n) << 24;
+        for (size_t i = 0; i < n; i++) {
+            key |= static_cast<uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+        }
+        return key;
+    }
+
+    void indexField(const std::string& field, UserId id) {
+        for (size_t n = 1; n <= 3; n++) {
+            for (size_t i = 0; i + n <= field.size(); i++) {
+                auto& list = postings[gramKey(field.data() + i, n)];
+                // Ids arrive in ascending order, so a repeated gram only ever
+                // needs checking against the tail
+                if (list.empty() || list.back() != id) {
+                    list.push_back(id);
+                }
+            }
+        }
+    }
+
+    const std::vector<UserId>* find(const char* p, size_t n) const {
+        auto it = postings.find(gramKey(p, n));
+        return it != postings.end() ? &it->second : nullptr;
+    }
+
+    bool matches(UserId id, const std::string& loweredQuery) const {
+        const Entry& e = entries[id];
+        return e.username.find(loweredQuery) != std::string::npos ||
+               e.fullName.find(loweredQuery) != std::string::npos;
+    }
+
+public:
+    size_t size() const { return entries.size(); }
+
+    // Must be called with ids in the order they were assigned by addUser.
+    void add(UserId id, const std::string& username, const std::string& fullName) {
+        if (entries.size() <= id) entries.resize(id + 1);
+        entries[id] = {lower(username), lower(fullName)};
+        indexField(entries[id].username, id);
+        indexField(entries[id].fullName, id);
+    }
+
+    // Up to `limit` matching ids in ascending order. `truncated` is set when
+    // more matches may exist beyond the limit.
+    std::vector<UserId> search(const std::string& query, size_t limit, bool& truncated) const {
+        std::vector<UserId> results;
+        truncated = false;
+        std::string q = lower(query);
+
+        if (q.empty()) {
+            // Everything matches the empty string
+            for (UserId id = 0; id < entries.size() && results.size() < limit; id++) {
+                results.push_back(id);
+            }
+            truncated = entries.size() > limit;
+            return results;
+        }
+
+        if (q.size() <= 3) {
+            const std::vector<UserId>* list = find(q.data(), q.size());
+            if (!list) return results;
+            size_t n = std::min(limit, list->size());
+            results.assign(list->begin(), list->begin() + n);
+            truncated = list->size() > limit;
+            return results;
+        }
+
+        std::vector<const std::vector<UserId>*> lists;
+        for (size_t i = 0; i + 3 <= q.size(); i++) {
+            const std::vector<UserId>* list = find(q.data() + i, 3);
+            if (!list) return results; // Some trigram never occurs
+            lists.push_back(list);
+        }
+        std::sort(lists.begin(), lists.end(), [](const std::vector<UserId>* a, const std::vector<UserId>* b) {
+            return a->size() < b->size();
+        });
+
+        // Walk the shortest list and probe the others by binary search, so the
+        // work is bounded by the rarest trigram rather than the user count
+        for (UserId id : *lists[0]) {
+            bool inAll = true;
+            for (size_t i = 1; i < lists.size() && inAll; i++) {
+                inAll = std::binary_search(lists[i]->begin(), lists[i]->end(), id);
+            }
+            if (!inAll || !matches(id, q)) continue;
+            if (results.size() == limit) {
+                truncated = true;
+                break;
+            }
+            results.push_back(id);
+        }
+        return results;
+    }
+};
+
+#endif // NGRAM_INDEX_HPP
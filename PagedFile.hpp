@@ -0,0 +1,320 @@
+#ifndef PAGED_FILE_HPP
+#define PAGED_FILE_HPP
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+// A scratch file for data moved out of memory and read back at random, such
+// as the columns and index entries of old posts.
+//
+// The file is unlinked as soon as it is created, so it goes with the process
+// and never needs cleaning up; whatever it holds must be rebuilt from the
+// snapshot after a restart. Reads go through a per-thread cache of
+// CACHE_PAGES pages of PAGE bytes, shared by every PagedFile. Writes collect
+// in dirty pages that reads see, and reach the file on flush(), or once
+// MAX_DIRTY_PAGES are dirty; a flush makes every thread drop its cached
+// copies of this file.
+//
+// Any calls may run on many threads at once: reads share a lock that
+// allocate, write, flush and writeDirect take exclusively. writeDirect is
+// meant for a few values changed in place while others read (see
+// PostStore's like counts).
+class PagedFile {
+public:
+    static constexpr size_t PAGE = 4096;
+    static constexpr size_t CACHE_PAGES = 64;
+    static constexpr size_t MAX_DIRTY_PAGES = 256;
+
+private:
+    struct CachedPage {
+        uint64_t owner = 0; // PagedFile::id; 0 = unused
+        uint64_t version = 0;
+        uint64_t page = 0;
+        uint64_t lastUse = 0;
+        char data[PAGE];
+    };
+
+    int fd = -1;
+    std::string path;
+    uint64_t length = 0;  // Bytes allocated, flushed or not
+    uint64_t flushed = 0; // Bytes the file itself covers
+    std::unordered_map<uint64_t, std::unique_ptr<char[]>> dirty; // Page -> contents
+    std::atomic<uint64_t> version{1}; // Cached pages of older versions are stale
+    mutable std::atomic<bool> reported{false};
+    bool failed = false; // A write failed; nothing more is written
+    uint64_t id;
+    mutable std::shared_mutex lock; // Shared by reads
+
+    static uint64_t nextId() {
+        static std::atomic<uint64_t> next{1};
+        return next.fetch_add(1);
+    }
+
+    static std::array<CachedPage, CACHE_PAGES>& cache() {
+        static thread_local std::array<CachedPage, CACHE_PAGES> pages;
+        return pages;
+    }
+
+    // Says once, on stderr, that the file let us down.
+    void report(const char* what) const {
+        if (!reported.exchange(true)) {
+            std::cerr << "Cannot " << what << " " << path << ": " << std::strerror(errno) << "\n";
+        }
+    }
+
+    // Reads page `page` from the file, zero-filled past its end.
+    bool readPage(uint64_t page, char* out) const {
+        size_t got = 0;
+        uint64_t offset = page * PAGE;
+        while (offset + got < flushed && got < PAGE) {
+            ssize_t n = ::pread(fd, out + got, PAGE - got, static_cast<off_t>(offset + got));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                report("read");
+                return false;
+            }
+            got += static_cast<size_t>(n);
+        }
+        std::memset(out + got, 0, PAGE - got);
+        return true;
+    }
+
+    const char* dirtyPage(uint64_t page) const {
+        if (dirty.empty()) return nullptr;
+        auto it = dirty.find(page);
+        return it == dirty.end() ? nullptr : it->second.get();
+    }
+
+    // The cached copy of `page`, read in if needed; null if it cannot be.
+    const char* cachedPage(uint64_t page) const {
+        if (const char* d = dirtyPage(page)) return d;
+        static thread_local uint64_t clock = 0;
+        uint64_t current = version.load(std::memory_order_acquire);
+        auto& slots = cache();
+        CachedPage* slot = &slots[0];
+        for (CachedPage& cached : slots) {
+            if (cached.owner == id && cached.page == page && cached.version == current) {
+                cached.lastUse = ++clock;
+                return cached.data;
+            }
+            if (cached.lastUse < slot->lastUse) slot = &cached;
+        }
+        if (!readPage(page, slot->data)) {
+            slot->owner = 0;
+            return nullptr;
+        }
+        slot->owner = id;
+        slot->page = page;
+        slot->version = current;
+        slot->lastUse = ++clock;
+        return slot->data;
+    }
+
+    // Writes out the dirty pages; callers hold `lock` exclusively.
+    bool flushDirty() {
+        if (dirty.empty()) return !failed;
+        std::vector<uint64_t> pages;
+        pages.reserve(dirty.size());
+        for (const auto& entry : dirty) pages.push_back(entry.first);
+        std::sort(pages.begin(), pages.end());
+        for (uint64_t page : pages) {
+            if (failed) break;
+            uint64_t offset = page * PAGE;
+            size_t n = static_cast<size_t>(std::min<uint64_t>(PAGE, length - offset));
+            const char* p = dirty[page].get();
+            for (size_t done = 0; done < n;) {
+                ssize_t written = ::pwrite(fd, p + done, n - done, static_cast<off_t>(offset + done));
+                if (written < 0 && errno == EINTR) continue;
+                if (written <= 0) {
+                    report("write");
+                    failed = true;
+                    break;
+                }
+                done += static_cast<size_t>(written);
+            }
+            flushed = std::max<uint64_t>(flushed, offset + n);
+        }
+        dirty.clear();
+        version.fetch_add(1, std::memory_order_release);
+        return !failed;
+    }
+
+public:
+    PagedFile() : id(nextId()) {}
+
+    PagedFile(const PagedFile&) = delete;
+    PagedFile& operator=(const PagedFile&) = delete;
+
+    ~PagedFile() {
+        if (fd >= 0) ::close(fd);
+    }
+
+    // Creates the file `name` in `directory` and unlinks it straight away.
+    // Returns false if it cannot be created.
+    bool open(const std::string& directory, const std::string& name) {
+        path = directory + "/" + name;
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0) return false;
+        ::unlink(path.c_str());
+        return true;
+    }
+
+    bool isOpen() const { return fd >= 0; }
+
+    bool ok() const {
+        std::shared_lock<std::shared_mutex> held(lock);
+        return !failed;
+    }
+
+    uint64_t size() const {
+        std::shared_lock<std::shared_mutex> held(lock);
+        return length;
+    }
+
+    // Reserves `n` zeroed bytes at the end and returns where they start.
+    uint64_t allocate(size_t n) {
+        std::unique_lock<std::shared_mutex> held(lock);
+        uint64_t offset = length;
+        length += n;
+        return offset;
+    }
+
+    // Copies `n` bytes at `offset` into `out`. False if they are beyond the
+    // end or cannot be read.
+    bool read(uint64_t offset, void* out, size_t n) const {
+        std::shared_lock<std::shared_mutex> held(lock);
+        if (offset + n > length) return false;
+        char* to = static_cast<char*>(out);
+        while (n > 0) {
+            size_t within = static_cast<size_t>(offset % PAGE);
+            size_t take = std::min(n, PAGE - within);
+            const char* page = cachedPage(offset / PAGE);
+            if (!page) return false;
+            std::memcpy(to, page + within, take);
+            to += take;
+            offset += take;
+            n -= take;
+        }
+        return true;
+    }
+
+    // Writes `n` bytes at `offset`, growing the file if they run past its
+    // end. False once a write has failed.
+    bool write(uint64_t offset, const void* data, size_t n) {
+        std::unique_lock<std::shared_mutex> held(lock);
+        const char* from = static_cast<const char*>(data);
+        length = std::max<uint64_t>(length, offset + n);
+        while (n > 0 && !failed) {
+            uint64_t page = offset / PAGE;
+            size_t within = static_cast<size_t>(offset % PAGE);
+            size_t take = std::min(n, PAGE - within);
+            std::unique_ptr<char[]>& d = dirty[page];
+            if (!d) {
+                d.reset(new char[PAGE]);
+                if (!readPage(page, d.get())) failed = true;
+            }
+            std::memcpy(d.get() + within, from, take);
+            from += take;
+            offset += take;
+            n -= take;
+        }
+        if (dirty.size() >= MAX_DIRTY_PAGES) flushDirty();
+        return !failed;
+    }
+
+    // Writes out the dirty pages. False once a write has failed.
+    bool flush() {
+        std::unique_lock<std::shared_mutex> held(lock);
+        return flushDirty();
+    }
+
+    // Overwrites `n` bytes at `offset`, within one page, while readers may
+    // be running: the bytes go straight to the file and every thread's
+    // cached pages of it are dropped. Each value must be changed by one
+    // thread at a time.
+    bool writeDirect(uint64_t offset, const void* data, size_t n) {
+        std::unique_lock<std::shared_mutex> held(lock);
+        bool good = true;
+        if (char* d = const_cast<char*>(dirtyPage(offset / PAGE))) {
+            std::memcpy(d + offset % PAGE, data, n);
+        } else if (::pwrite(fd, data, n, static_cast<off_t>(offset)) != static_cast<ssize_t>(n)) {
+            report("write");
+            good = false;
+        }
+        version.fetch_add(1, std::memory_order_release);
+        return good;
+    }
+
+    size_t memoryBytes() const {
+        std::shared_lock<std::shared_mutex> held(lock);
+        return dirty.size() * PAGE;
+    }
+};
+
+// An append-only list of fixed-size records in a PagedFile, laid out in
+// extents that double in size: extent k holds FIRST << k records, so record
+// i is found with one read and a list of n records keeps only about
+// log2(n / FIRST) file offsets in memory. At most half of the space
+// reserved is unused.
+template <typename Record>
+class ExtentList {
+public:
+    static constexpr size_t FIRST = 16;
+
+private:
+    std::vector<uint64_t> extents; // File offset of each
+    size_t count = 0;
+
+    // The extent holding record `i`, and its first record
+    static size_t extentOf(size_t i, size_t& first) {
+        size_t k = 63 - static_cast<size_t>(__builtin_clzll(i / FIRST + 1));
+        first = FIRST * ((size_t(1) << k) - 1);
+        return k;
+    }
+
+public:
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Appends `n` records. False if the file write failed.
+    bool append(PagedFile& file, const Record* records, size_t n) {
+        bool good = true;
+        while (n > 0) {
+            size_t first;
+            size_t k = extentOf(count, first);
+            if (k == extents.size()) extents.push_back(file.allocate((FIRST << k) * sizeof(Record)));
+            size_t take = std::min(n, first + (FIRST << k) - count);
+            uint64_t offset = extents[k] + (count - first) * sizeof(Record);
+            good = file.write(offset, records, take * sizeof(Record)) && good;
+            records += take;
+            count += take;
+            n -= take;
+        }
+        return good;
+    }
+
+    // Record `i` < size(). False if it cannot be read.
+    bool get(const PagedFile& file, size_t i, Record& out) const {
+        size_t first;
+        size_t k = extentOf(i, first);
+        return file.read(extents[k] + (i - first) * sizeof(Record), &out, sizeof(Record));
+    }
+
+    size_t memoryBytes() const { return extents.capacity() * sizeof(uint64_t); }
+};
+
+#endif // PAGED_FILE_HPP
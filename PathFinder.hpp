@@ -0,0 +1,130 @@
+#ifndef PATH_FINDER_HPP
+#define PATH_FINDER_HPP
+
+#include "UsernameTable.hpp"
+#include "SetIntersection.hpp"
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+struct PathResult {
+    bool found = false;
+    size_t hops = 0;           // Connections between the two users; 0 if they are the same
+    std::vector<UserId> path;  // From the first user to the second, both included
+    size_t visited = 0;        // Vertices reached by the search
+};
+
+// Shortest paths between two users by bidirectional breadth-first search.
+//
+// Both ends search outwards a level at a time, always growing the side whose
+// frontier has fewer outgoing edges, and stop when either side reaches a
+// vertex the other has seen. Two searches of depth d/2 reach far fewer
+// vertices than one of depth d on a social graph, whose neighbourhoods grow
+// geometrically.
+//
+// The visited bitmaps, parent links and frontiers are kept between queries
+// and only the entries a query touched are reset, so a query costs what it
+// explores, not the size of the graph. Not safe to share between threads.
+class PathFinder {
+private:
+    IdBitmap seen[2]; // [0] from the source, [1] from the target
+    std::vector<uint32_t> parent[2];
+    std::vector<uint32_t> touched[2];
+    std::vector<uint32_t> frontier[2];
+    std::vector<uint32_t> next;
+    size_t capacity = 0;
+
+    void prepare(size_t n) {
+        if (n <= capacity) return;
+        for (int side = 0; side < 2; side++) {
+            seen[side] = IdBitmap(n);
+            parent[side].resize(n);
+        }
+        capacity = n;
+    }
+
+    void mark(int side, uint32_t id, uint32_t from) {
+        seen[side].set(id);
+        parent[side][id] = from;
+        touched[side].push_back(id);
+    }
+
+    void reset() {
+        for (int side = 0; side < 2; side++) {
+            for (uint32_t id : touched[side]) seen[side].reset(id);
+            touched[side].clear();
+            frontier[side].clear();
+        }
+    }
+
+    template <typename Graph>
+    static size_t degree(const Graph& graph, uint32_t v) {
+        return static_cast<size_t>(graph.end(v) - graph.begin(v));
+    }
+
+public:
+    // A shortest path of at most `maxHops` connections from `from` to `to`.
+    //
+    // `Graph` is any CSR-like view: vertexCount(), and begin(v)/end(v) over
+    // v's neighbours (e.g. SortedAdjacency).
+    template <typename Graph>
+    PathResult find(const Graph& graph, UserId from, UserId to, size_t maxHops) {
+        PathResult result;
+        size_t n = graph.vertexCount();
+        if (from >= n || to >= n) return result;
+        if (from == to) {
+            result.found = true;
+            result.path.push_back(from);
+            result.visited = 1;
+            return result;
+        }
+
+        prepare(n);
+        mark(0, from, NO_USER);
+        mark(1, to, NO_USER);
+        frontier[0].push_back(from);
+        frontier[1].push_back(to);
+        size_t depth[2] = {0, 0};
+        size_t cost[2] = {degree(graph, from), degree(graph, to)};
+
+        // A vertex reached by one side that the other has already seen lies
+        // on a shortest path: any shorter meeting would have been found when
+        // the earlier of its two halves was explored
+        uint32_t meet = NO_USER;
+        while (meet == NO_USER && !frontier[0].empty() && !frontier[1].empty() && depth[0] + depth[1] < maxHops) {
+            int side = cost[0] <= cost[1] ? 0 : 1;
+            int other = 1 - side;
+            next.clear();
+            size_t nextCost = 0;
+            for (uint32_t u : frontier[side]) {
+                for (const uint32_t* v = graph.begin(u); v != graph.end(u); ++v) {
+                    if (seen[side].test(*v)) continue;
+                    mark(side, *v, u);
+                    if (seen[other].test(*v)) {
+                        meet = *v;
+                        break;
+                    }
+                    next.push_back(*v);
+                    nextCost += degree(graph, *v);
+                }
+                if (meet != NO_USER) break;
+            }
+            frontier[side].swap(next);
+            cost[side] = nextCost;
+            depth[side]++;
+        }
+
+        result.visited = touched[0].size() + touched[1].size();
+        if (meet != NO_USER) {
+            result.found = true;
+            for (uint32_t v = meet; v != NO_USER; v = parent[0][v]) result.path.push_back(v);
+            std::reverse(result.path.begin(), result.path.end());
+            for (uint32_t v = parent[1][meet]; v != NO_USER; v = parent[1][v]) result.path.push_back(v);
+            result.hops = result.path.size() - 1;
+        }
+        reset();
+        return result;
+    }
+};
+
+#endif // PATH_FINDER_HPP
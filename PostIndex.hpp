@@ -0,0 +1,658 @@
+#ifndef POST_INDEX_HPP
+#define POST_INDEX_HPP
+
+#include "PagedFile.hpp"
+#include "AppendOnlyList.hpp"
+#include <vector>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <shared_mutex>
+#include <cstdint>
+#include <cstddef>
+
+// The ascending post numbers containing one term, compressed.
+//
+// Postings are cut into blocks of BLOCK. A block's first post number sits in
+// the skip table with the block's byte offset, and the rest are stored as
+// varint-encoded gaps from the previous post: about a byte per post for a
+// frequent term. Once a block is full it is rewritten as a bitmap over the
+// posts it spans if that is smaller, which it is when more than one post in
+// eight has the term; testing for a post is then a single bit. Finding a
+// post binary searches the skip table and reads one block.
+//
+// Blocks can be moved, oldest first, to a PagedFile (see spillOldest), skip
+// entry and all, so a list keeps in memory only its newest blocks and a few
+// file offsets. The last block may be moved before it is full; the next
+// post then starts a new one, so a spilled block records where it starts
+// and how many posts it has. Reads of spilled blocks go to the file; one
+// that fails reads as an empty block.
+class PostingList {
+public:
+    static constexpr size_t BLOCK = 64;
+
+private:
+    static constexpr uint32_t BITMAP = 0x80000000u; // Set in Skip::offset for a bitmap block
+    static constexpr size_t MAX_BLOCK_BYTES = BLOCK * 5; // Varint gaps; a bitmap is only kept if smaller
+
+    struct Skip {
+        uint32_t first;  // First post in the block
+        uint32_t offset; // Where the block's gaps or bits start in `bytes`
+    };
+
+    // A block in the file
+    struct SpilledBlock {
+        uint32_t first;
+        uint32_t length; // Bytes, with BITMAP set for a bitmap block
+        uint32_t start;  // Position of `first` in the list
+        uint32_t posts;
+        uint64_t offset;
+    };
+
+    std::vector<uint8_t> bytes;
+    std::vector<Skip> skips; // Blocks from spilled.size() on, all full but the last
+    ExtentList<SpilledBlock> spilled;
+    const PagedFile* file = nullptr; // Holds `spilled`
+    uint32_t count = 0;
+    uint32_t spilledCount = 0; // Posts in spilled blocks
+    uint32_t last = 0;
+
+    size_t residentCount() const { return count - spilledCount; }
+
+    void putVarint(uint32_t value) {
+        while (value >= 0x80) {
+            bytes.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    // Offsets of resident block `h` (counted from the first resident one)
+    size_t offsetOf(size_t h) const { return skips[h].offset & ~BITMAP; }
+    size_t endOf(size_t h) const { return h + 1 < skips.size() ? offsetOf(h + 1) : bytes.size(); }
+
+    // Spilled block `b`; zeroed if it cannot be read
+    SpilledBlock spilledAt(size_t b) const {
+        SpilledBlock block{};
+        if (!spilled.get(*file, b, block)) block = SpilledBlock{};
+        return block;
+    }
+
+    // Decodes `n` posts from `length` bytes of gaps or bits starting at `p`.
+    static size_t decode(const uint8_t* p, size_t length, uint32_t post, bool bitmap, size_t n, uint32_t* out) {
+        if (bitmap) {
+            size_t found = 0;
+            for (size_t i = 0; i < length; i++) {
+                for (unsigned bits = p[i]; bits; bits &= bits - 1) {
+                    out[found++] = post + static_cast<uint32_t>(i * 8 + __builtin_ctz(bits));
+                }
+            }
+            return found;
+        }
+        const uint8_t* end = p + length;
+        out[0] = post;
+        for (size_t i = 1; i < n; i++) {
+            uint32_t gap = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                if (p == end) return i;
+                uint8_t byte = *p++;
+                gap |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                if (byte < 0x80) break;
+            }
+            post += gap;
+            out[i] = post;
+        }
+        return n;
+    }
+
+    // Rewrites the last block, now full, as a bitmap if that takes fewer bytes.
+    void closeBlock() {
+        size_t h = skips.size() - 1;
+        size_t span = static_cast<size_t>(last - skips[h].first) + 1;
+        size_t bitmapBytes = (span + 7) / 8;
+        if (bitmapBytes >= bytes.size() - offsetOf(h)) return;
+        uint32_t posts[BLOCK];
+        size_t n = decode(bytes.data() + offsetOf(h), endOf(h) - offsetOf(h), skips[h].first, false, BLOCK, posts);
+        bytes.resize(offsetOf(h));
+        bytes.resize(offsetOf(h) + bitmapBytes, 0);
+        uint8_t* bits = bytes.data() + offsetOf(h);
+        for (size_t i = 0; i < n; i++) {
+            uint32_t d = posts[i] - skips[h].first;
+            bits[d / 8] = static_cast<uint8_t>(bits[d / 8] | (1u << (d % 8)));
+        }
+        skips[h].offset |= BITMAP;
+    }
+
+public:
+    size_t size() const { return count; }
+    size_t blockCount() const { return spilled.size() + skips.size(); }
+    size_t residentBlocks() const { return skips.size(); }
+    uint32_t lastPost() const { return last; }
+
+    // Posts must arrive in ascending order; a repeat of the last one is
+    // ignored. Returns true if this filled the block before, which may then
+    // be spilled.
+    bool add(uint32_t post) {
+        if (count > 0 && post <= last) return false;
+        bool closed = false;
+        if (residentCount() % BLOCK == 0) {
+            if (residentCount() > 0) {
+                closeBlock();
+                closed = true;
+            }
+            skips.push_back(Skip{post, static_cast<uint32_t>(bytes.size())});
+        } else {
+            putVarint(post - last);
+        }
+        last = post;
+        count++;
+        return closed;
+    }
+
+    // Moves the oldest resident block to `to`, which every spilled block of
+    // this list must share. False if the write failed; the block then stays
+    // where it was.
+    bool spillOldest(PagedFile& to) {
+        size_t length = endOf(0);
+        uint32_t posts = static_cast<uint32_t>(std::min(residentCount(), BLOCK));
+        SpilledBlock block{skips[0].first, static_cast<uint32_t>(length) | (skips[0].offset & BITMAP), spilledCount,
+                           posts, to.size()};
+        if (!to.write(block.offset, bytes.data(), length) || !spilled.append(to, &block, 1)) return false;
+        file = &to;
+        spilledCount += posts;
+        bytes.erase(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(length));
+        skips.erase(skips.begin());
+        for (Skip& skip : skips) skip.offset -= static_cast<uint32_t>(length); // BITMAP is above any offset
+        if (bytes.capacity() > 2 * bytes.size() + MAX_BLOCK_BYTES) bytes.shrink_to_fit();
+        if (skips.capacity() > 2 * skips.size() + 4) skips.shrink_to_fit();
+        return true;
+    }
+
+    // Decodes block `b` into `out` (room for BLOCK) and returns its length.
+    size_t decodeBlock(size_t b, uint32_t* out) const {
+        if (b < spilled.size()) {
+            SpilledBlock block = spilledAt(b);
+            uint8_t stored[MAX_BLOCK_BYTES];
+            size_t length = std::min<size_t>(block.length & ~BITMAP, MAX_BLOCK_BYTES);
+            size_t n = std::min<size_t>(block.posts, BLOCK);
+            if (n == 0 || !file->read(block.offset, stored, length)) return 0; // A lone post has no bytes
+            return decode(stored, length, block.first, (block.length & BITMAP) != 0, n, out);
+        }
+        size_t h = b - spilled.size();
+        size_t n = h + 1 < skips.size() ? BLOCK : residentCount() - h * BLOCK;
+        return decode(bytes.data() + offsetOf(h), endOf(h) - offsetOf(h), skips[h].first, isBitmap(b), n, out);
+    }
+
+    // The block holding the post at position `i` < size(); `start` is set
+    // to the position of the block's first post.
+    size_t blockAt(size_t i, size_t& start) const {
+        if (i >= spilledCount) {
+            size_t h = (i - spilledCount) / BLOCK;
+            start = spilledCount + h * BLOCK;
+            return spilled.size() + h;
+        }
+        size_t lo = 0, hi = spilled.size(); // The block is in [lo, hi)
+        while (hi - lo > 1) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (spilledAt(mid).start <= i) lo = mid;
+            else hi = mid;
+        }
+        start = spilledAt(lo).start;
+        return lo;
+    }
+
+    // The block that would hold `post`, or SIZE_MAX if it precedes them all.
+    size_t blockOf(uint32_t post) const {
+        if (!skips.empty() && post >= skips[0].first) {
+            auto it = std::upper_bound(skips.begin(), skips.end(), post,
+                                       [](uint32_t p, const Skip& s) { return p < s.first; });
+            return spilled.size() + static_cast<size_t>(it - skips.begin()) - 1;
+        }
+        size_t lo = 0, hi = spilled.size(); // Blocks [lo, hi) start at or before `post`, and lo - 1 does
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (spilledAt(mid).first <= post) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo == 0 ? SIZE_MAX : lo - 1;
+    }
+
+    // Posts from blockStart(b) up to, not including, blockEnd(b) belong in block b.
+    uint64_t blockStart(size_t b) const {
+        return b < spilled.size() ? spilledAt(b).first : skips[b - spilled.size()].first;
+    }
+    uint64_t blockEnd(size_t b) const { return b + 1 < blockCount() ? blockStart(b + 1) : UINT64_MAX; }
+
+    bool isBitmap(size_t b) const {
+        if (b < spilled.size()) return (spilledAt(b).length & BITMAP) != 0;
+        return (skips[b - spilled.size()].offset & BITMAP) != 0;
+    }
+
+    // Whether bitmap block `b` has `post`, which must fall in the block.
+    bool bitmapHas(size_t b, uint32_t post) const {
+        if (b < spilled.size()) {
+            SpilledBlock block = spilledAt(b);
+            size_t d = post - block.first;
+            uint8_t byte = 0;
+            return d / 8 < (block.length & ~BITMAP) && file->read(block.offset + d / 8, &byte, 1) && ((byte >> (d % 8)) & 1);
+        }
+        size_t h = b - spilled.size();
+        size_t d = post - skips[h].first;
+        return offsetOf(h) + d / 8 < endOf(h) && ((bytes[offsetOf(h) + d / 8] >> (d % 8)) & 1);
+    }
+
+    // Heap bytes; spilled blocks cost a few file offsets
+    size_t memoryBytes() const {
+        return bytes.capacity() + skips.capacity() * sizeof(Skip) + spilled.memoryBytes();
+    }
+};
+
+// A PostingList's posts by position, as FeedMerge takes a list: one block is
+// decoded at a time, so reading in order is cheap. Not for sharing between
+// threads.
+//
+// Given the lock its writer takes, a reader may run while posts are added
+// to the list or spilled: it sees the posts the list had when it was made,
+// and holds the lock shared only while it decodes a block.
+class PostingReader {
+private:
+    const PostingList* list;
+    std::shared_mutex* lock;
+    size_t count;
+    mutable size_t start = 0;  // Position of posts[0]
+    mutable size_t length = 0; // Posts decoded into `posts`
+    mutable uint32_t posts[PostingList::BLOCK];
+
+    void decode(size_t i) const {
+        size_t b = list->blockAt(i, start);
+        length = list->decodeBlock(b, posts);
+    }
+
+public:
+    explicit PostingReader(const PostingList& l, std::shared_mutex* writerLock = nullptr)
+        : list(&l), lock(writerLock) {
+        if (!lock) {
+            count = list->size();
+            return;
+        }
+        std::shared_lock<std::shared_mutex> held(*lock);
+        count = list->size();
+    }
+
+    size_t size() const { return count; }
+
+    size_t operator[](size_t i) const {
+        if (i < start || i - start >= length) {
+            if (lock) {
+                std::shared_lock<std::shared_mutex> held(*lock);
+                decode(i);
+            } else {
+                decode(i);
+            }
+        }
+        return i - start < length ? posts[i - start] : 0;
+    }
+};
+
+// PostingLists that can spill their blocks to a PagedFile once every post in
+// them is older than a horizon, oldest first. Two queues find them without
+// looking at lists that have none: full blocks in the order they filled,
+// and lists in the order of their newest post, whose head is the list gone
+// quiet longest. The second catches a rare word's or quiet author's last
+// block, which may never fill.
+//
+// Lists never move once added, so readers may keep one while more are
+// added.
+class PostingLists {
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    AppendOnlyList<PostingList> lists;
+    std::deque<std::pair<uint32_t, uint32_t>> full; // List, and the post that filled its block
+    // Lists with resident posts, by newest post, while spilling
+    std::vector<uint32_t> older, newer;
+    uint32_t quietest = NONE, latest = NONE;
+    PagedFile* file = nullptr;
+    size_t resident = 0; // Sum of the lists' memoryBytes()
+
+    void unlink(uint32_t list) {
+        (older[list] == NONE ? quietest : newer[older[list]]) = newer[list];
+        (newer[list] == NONE ? latest : older[newer[list]]) = older[list];
+        older[list] = newer[list] = NONE;
+    }
+
+    void pushLatest(uint32_t list) {
+        older[list] = latest;
+        (latest == NONE ? quietest : newer[latest]) = list;
+        latest = list;
+    }
+
+    // Spills the oldest resident block of `list`.
+    bool spillOldest(uint32_t list) {
+        PostingList& l = lists[list];
+        size_t before = l.memoryBytes();
+        if (!l.spillOldest(*file)) return false;
+        resident = resident + l.memoryBytes() - before;
+        return true;
+    }
+
+public:
+    // Starts spilling to `to`. Call before adding any lists.
+    void spillTo(PagedFile* to) { file = to; }
+
+    size_t size() const { return lists.size(); }
+    const PostingList& operator[](size_t list) const { return lists[list]; }
+
+    // Adds an empty list and returns its number.
+    size_t addList() {
+        size_t list = lists.emplace_back();
+        resident += lists[list].memoryBytes();
+        if (file) {
+            older.push_back(NONE);
+            newer.push_back(NONE);
+        }
+        return list;
+    }
+
+    // Adds `post` to list `list`; see PostingList::add. Returns true if it
+    // was not already the list's last post.
+    bool add(size_t list, uint32_t post) {
+        PostingList& l = lists[list];
+        size_t before = l.memoryBytes(), count = l.size();
+        bool filled = l.add(post);
+        resident += l.memoryBytes() - before;
+        if (l.size() == count) return false;
+        if (file) {
+            uint32_t id = static_cast<uint32_t>(list);
+            if (filled) full.emplace_back(id, post);
+            if (latest != id) {
+                if (older[id] != NONE || quietest == id) unlink(id);
+                pushLatest(id);
+            }
+        }
+        return true;
+    }
+
+    // Spills every block whose posts all come before `horizon`. False if a
+    // write failed; blocks not yet spilled stay in memory. Each list is
+    // changed while holding what guard(list) returns, for readers that lock
+    // it (see PostingReader).
+    template <typename Guard>
+    bool spillBefore(size_t horizon, Guard guard) {
+        if (!file) return true;
+        while (!full.empty() && full.front().second <= horizon) {
+            // The list may have spilled the block already, with its last one
+            uint32_t list = full.front().first;
+            [[maybe_unused]] auto held = guard(list);
+            if (lists[list].residentBlocks() > 1 && !spillOldest(list)) return false;
+            full.pop_front();
+        }
+        while (quietest != NONE && lists[quietest].lastPost() < horizon) {
+            uint32_t list = quietest;
+            [[maybe_unused]] auto held = guard(list);
+            while (lists[list].residentBlocks() > 0) {
+                if (!spillOldest(list)) return false;
+            }
+            unlink(list);
+        }
+        return true;
+    }
+
+    bool spillBefore(size_t horizon) {
+        return spillBefore(horizon, [](uint32_t) { return 0; });
+    }
+
+    // Heap bytes of the lists and the queues
+    size_t memoryBytes() const {
+        return resident + lists.capacity() * sizeof(PostingList) + full.size() * sizeof(full.front()) +
+               (older.capacity() + newer.capacity()) * sizeof(uint32_t);
+    }
+};
+
+// One parsed query against a PostIndex: OR-groups of terms that must all
+// appear. Holds a decoded block per term, so evaluating it is not const and
+// one query must not be shared between threads.
+class PostQuery {
+private:
+    // A term's posting list and the block of it read last
+    struct Term {
+        const PostingList* list;
+        size_t block = SIZE_MAX;
+        uint64_t low = 1, high = 0; // Posts that fall in `block`
+        bool bitmap = false;
+        size_t length = 0;
+        uint32_t posts[PostingList::BLOCK]; // `block` decoded, unless it is a bitmap
+
+        explicit Term(const PostingList* l) : list(l) {}
+
+        bool contains(uint32_t post) {
+            if (post < low || post >= high) {
+                size_t b = list->blockOf(post);
+                if (b == SIZE_MAX) return false;
+                block = b;
+                low = list->blockStart(b);
+                high = list->blockEnd(b);
+                bitmap = list->isBitmap(b);
+                if (!bitmap) length = list->decodeBlock(b, posts);
+            }
+            return bitmap ? list->bitmapHas(block, post) : std::binary_search(posts, posts + length, post);
+        }
+    };
+
+    std::vector<std::vector<Term>> groups; // Each sorted by list size, shortest first
+
+    friend class PostIndex;
+
+    // Walks the group's shortest list from its newest post down, keeping
+    // posts every other term has and `visible` accepts.
+    template <typename Visible>
+    void newestInGroup(std::vector<Term>& group, size_t limit, Visible& visible, std::vector<uint32_t>& out,
+                       size_t& scanned) {
+        const PostingList& lead = *group[0].list;
+        uint32_t block[PostingList::BLOCK];
+        for (size_t b = lead.blockCount(); b-- > 0;) {
+            size_t n = lead.decodeBlock(b, block);
+            for (size_t i = n; i-- > 0;) {
+                scanned++;
+                uint32_t post = block[i];
+                bool all = true;
+                for (size_t t = 1; t < group.size() && all; t++) all = group[t].contains(post);
+                if (!all || !visible(post)) continue;
+                out.push_back(post);
+                if (out.size() == limit) return;
+            }
+        }
+    }
+
+public:
+    // True if no post can match: no terms, or a term in every group that
+    // no post contains.
+    bool empty() const { return groups.empty(); }
+
+    // Postings newest() may read: the shortest list of each group.
+    size_t cost() const {
+        size_t total = 0;
+        for (const auto& group : groups) total += group[0].list->size();
+        return total;
+    }
+
+    // Posts expected to match among `total`, taking terms as independent.
+    double expectedMatches(size_t total) const {
+        double expected = 0;
+        for (const auto& group : groups) {
+            double share = 1;
+            for (const auto& term : group) share *= static_cast<double>(term.list->size()) / std::max<size_t>(total, 1);
+            expected += share * total;
+        }
+        return expected;
+    }
+
+    // Whether to answer by testing the searcher's `visible` posts (from
+    // `sources` authors) newest first, rather than by walking the posting
+    // lists and testing each post's visibility. Both stop after `limit`
+    // matches, so each is costed by how far it should get with matches
+    // spread evenly over the `total` posts. Testing a visible post probes
+    // random blocks of every term, about VISIBLE_POST_COST times the work of
+    // reading one posting in order; merging adds a step per source.
+    bool preferVisibleWalk(size_t visible, size_t sources, size_t total, size_t limit) const {
+        static constexpr double VISIBLE_POST_COST = 16;
+        double matches = std::max(expectedMatches(total), 1e-3);
+        double visibleShare = std::max<double>(static_cast<double>(visible), 1) / std::max<size_t>(total, 1);
+        double visiblePosts = std::min<double>(static_cast<double>(visible), limit * (total / matches));
+        double postings = std::min<double>(static_cast<double>(cost()), limit * (cost() / (matches * visibleShare)));
+        return static_cast<double>(sources) + VISIBLE_POST_COST * visiblePosts <= postings;
+    }
+
+    // Whether `post` has every term of some group. Cheapest when called with
+    // descending post numbers, which reuse each term's decoded block.
+    bool matches(uint32_t post) {
+        for (auto& group : groups) {
+            bool all = true;
+            for (size_t t = 0; t < group.size() && all; t++) all = group[t].contains(post);
+            if (all) return true;
+        }
+        return false;
+    }
+
+    // Up to `limit` matching posts that visible(post) accepts, newest first.
+    // `scanned` is increased by the postings read.
+    template <typename Visible>
+    std::vector<uint32_t> newest(size_t limit, Visible visible, size_t& scanned) {
+        std::vector<uint32_t> result;
+        if (limit == 0) return result;
+        for (auto& group : groups) {
+            // Each group's newest `limit` cover the union's newest `limit`
+            std::vector<uint32_t> found;
+            newestInGroup(group, limit, visible, found, scanned);
+            std::vector<uint32_t> merged;
+            std::merge(result.begin(), result.end(), found.begin(), found.end(), std::back_inserter(merged),
+                       std::greater<uint32_t>());
+            merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+            if (merged.size() > limit) merged.resize(limit);
+            result.swap(merged);
+        }
+        return result;
+    }
+};
+
+// Inverted index from the words of each post to the posts containing them.
+//
+// Terms are runs of ASCII letters and digits, lowercased, plus any bytes of
+// 0x80 and up so UTF-8 words stay whole; everything else separates them, so
+// "#Cloud" and "cloud" are the same term. Posts are added as they are
+// created, in ascending order, and each term's list is appended to in place.
+// Full posting blocks of old posts can be moved to a PagedFile (spillTo);
+// the term table itself stays in memory and grows with the vocabulary.
+class PostIndex {
+private:
+    static constexpr size_t MAX_TERM = 64; // Longer terms are cut to this many bytes
+
+    std::unordered_map<std::string, uint32_t> terms; // Term -> index into `lists`
+    PostingLists lists;
+    std::string scratch; // Reused by add() so lookups do not allocate
+    size_t postings = 0;
+
+    static bool isTermByte(unsigned char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+    }
+
+    static char lower(unsigned char c) {
+        return static_cast<char>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+    }
+
+public:
+    // Calls fn(const std::string&) for each term of `text`, in order.
+    template <typename Fn>
+    static void forEachTerm(std::string_view text, std::string& term, Fn fn) {
+        size_t i = 0;
+        while (i < text.size()) {
+            while (i < text.size() && !isTermByte(static_cast<unsigned char>(text[i]))) i++;
+            if (i == text.size()) break;
+            term.clear();
+            for (; i < text.size() && isTermByte(static_cast<unsigned char>(text[i])); i++) {
+                if (term.size() < MAX_TERM) term += lower(static_cast<unsigned char>(text[i]));
+            }
+            fn(term);
+        }
+    }
+
+    // `post` must be greater than every post added before.
+    void add(uint32_t post, std::string_view content) {
+        forEachTerm(content, scratch, [&](const std::string& term) {
+            auto it = terms.find(term);
+            if (it == terms.end()) {
+                it = terms.emplace(term, static_cast<uint32_t>(lists.addList())).first;
+            }
+            if (lists.add(it->second, post)) postings++;
+        });
+    }
+
+    // Moves full posting blocks to `file` once all their posts come before
+    // the horizon given to spillBefore. Call before adding any posts.
+    void spillTo(PagedFile* file) { lists.spillTo(file); }
+
+    // See PostingLists::spillBefore.
+    bool spillBefore(size_t horizon) { return lists.spillBefore(horizon); }
+
+    // Words separated by spaces must all appear; the word OR separates
+    // alternatives, and AND may be written but changes nothing. So
+    // "cloud hiring OR remote" finds posts with both "cloud" and "hiring",
+    // or with "remote".
+    PostQuery parse(std::string_view text) const {
+        PostQuery query;
+        std::vector<PostQuery::Term> group;
+        bool dead = false; // A term of this group occurs nowhere
+        std::string term;
+
+        auto closeGroup = [&] {
+            if (!dead && !group.empty()) {
+                std::sort(group.begin(), group.end(), [](const PostQuery::Term& a, const PostQuery::Term& b) {
+                    return a.list->size() < b.list->size();
+                });
+                query.groups.push_back(std::move(group));
+            }
+            group.clear();
+            dead = false;
+        };
+
+        size_t i = 0;
+        while (i < text.size()) {
+            while (i < text.size() && (text[i] == ' ' || text[i] == '\t')) i++;
+            size_t start = i;
+            while (i < text.size() && text[i] != ' ' && text[i] != '\t') i++;
+            std::string_view word = text.substr(start, i - start);
+            if (word.empty() || word == "AND") continue;
+            if (word == "OR") {
+                closeGroup();
+                continue;
+            }
+            forEachTerm(word, term, [&](const std::string& t) {
+                auto it = terms.find(t);
+                if (it == terms.end()) {
+                    dead = true;
+                    return;
+                }
+                const PostingList* list = &lists[it->second];
+                for (const auto& existing : group) {
+                    if (existing.list == list) return;
+                }
+                group.emplace_back(list);
+            });
+        }
+        closeGroup();
+        return query;
+    }
+
+    size_t termCount() const { return lists.size(); }
+    size_t postingCount() const { return postings; }
+
+    // Heap bytes held by the posting lists (the term table is not counted).
+    size_t memoryBytes() const { return lists.memoryBytes(); }
+};
+
+#endif // POST_INDEX_HPP
@@ -0,0 +1,473 @@
+#ifndef POST_SEGMENTS_HPP
+#define POST_SEGMENTS_HPP
+
+#include "BinaryIO.hpp"
+#include "PagedFile.hpp"
+#include <vector>
+#include <array>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// LZ77 compression for one block of post bodies, in the style of LZ4: a
+// sequence is a token byte (literal count in the high nibble, match length
+// minus MIN_MATCH in the low one, 15 meaning "more bytes follow"), the
+// literals, then a two-byte offset back into the output. The last sequence
+// has literals only. Blocks are small enough that a 4096-entry table of
+// recent positions finds most repeats.
+class BlockCodec {
+private:
+    static constexpr size_t MIN_MATCH = 4;
+    static constexpr unsigned HASH_BITS = 12;
+    static constexpr size_t MAX_OFFSET = 65535;
+    static constexpr size_t WILD_COPY = 16;
+
+    static void length(std::string& out, size_t n) {
+        for (; n >= 255; n -= 255) out += static_cast<char>(255);
+        out += static_cast<char>(n);
+    }
+
+    static void sequence(std::string& out, const char* literals, size_t literalCount, size_t offset, size_t matchLength) {
+        size_t extra = matchLength ? matchLength - MIN_MATCH : 0;
+        out += static_cast<char>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(extra, 15));
+        if (literalCount >= 15) length(out, literalCount - 15);
+        out.append(literals, literalCount);
+        if (matchLength == 0) return;
+        out += static_cast<char>(offset & 0xFF);
+        out += static_cast<char>(offset >> 8);
+        if (extra >= 15) length(out, extra - 15);
+    }
+
+    // Reads a "more bytes follow" length; false if it runs off the end.
+    static bool moreLength(const unsigned char*& in, const unsigned char* end, size_t& n) {
+        while (true) {
+            if (in == end) return false;
+            unsigned char b = *in++;
+            n += b;
+            if (b != 255) return true;
+        }
+    }
+
+public:
+    // Appends the compressed form of `raw` to `out`.
+    static void compress(std::string_view raw, std::string& out) {
+        std::array<int64_t, size_t(1) << HASH_BITS> recent;
+        recent.fill(-1);
+        const char* p = raw.data();
+        size_t n = raw.size(), anchor = 0, i = 0;
+        while (i + MIN_MATCH <= n) {
+            uint32_t word;
+            std::memcpy(&word, p + i, 4);
+            size_t h = static_cast<uint32_t>(word * 2654435761u) >> (32 - HASH_BITS);
+            int64_t candidate = recent[h];
+            recent[h] = static_cast<int64_t>(i);
+            if (candidate < 0 || i - static_cast<size_t>(candidate) > MAX_OFFSET ||
+                std::memcmp(p + candidate, p + i, MIN_MATCH) != 0) {
+                i++;
+                continue;
+            }
+            size_t from = static_cast<size_t>(candidate);
+            size_t matchLength = MIN_MATCH;
+            while (i + matchLength < n && p[from + matchLength] == p[i + matchLength]) matchLength++;
+            sequence(out, p + anchor, i - anchor, i - from, matchLength);
+            i += matchLength;
+            anchor = i;
+        }
+        if (anchor < n || n == 0) sequence(out, p + anchor, n - anchor, 0, 0);
+    }
+
+    // Decodes exactly `rawSize` bytes into `out`. Returns false if the input
+    // is malformed.
+    static bool decompress(std::string_view compressed, size_t rawSize, std::string& out) {
+        // WILD_COPY bytes of slack let short copies move a fixed 16 bytes
+        out.resize(rawSize + WILD_COPY);
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(compressed.data());
+        const unsigned char* end = in + compressed.size();
+        size_t o = 0;
+        while (o < rawSize) {
+            if (in == end) return false;
+            unsigned char token = *in++;
+            size_t literalCount = token >> 4;
+            if (literalCount == 15 && !moreLength(in, end, literalCount)) return false;
+            if (literalCount > static_cast<size_t>(end - in) || literalCount > rawSize - o) return false;
+            if (literalCount <= WILD_COPY && static_cast<size_t>(end - in) >= WILD_COPY) {
+                std::memcpy(&out[o], in, WILD_COPY);
+            } else {
+                std::memcpy(&out[o], in, literalCount);
+            }
+            in += literalCount;
+            o += literalCount;
+            if (o == rawSize) break;
+
+            if (end - in < 2) return false;
+            size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+            in += 2;
+            size_t matchLength = token & 0x0F;
+            if (matchLength == 15 && !moreLength(in, end, matchLength)) return false;
+            matchLength += MIN_MATCH;
+            if (offset == 0 || offset > o || matchLength > rawSize - o) return false;
+            if (offset >= WILD_COPY && matchLength <= WILD_COPY) {
+                std::memcpy(&out[o], &out[o - offset], WILD_COPY);
+            } else if (offset >= matchLength) {
+                std::memcpy(&out[o], &out[o - offset], matchLength);
+            } else {
+                for (size_t k = 0; k < matchLength; k++) out[o + k] = out[o + k - offset]; // Overlaps itself
+            }
+            o += matchLength;
+        }
+        out.resize(rawSize);
+        return true;
+    }
+};
+
+// Post bodies moved out of memory, in segment files on disk.
+//
+// Posts arrive in runs of consecutive post numbers, oldest first, so every
+// file is sorted by post number. A run is cut into blocks of about
+// BLOCK_BYTES, each compressed with BlockCodec and written after a small
+// header. The directory of blocks (first post and file position, 32 bytes
+// per block) is itself kept in a PagedFile, so memory does not grow with
+// the posts stored. Files are appended to until they reach SEGMENT_BYTES,
+// then a new one is started.
+//
+// Reading a post decodes its whole block into a per-thread cache of
+// CACHE_BLOCKS blocks, so paging on through the same old posts reads the
+// disk once per block. Reads use pread and may run on many threads at once;
+// append must not run alongside them.
+//
+// Durable segments (see open) keep their files so a snapshot can refer to
+// them instead of copying the bodies: sync() makes them safe to name, and
+// adopt() takes them back after a restart. Otherwise the files are a cache
+// tier, deleted on open and on destruction.
+class PostSegments {
+public:
+    static constexpr size_t BLOCK_BYTES = 16 * 1024;
+    static constexpr size_t SEGMENT_BYTES = size_t(64) << 20;
+    static constexpr size_t CACHE_BLOCKS = 16;
+
+private:
+    static constexpr uint32_t BLOCK_MAGIC = 0x4B4C4250; // "PBLK"
+    static constexpr size_t BLOCK_HEADER = 24;          // Magic, posts, raw size, compressed size, first post
+
+    struct Block {
+        uint64_t firstPost;
+        uint64_t offset; // Of the header, in its file
+        uint32_t file;
+        uint32_t rawSize;
+        uint32_t compressedSize;
+        uint32_t posts;
+    };
+
+    // One decoded block, and where each post's body starts in it
+    struct CachedBlock {
+        uint64_t owner = 0; // PostSegments::id; 0 = unused
+        uint64_t firstPost = 0;
+        std::string raw;
+        std::vector<uint32_t> starts; // One per post, plus the end
+        uint64_t lastUse = 0;
+    };
+
+    std::string directory;
+    bool durable = false;
+    std::vector<int> files;
+    std::vector<uint64_t> sizes; // Bytes written to each file
+    PagedFile blockFile; // Block records, in post order
+    size_t blockTotal = 0;
+    Block lastBlock{};
+    size_t unsyncedFrom = 0; // First file written since the last sync()
+    bool filesCreated = false; // Since the last sync()
+    size_t diskBytes = 0;
+    size_t rawBytes = 0;
+    mutable std::atomic<size_t> reads{0};
+    mutable std::atomic<bool> readFailed{false};
+    uint64_t id;
+
+    static uint64_t nextId() {
+        static std::atomic<uint64_t> next{1};
+        return next.fetch_add(1);
+    }
+
+    static std::array<CachedBlock, CACHE_BLOCKS>& cache() {
+        static thread_local std::array<CachedBlock, CACHE_BLOCKS> blocksRead;
+        return blocksRead;
+    }
+
+    // Durable and cache files differ in name, so a cache in the same
+    // directory never touches durable ones.
+    const char* prefix() const { return durable ? "posts-" : "cache-"; }
+
+    std::string fileName(size_t index) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "/%s%06zu.seg", prefix(), index);
+        return directory + name;
+    }
+
+    // Deletes this kind's files in the directory numbered `from` or higher.
+    void removeFiles(size_t from) const {
+        DIR* listing = ::opendir(directory.c_str());
+        if (!listing) return;
+        while (dirent* entry = ::readdir(listing)) {
+            const char* name = entry->d_name;
+            size_t n = std::strlen(name);
+            if (n <= 10 || std::strncmp(name, prefix(), 6) != 0 || std::strcmp(name + n - 4, ".seg") != 0) continue;
+            if (std::strtoull(name + 6, nullptr, 10) >= from) ::unlink((directory + "/" + name).c_str());
+        }
+        ::closedir(listing);
+    }
+
+    bool addBlock(const Block& block) {
+        blockFile.write(blockTotal * sizeof(Block), &block, sizeof(Block));
+        blockTotal++;
+        lastBlock = block;
+        return blockFile.ok();
+    }
+
+    bool newFile() {
+        int fd = ::open(fileName(files.size()).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        files.push_back(fd);
+        sizes.push_back(0);
+        filesCreated = true;
+        return true;
+    }
+
+    // Compresses the bodies in `raw` (starting at `starts`) as one block:
+    // their lengths, then the bodies back to back.
+    bool writeBlock(uint64_t firstPost, const std::string& raw, const std::vector<uint32_t>& starts) {
+        if ((files.empty() || sizes.back() >= SEGMENT_BYTES) && !newFile()) return false;
+
+        uint32_t posts = static_cast<uint32_t>(starts.size() - 1);
+        BinaryWriter body;
+        for (uint32_t i = 0; i < posts; i++) body.u32(starts[i + 1] - starts[i]);
+        body.raw(raw.data(), raw.size());
+        std::string compressed;
+        BlockCodec::compress(body.data(), compressed);
+
+        BinaryWriter out;
+        out.u32(BLOCK_MAGIC);
+        out.u32(posts);
+        out.u32(static_cast<uint32_t>(body.size()));
+        out.u32(static_cast<uint32_t>(compressed.size()));
+        out.u64(firstPost);
+        out.raw(compressed.data(), compressed.size());
+        unsyncedFrom = std::min(unsyncedFrom, files.size() - 1);
+        if (!writeAll(files.back(), out.data().data(), out.size())) return false;
+
+        sizes.back() += out.size();
+        diskBytes += out.size();
+        rawBytes += raw.size();
+        return addBlock(Block{firstPost, sizes.back() - out.size(), static_cast<uint32_t>(files.size() - 1),
+                              static_cast<uint32_t>(body.size()), static_cast<uint32_t>(compressed.size()), posts});
+    }
+
+    // The block holding post `index` < postCount(), by binary search over
+    // the directory. False if the directory cannot be read.
+    bool findBlock(size_t index, Block& block) const {
+        size_t lo = 0, hi = blockTotal; // The block is in [lo, hi)
+        while (hi - lo > 1) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (!blockFile.read(mid * sizeof(Block), &block, sizeof(Block))) return false;
+            if (index < block.firstPost) hi = mid;
+            else lo = mid;
+        }
+        return blockFile.read(lo * sizeof(Block), &block, sizeof(Block));
+    }
+
+    // Reads and decodes `block` into `slot`. False if the file is
+    // unreadable or the block is not the one expected. There is no checksum;
+    // a damaged block fails to decode rather than being read out of bounds.
+    bool load(const Block& block, CachedBlock& slot) const {
+        std::string stored(BLOCK_HEADER + block.compressedSize, '\0');
+        ssize_t got = ::pread(files[block.file], &stored[0], stored.size(), static_cast<off_t>(block.offset));
+        if (got != static_cast<ssize_t>(stored.size())) return false;
+        BinaryReader header(stored.data(), BLOCK_HEADER);
+        if (header.u32() != BLOCK_MAGIC || header.u32() != block.posts || header.u32() != block.rawSize ||
+            header.u32() != block.compressedSize || header.u64() != block.firstPost) {
+            return false;
+        }
+
+        std::string_view compressed(stored.data() + BLOCK_HEADER, block.compressedSize);
+        if (!BlockCodec::decompress(compressed, block.rawSize, slot.raw)) return false;
+        size_t table = size_t(block.posts) * 4;
+        BinaryReader lengths(slot.raw.data(), std::min(table, slot.raw.size()));
+        slot.starts.assign(1, static_cast<uint32_t>(table));
+        for (uint32_t i = 0; i < block.posts; i++) slot.starts.push_back(slot.starts.back() + lengths.u32());
+        if (!lengths.ok() || slot.starts.back() != slot.raw.size()) return false;
+        slot.owner = id;
+        slot.firstPost = block.firstPost;
+        return true;
+    }
+
+public:
+    PostSegments() : id(nextId()) {}
+
+    PostSegments(const PostSegments&) = delete;
+    PostSegments& operator=(const PostSegments&) = delete;
+
+    ~PostSegments() {
+        for (size_t i = 0; i < files.size(); i++) {
+            ::close(files[i]);
+            if (!durable) ::unlink(fileName(i).c_str());
+        }
+    }
+
+    // Uses `dir` (created if missing) for segment files. Durable ones are
+    // kept for adopt(); otherwise any left there by an earlier run are
+    // deleted. Returns false if it is unusable.
+    bool open(const std::string& dir, bool keep) {
+        if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) return false;
+        DIR* listing = ::opendir(dir.c_str());
+        if (!listing) return false;
+        ::closedir(listing);
+        directory = dir;
+        durable = keep;
+        if (!durable) removeFiles(0);
+        return blockFile.open(dir, "cache-blocks.tmp");
+    }
+
+    bool isOpen() const { return !directory.empty(); }
+    bool isDurable() const { return durable; }
+
+    // Takes back durable files an earlier run wrote, as fileSizes() described
+    // them after its last sync(): each is cut back to that size, dropping
+    // blocks written since, and only the blocks holding posts [0, count) are
+    // kept. Later files are deleted. Call once, before anything is appended.
+    // Returns false if the files are missing or hold too few posts.
+    bool adopt(const std::vector<uint64_t>& fileSizes, size_t count) {
+        if (!durable) return count == 0;
+        for (size_t f = 0; f < fileSizes.size() && postCount() < count; f++) {
+            int fd = ::open(fileName(f).c_str(), O_RDWR);
+            if (fd < 0) return false;
+            files.push_back(fd);
+            sizes.push_back(0);
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < fileSizes[f]) return false;
+
+            // Rebuild the block directory from the headers
+            uint64_t offset = 0;
+            while (offset < fileSizes[f] && postCount() < count) {
+                char stored[BLOCK_HEADER];
+                if (::pread(fd, stored, BLOCK_HEADER, static_cast<off_t>(offset)) != BLOCK_HEADER) return false;
+                BinaryReader header(stored, BLOCK_HEADER);
+                uint32_t magic = header.u32();
+                Block block;
+                block.posts = header.u32();
+                block.rawSize = header.u32();
+                block.compressedSize = header.u32();
+                block.firstPost = header.u64();
+                block.offset = offset;
+                block.file = static_cast<uint32_t>(f);
+                offset += BLOCK_HEADER + block.compressedSize;
+                if (magic != BLOCK_MAGIC || block.firstPost != postCount() || block.posts == 0 ||
+                    offset > fileSizes[f] || size_t(block.posts) * 4 > block.rawSize) {
+                    return false;
+                }
+                if (!addBlock(block)) return false;
+                rawBytes += block.rawSize - size_t(block.posts) * 4;
+            }
+            if (::ftruncate(fd, static_cast<off_t>(offset)) != 0 || ::lseek(fd, 0, SEEK_END) < 0) return false;
+            sizes.back() = offset;
+            diskBytes += offset;
+        }
+        removeFiles(files.size());
+        unsyncedFrom = files.size();
+        return blockFile.flush() && postCount() == count;
+    }
+
+    // Makes everything appended so far durable, including new files' names.
+    // Does nothing for a cache. Returns false if the disk refuses.
+    bool sync() {
+        if (!durable) return true;
+        for (size_t f = unsyncedFrom; f < files.size(); f++) {
+            if (::fsync(files[f]) != 0) return false;
+        }
+        if (filesCreated) {
+            int dirFd = ::open(directory.c_str(), O_RDONLY);
+            if (dirFd < 0) return false;
+            bool good = ::fsync(dirFd) == 0;
+            ::close(dirFd);
+            if (!good) return false;
+        }
+        unsyncedFrom = files.size();
+        filesCreated = false;
+        return true;
+    }
+
+    // Posts [0, postCount()) are here.
+    size_t postCount() const { return blockTotal == 0 ? 0 : lastBlock.firstPost + lastBlock.posts; }
+    size_t blockCount() const { return blockTotal; }
+    size_t fileCount() const { return files.size(); }
+    const std::vector<uint64_t>& fileSizes() const { return sizes; }
+    size_t bytesOnDisk() const { return diskBytes; }
+    size_t bytesStored() const { return rawBytes; } // Before compression
+    size_t blocksRead() const { return reads.load(std::memory_order_relaxed); } // From disk, by every thread
+    size_t memoryBytes() const { return blockFile.memoryBytes() + files.capacity() * (sizeof(int) + sizeof(uint64_t)); }
+
+    // Stores the bodies of posts [postCount(), postCount() + n), fetched
+    // with body(i) for i in [0, n). Returns false if the disk write fails;
+    // the posts written before then stay readable.
+    template <typename Body>
+    bool append(size_t n, Body body) {
+        uint64_t first = postCount();
+        std::string raw;
+        std::vector<uint32_t> starts{0};
+        for (size_t i = 0; i < n; i++) {
+            std::string_view content = body(i);
+            raw.append(content.data(), content.size());
+            starts.push_back(static_cast<uint32_t>(raw.size()));
+            if (raw.size() >= BLOCK_BYTES || i + 1 == n) {
+                if (!writeBlock(first, raw, starts)) return false;
+                first += starts.size() - 1;
+                raw.clear();
+                starts.assign(1, 0);
+            }
+        }
+        return blockFile.flush();
+    }
+
+    // Sets `body` to that of post `index` < postCount(). It stays valid
+    // until this thread has read CACHE_BLOCKS other blocks. False if the
+    // block cannot be read; that is reported once on stderr.
+    bool get(size_t index, std::string_view& body) const {
+        static thread_local uint64_t clock = 0;
+        auto& slots = cache();
+        CachedBlock* slot = &slots[0];
+        for (CachedBlock& cached : slots) {
+            if (cached.owner == id && index >= cached.firstPost && index - cached.firstPost < cached.starts.size() - 1) {
+                size_t i = index - cached.firstPost;
+                cached.lastUse = ++clock;
+                body = std::string_view(cached.raw).substr(cached.starts[i], cached.starts[i + 1] - cached.starts[i]);
+                return true;
+            }
+            if (cached.lastUse < slot->lastUse) slot = &cached;
+        }
+
+        reads.fetch_add(1, std::memory_order_relaxed);
+        Block block;
+        if (!findBlock(index, block) || !load(block, *slot)) {
+            slot->owner = 0;
+            if (!readFailed.exchange(true)) {
+                std::cerr << "Cannot read post " << index << " from the segment files in " << directory << ".\n";
+            }
+            return false;
+        }
+        size_t i = index - block.firstPost;
+        slot->lastUse = ++clock;
+        body = std::string_view(slot->raw).substr(slot->starts[i], slot->starts[i + 1] - slot->starts[i]);
+        return true;
+    }
+};
+
+#endif // POST_SEGMENTS_HPP
@@ -0,0 +1,372 @@
+#ifndef POST_STORE_HPP
+#define POST_STORE_HPP
+
+#include "UsernameTable.hpp"
+#include "PostSegments.hpp"
+#include "PagedFile.hpp"
+#include "AppendOnlyList.hpp"
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+
+// Append-only storage for string bytes, in fixed-size chunks that never move.
+//
+// A string is addressed by a 64-bit location (chunk index in the high half,
+// offset in the low half) plus its length, and never straddles two chunks.
+// Whole chunks can be released once nothing reads the strings in them, which
+// lets old post bodies be dropped from memory without compacting anything.
+// The chunks are an AppendOnlyList, so strings may be read while others are
+// added.
+class StringArena {
+private:
+    static constexpr size_t CHUNK_SIZE = size_t(1) << 20;
+
+    struct Chunk {
+        std::unique_ptr<char[]> bytes; // Null once released
+        size_t size;
+
+        explicit Chunk(size_t n) : bytes(new char[n]), size(n) {}
+    };
+
+    AppendOnlyList<Chunk> chunks;
+    size_t used = 0;     // Bytes used in the last chunk
+    size_t capacity = 0; // Size of the last chunk
+    size_t allocated = 0;
+    size_t released = 0; // Chunks [0, released) are freed
+
+    void newChunk(size_t size) {
+        chunks.emplace_back(size);
+        allocated += size;
+        used = 0;
+        capacity = size;
+    }
+
+public:
+    uint64_t add(std::string_view s) {
+        if (used + s.size() > capacity) {
+            newChunk(s.size() > CHUNK_SIZE ? s.size() : CHUNK_SIZE); // Oversized strings get their own chunk
+        }
+        uint64_t location = (static_cast<uint64_t>(chunkCount() - 1) << 32) | used;
+        if (!s.empty()) std::memcpy(chunks[chunkCount() - 1].bytes.get() + used, s.data(), s.size());
+        used += s.size();
+        return location;
+    }
+
+    std::string_view get(uint64_t location, uint32_t length) const {
+        if (length == 0) return std::string_view();
+        return std::string_view(chunks[chunkOf(location)].bytes.get() + (location & 0xFFFFFFFFu), length);
+    }
+
+    static size_t chunkOf(uint64_t location) {
+        return static_cast<size_t>(location >> 32);
+    }
+
+    size_t chunkCount() const { return chunks.size(); }
+    size_t firstLiveChunk() const { return released; }
+    size_t allocatedBytes() const { return allocated; }
+
+    // Frees chunks [0, end). Strings stored in them must not be read again.
+    // The chunk being written to is never freed.
+    void releaseChunksBefore(size_t end) {
+        if (end >= chunkCount()) end = chunkCount() - 1;
+        for (; released < end; released++) {
+            allocated -= chunks[released].size;
+            chunks[released].bytes.reset();
+        }
+    }
+};
+
+// One post as read from a PostStore. Cheap to copy; the content points into
+// the store's arena.
+struct PostView {
+    size_t index; // Post number, shown so users can refer to the post
+    UserId author;
+    int64_t timestamp;
+    int likes;
+    std::string_view content;
+    bool readable = true; // False if it could not be read back from disk
+
+    UserId getAuthor() const { return author; }
+    int64_t getTimestamp() const { return timestamp; }
+    int getLikes() const { return likes; }
+    std::string_view getContent() const { return content; }
+};
+
+// Posts stored column by column, indexed by post number in creation order.
+//
+// Each field is its own array within a chunk of CHUNK_POSTS posts, so a scan
+// that filters on author or timestamp reads only those arrays, and post
+// bodies sit back to back in a StringArena instead of one heap block per
+// post.
+//
+// One thread appends while any number read: the chunks are an
+// AppendOnlyList and a post is published by a release store of the post
+// count, so a reader given a post number by anything published after it
+// (a feed, an index) sees the whole post without taking a lock. Like counts
+// are atomics that may be changed from several threads while others read;
+// everything else changes only on append.
+//
+// With a retention budget set, posts are kept in memory only while their
+// bodies and columns take no more than that many bytes. Past it, the oldest
+// arena chunk is spilled: its posts' bodies go to PostSegments, their
+// author, timestamp and like count to a PagedFile of fixed-size records,
+// and the chunk is freed. Reads of spilled posts go to disk, so callers see
+// no difference beyond the latency, except that a read can fail; get()
+// and content() say so rather than returning an empty post. A reader that
+// may run alongside append holds pin() while it reads, so a spill cannot
+// free what it is reading.
+class PostStore {
+private:
+    static constexpr size_t CHUNK_POSTS = 1024;
+
+    // The columns of posts [k * CHUNK_POSTS, (k + 1) * CHUNK_POSTS)
+    struct Chunk {
+        UserId authors[CHUNK_POSTS];
+        int64_t timestamps[CHUNK_POSTS]; // Seconds since the epoch
+        std::atomic<int> likeCounts[CHUNK_POSTS];
+        uint64_t contentLocations[CHUNK_POSTS];
+        uint32_t contentLengths[CHUNK_POSTS];
+    };
+
+    // A spilled post's columns, at spilledPostOffset(index) in `columns`
+    struct SpilledPost {
+        uint32_t author;
+        int32_t likes;
+        int64_t timestamp;
+    };
+    static constexpr size_t LIKES_OFFSET = 4; // Of SpilledPost::likes
+    static constexpr size_t LIKE_LOCKS = 16;
+
+    // Chunks holding only spilled posts are freed, leaving a null pointer
+    AppendOnlyList<std::unique_ptr<Chunk>> chunks;
+    StringArena arena;
+    std::atomic<size_t> total{0};
+    std::atomic<size_t> spilled{0}; // Posts [0, spilled) are on disk
+    size_t freedChunks = 0;         // Chunks [0, freedChunks) are freed
+    size_t residentLimit = 0;       // Resident bytes to keep; 0 keeps everything
+    PostSegments segments;
+    PagedFile columns;
+    std::mutex likeLocks[LIKE_LOCKS]; // Serialise changes to one spilled count
+    mutable std::shared_mutex spillLock; // Held by spill(), and shared by pin()
+    bool retaining = false; // setRetention was called, so spills may happen
+
+    static uint64_t spilledPostOffset(size_t index) { return index * sizeof(SpilledPost); }
+
+    const Chunk& chunkOf(size_t index) const { return *chunks[index / CHUNK_POSTS]; }
+    Chunk& chunkOf(size_t index) { return *chunks[index / CHUNK_POSTS]; }
+
+    bool isSpilled(size_t index) const { return index < spilled.load(std::memory_order_acquire); }
+
+    std::string_view residentBody(size_t index) const {
+        const Chunk& c = chunkOf(index);
+        size_t i = index % CHUNK_POSTS;
+        return arena.get(c.contentLocations[i], c.contentLengths[i]);
+    }
+
+    bool readSpilled(size_t index, SpilledPost& post) const {
+        return columns.read(spilledPostOffset(index), &post, sizeof(post));
+    }
+
+    // Adds `change` to the like count of spilled post `index`.
+    void likeSpilled(size_t index, int change) {
+        std::lock_guard<std::mutex> guard(likeLocks[index % LIKE_LOCKS]);
+        SpilledPost post;
+        if (!readSpilled(index, post)) return;
+        post.likes += change;
+        columns.writeDirect(spilledPostOffset(index) + LIKES_OFFSET, &post.likes, sizeof(post.likes));
+    }
+
+    // The oldest arena chunk, if it is not the one being written to
+    bool spillableChunk(size_t& chunk) const {
+        chunk = arena.firstLiveChunk();
+        return chunk + 1 < arena.chunkCount();
+    }
+
+    // Moves the posts whose bodies are in arena chunks [0, chunk] to disk
+    // and frees them. An empty body made before the first chunk has no real
+    // chunk; it goes with whatever comes next. False if a write failed.
+    bool spill(size_t chunk) {
+        std::unique_lock<std::shared_mutex> held(spillLock);
+        size_t first = spilled.load(std::memory_order_relaxed), end = first, count = size();
+        for (; end < count; end++) {
+            const Chunk& c = chunkOf(end);
+            size_t i = end % CHUNK_POSTS;
+            if (c.contentLengths[i] != 0 && StringArena::chunkOf(c.contentLocations[i]) > chunk) break;
+        }
+        std::vector<SpilledPost> records;
+        records.reserve(end - first);
+        for (size_t index = first; index < end; index++) {
+            const Chunk& c = chunkOf(index);
+            size_t i = index % CHUNK_POSTS;
+            records.push_back(SpilledPost{c.authors[i], c.likeCounts[i].load(std::memory_order_relaxed), c.timestamps[i]});
+        }
+        if (!columns.write(spilledPostOffset(first), records.data(), records.size() * sizeof(SpilledPost)) ||
+            !columns.flush() ||
+            !segments.append(end - first, [&](size_t i) { return residentBody(first + i); })) {
+            return false;
+        }
+        spilled.store(end, std::memory_order_release);
+        for (; (freedChunks + 1) * CHUNK_POSTS <= end; freedChunks++) chunks[freedChunks].reset();
+        arena.releaseChunksBefore(chunk + 1);
+        return true;
+    }
+
+    bool openSegments(const std::string& directory, bool durable) {
+        return segments.open(directory, durable) && columns.open(directory, "cache-columns.tmp");
+    }
+
+public:
+    size_t size() const { return total.load(std::memory_order_acquire); }
+
+    // Keeps at most about `residentBytes` of posts in memory (rounded up to
+    // whole 1 MB arena chunks of bodies), spilling older ones to segment
+    // files in `directory`. Durable segments are kept for snapshots to refer
+    // to (see PostSegments). Call at most once, before adoptSegments.
+    // Returns false if the directory cannot be used.
+    bool setRetention(const std::string& directory, size_t residentBytes, bool durable = false) {
+        if (!openSegments(directory, durable)) return false;
+        residentLimit = std::max<size_t>(residentBytes, 1);
+        retaining = true;
+        return true;
+    }
+
+    // Takes back the bodies of posts [0, count) that a snapshot left in
+    // durable segment files; add the posts themselves with appendStored.
+    // Opens the segments in `directory` unless setRetention already did.
+    // Call on an empty store. False if the files do not match.
+    bool adoptSegments(const std::string& directory, const std::vector<uint64_t>& fileSizes, size_t count) {
+        if (!segments.isOpen() && (count == 0 || !openSegments(directory, true))) return count == 0;
+        if (!segments.adopt(fileSizes, count)) return false;
+        spilled.store(count, std::memory_order_release);
+        return true;
+    }
+
+    // Makes the segment files durable up to now, before a snapshot names them.
+    bool syncSegments() { return segments.sync(); }
+
+    // Keeps spills from freeing resident posts until the result is
+    // destroyed, so what get() and content() return stays valid meanwhile.
+    // Only needed by readers that run alongside append; holds nothing
+    // without a retention budget.
+    std::shared_lock<std::shared_mutex> pin() const {
+        if (!retaining) return std::shared_lock<std::shared_mutex>();
+        return std::shared_lock<std::shared_mutex>(spillLock);
+    }
+
+    size_t spilledPosts() const { return spilled.load(std::memory_order_acquire); }
+    const PostSegments& getSegments() const { return segments; }
+    size_t residentContentBytes() const { return arena.allocatedBytes(); }
+
+    // Bytes the retention budget counts: resident bodies and column chunks
+    size_t residentBytes() const {
+        return arena.allocatedBytes() + (chunks.size() - freedChunks) * sizeof(Chunk);
+    }
+
+    // Spills the oldest arena chunk, if there is one besides the newest.
+    // False if there is not, or the write failed; after a failure the store
+    // keeps everything in memory from then on.
+    bool spillOldest() {
+        size_t chunk;
+        if (residentLimit == 0 || !spillableChunk(chunk)) return false;
+        if (spill(chunk)) return true;
+        std::cerr << "Cannot write post segments; keeping all posts in memory from now on.\n";
+        residentLimit = 0;
+        return false;
+    }
+
+    // Returns the new post's index. Not to be called from two threads at once.
+    size_t append(UserId author, int64_t timestamp, std::string_view content, int likes = 0) {
+        size_t index = total.load(std::memory_order_relaxed);
+        if (index % CHUNK_POSTS == 0) chunks.emplace_back(new Chunk);
+        else if (!chunks[index / CHUNK_POSTS]) chunks[index / CHUNK_POSTS].reset(new Chunk); // Began with stored posts
+        Chunk& c = chunkOf(index);
+        size_t i = index % CHUNK_POSTS;
+        c.authors[i] = author;
+        c.timestamps[i] = timestamp;
+        c.likeCounts[i].store(likes, std::memory_order_relaxed);
+        c.contentLocations[i] = arena.add(content);
+        c.contentLengths[i] = static_cast<uint32_t>(content.size());
+        total.store(index + 1, std::memory_order_release);
+        while (residentLimit > 0 && residentBytes() > residentLimit && spillOldest()) {}
+        return index;
+    }
+
+    // Adds a post whose body adoptSegments already took back. Returns its
+    // index, or SIZE_MAX if its columns cannot be written.
+    size_t appendStored(UserId author, int64_t timestamp, int likes) {
+        size_t index = total.load(std::memory_order_relaxed);
+        SpilledPost record{author, likes, timestamp};
+        if (!columns.write(spilledPostOffset(index), &record, sizeof(record))) return SIZE_MAX;
+        // Keeps chunk k holding posts from k * CHUNK_POSTS on
+        if (index % CHUNK_POSTS == 0) chunks.emplace_back();
+        freedChunks = (index + 1) / CHUNK_POSTS;
+        total.store(index + 1, std::memory_order_release);
+        if (index + 1 == spilledPosts() && !columns.flush()) return SIZE_MAX;
+        return index;
+    }
+
+    // Post `index`, with `readable` false if a spilled one cannot be read
+    PostView get(size_t index) const {
+        if (!isSpilled(index)) {
+            return PostView{index, author(index), timestamp(index), likes(index), residentBody(index)};
+        }
+        SpilledPost post{};
+        std::string_view body;
+        bool readable = readSpilled(index, post) && segments.get(index, body);
+        return PostView{index, post.author, post.timestamp, post.likes, body, readable};
+    }
+
+    // NO_USER, 0 and 0 for a spilled post that cannot be read
+    UserId author(size_t index) const {
+        if (!isSpilled(index)) return chunkOf(index).authors[index % CHUNK_POSTS];
+        SpilledPost post;
+        return readSpilled(index, post) ? post.author : NO_USER;
+    }
+
+    int64_t timestamp(size_t index) const {
+        if (!isSpilled(index)) return chunkOf(index).timestamps[index % CHUNK_POSTS];
+        SpilledPost post;
+        return readSpilled(index, post) ? post.timestamp : 0;
+    }
+
+    int likes(size_t index) const {
+        if (!isSpilled(index)) return chunkOf(index).likeCounts[index % CHUNK_POSTS].load(std::memory_order_relaxed);
+        SpilledPost post;
+        return readSpilled(index, post) ? post.likes : 0;
+    }
+
+    // Sets `body` to post `index`'s. A spilled body stays valid until this
+    // thread has read PostSegments::CACHE_BLOCKS other blocks of them; use
+    // it right away. False if it cannot be read.
+    bool content(size_t index, std::string_view& body) const {
+        if (isSpilled(index)) return segments.get(index, body);
+        body = residentBody(index);
+        return true;
+    }
+
+    void like(size_t index) {
+        if (!isSpilled(index)) chunkOf(index).likeCounts[index % CHUNK_POSTS].fetch_add(1, std::memory_order_relaxed);
+        else likeSpilled(index, 1);
+    }
+
+    void unlike(size_t index) {
+        if (!isSpilled(index)) chunkOf(index).likeCounts[index % CHUNK_POSTS].fetch_sub(1, std::memory_order_relaxed);
+        else likeSpilled(index, -1);
+    }
+
+    // Heap bytes held by the columns, the arena and the segment directory.
+    size_t memoryBytes() const {
+        return residentBytes() + chunks.capacity() * sizeof(std::unique_ptr<Chunk>) + segments.memoryBytes() +
+               columns.memoryBytes();
+    }
+};
+
+#endif // POST_STORE_HPP
\ No newline at end of file
@@ -0,0 +1,384 @@
+#ifndef RENDER_HPP
+#define RENDER_HPP
+
+#include "PostStore.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+#include <cstdio>
+
+enum class OutputFormat {
+    Text,     // Human-readable, as shown in the menus
+    JsonLines // One JSON object per record, for tools
+};
+
+// The format travels with the stream (in an iword slot), so every view that
+// takes a std::ostream& renders in whatever format its caller chose.
+inline int outputFormatSlot() {
+    static const int slot = std::ios_base::xalloc();
+    return slot;
+}
+
+inline void setOutputFormat(std::ostream& out, OutputFormat format) {
+    out.iword(outputFormatSlot()) = static_cast<long>(format);
+}
+
+inline OutputFormat outputFormat(std::ostream& out) {
+    return static_cast<OutputFormat>(out.iword(outputFormatSlot()));
+}
+
+// Serialises one view (a feed page, a profile, search results, a status
+// message...) into a buffer and writes it to the stream in one go when
+// destroyed, followed by a single flush: one write per view instead of one
+// per field or line. Each thread reuses its buffer from one view to the next.
+//
+// In JSON-lines format every record is one object with a "type" field;
+// section headings become {"type":"section"} records.
+class Renderer {
+private:
+    std::ostream& out;
+    bool json;
+    std::string buffer;
+
+    static std::string& spareBuffer() {
+        static thread_local std::string spare;
+        return spare;
+    }
+
+    void quoted(std::string_view s) {
+        buffer += '"';
+        for (char c : s) {
+            switch (c) {
+                case '"': buffer += "\\\""; break;
+                case '\\': buffer += "\\\\"; break;
+                case '\n': buffer += "\\n"; break;
+                case '\r': buffer += "\\r"; break;
+                case '\t': buffer += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                        buffer += escaped;
+                    } else {
+                        buffer += c;
+                    }
+            }
+        }
+        buffer += '"';
+    }
+
+    // JSON object helpers: begin("post").field("id", 3).field("content", s).end()
+    Renderer& begin(const char* type) {
+        buffer += "{\"type\":\"";
+        buffer += type;
+        buffer += '"';
+        return *this;
+    }
+
+    Renderer& field(const char* name, std::string_view value) {
+        buffer += ",\"";
+        buffer += name;
+        buffer += "\":";
+        quoted(value);
+        return *this;
+    }
+
+    Renderer& field(const char* name, int64_t value) {
+        buffer += ",\"";
+        buffer += name;
+        buffer += "\":";
+        buffer += std::to_string(value);
+        return *this;
+    }
+
+    Renderer& decimalField(const char* name, double value) {
+        char number[32];
+        std::snprintf(number, sizeof(number), "%.3f", value);
+        buffer += ",\"";
+        buffer += name;
+        buffer += "\":";
+        buffer += number;
+        return *this;
+    }
+
+    void end() {
+        buffer += "}\n";
+    }
+
+    // " - 3 mutual connections" and the end of the line
+    void mutualNote(size_t mutual) {
+        buffer += " - ";
+        buffer += std::to_string(mutual);
+        buffer += mutual == 1 ? " mutual connection\n" : " mutual connections\n";
+    }
+
+public:
+    explicit Renderer(std::ostream& stream) : out(stream), json(outputFormat(stream) == OutputFormat::JsonLines) {
+        buffer.swap(spareBuffer());
+        buffer.clear();
+    }
+
+    Renderer(const Renderer&) = delete;
+    Renderer& operator=(const Renderer&) = delete;
+
+    ~Renderer() {
+        flush();
+        spareBuffer().swap(buffer);
+    }
+
+    // Writes what has been rendered so far.
+    void flush() {
+        if (buffer.empty()) return;
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        out.flush();
+        buffer.clear();
+    }
+
+    bool isJson() const { return json; }
+
+    // "--- title ---" above a list
+    void heading(std::string_view title) {
+        if (json) {
+            begin("section").field("title", title).end();
+        } else {
+            buffer += "\n--- ";
+            buffer += title;
+            buffer += " ---\n";
+        }
+    }
+
+    // A status line, e.g. "Post created successfully!"
+    void message(std::string_view text) {
+        if (json) {
+            begin("message").field("text", text).end();
+        } else {
+            buffer += text;
+            buffer += '\n';
+        }
+    }
+
+    void post(const PostView& post, std::string_view author) {
+        if (json) {
+            begin("post")
+                .field("id", static_cast<int64_t>(post.index))
+                .field("author", author)
+                .field("timestamp", post.timestamp)
+                .field("likes", post.likes)
+                .field("content", post.content)
+                .end();
+        } else {
+            buffer += "    \"";
+            buffer += post.content;
+            buffer += "\"\n    - ";
+            buffer += author;
+            buffer += " | Likes: ";
+            buffer += std::to_string(post.likes);
+            buffer += " | Post #";
+            buffer += std::to_string(post.index);
+            buffer += "\n------------------------\n";
+        }
+    }
+
+    // In place of a post that could not be read back from disk
+    void unreadablePost(size_t index) {
+        if (json) {
+            begin("post").field("id", static_cast<int64_t>(index)).field("error", "could not be read from disk").end();
+        } else {
+            buffer += "    [Post #";
+            buffer += std::to_string(index);
+            buffer += " could not be read from disk]\n------------------------\n";
+        }
+    }
+
+    void profile(std::string_view kind, std::string_view username, std::string_view fullName,
+                 std::string_view label1, std::string_view detail1, std::string_view label2, std::string_view detail2,
+                 size_t connections) {
+        if (json) {
+            begin("profile")
+                .field("kind", kind)
+                .field("username", username)
+                .field("name", fullName)
+                .field("detail1", detail1)
+                .field("detail2", detail2)
+                .field("connections", static_cast<int64_t>(connections))
+                .end();
+            return;
+        }
+        size_t headerLength = buffer.size();
+        buffer += "\n--- ";
+        buffer += kind;
+        buffer += " Profile ---\n";
+        headerLength = buffer.size() - headerLength - 2;
+        buffer += "Name: ";
+        buffer += fullName;
+        buffer += " (@";
+        buffer += username;
+        buffer += ")\n";
+        buffer += label1;
+        buffer += ": ";
+        buffer += detail1;
+        buffer += '\n';
+        buffer += label2;
+        buffer += ": ";
+        buffer += detail2;
+        buffer += "\nConnections: ";
+        buffer += std::to_string(connections);
+        buffer += '\n';
+        buffer.append(headerLength, '-');
+        buffer += '\n';
+    }
+
+    // One user in a list, e.g. a search result
+    void user(std::string_view username, std::string_view fullName) {
+        if (json) {
+            begin("user").field("username", username).field("name", fullName).end();
+        } else {
+            buffer += "- @";
+            buffer += username;
+            buffer += " (";
+            buffer += fullName;
+            buffer += ")\n";
+        }
+    }
+
+    // A search result with the connections it shares with the viewer
+    void user(std::string_view username, std::string_view fullName, size_t mutual) {
+        if (json) {
+            begin("user")
+                .field("username", username)
+                .field("name", fullName)
+                .field("mutual", static_cast<int64_t>(mutual))
+                .end();
+        } else {
+            buffer += "- @";
+            buffer += username;
+            buffer += " (";
+            buffer += fullName;
+            buffer += ')';
+            if (mutual > 0) {
+                mutualNote(mutual);
+            } else {
+                buffer += '\n';
+            }
+        }
+    }
+
+    void suggestion(std::string_view username, std::string_view fullName, size_t mutual) {
+        if (json) {
+            begin("suggestion")
+                .field("username", username)
+                .field("name", fullName)
+                .field("mutual", static_cast<int64_t>(mutual))
+                .end();
+        } else {
+            buffer += "- @";
+            buffer += username;
+            buffer += " (";
+            buffer += fullName;
+            buffer += ')';
+            mutualNote(mutual);
+        }
+    }
+
+    // A pending connection request; `incoming` if `username` sent it
+    void request(std::string_view username, bool incoming) {
+        if (json) {
+            begin("request").field("username", username).field("direction", incoming ? "incoming" : "outgoing").end();
+        } else {
+            buffer += "- ";
+            buffer += username;
+            buffer += '\n';
+        }
+    }
+
+    // The same, with the connections the two users share
+    void request(std::string_view username, bool incoming, size_t mutual) {
+        if (json) {
+            begin("request")
+                .field("username", username)
+                .field("direction", incoming ? "incoming" : "outgoing")
+                .field("mutual", static_cast<int64_t>(mutual))
+                .end();
+        } else {
+            buffer += "- ";
+            buffer += username;
+            if (mutual > 0) {
+                mutualNote(mutual);
+            } else {
+                buffer += '\n';
+            }
+        }
+    }
+
+    // A trending hashtag and about how many recent posts used it
+    void trend(std::string_view tag, uint64_t postCount) {
+        if (json) {
+            begin("trend").field("tag", tag).field("posts", static_cast<int64_t>(postCount)).end();
+        } else {
+            buffer += "- #";
+            buffer += tag;
+            buffer += " (";
+            buffer += std::to_string(postCount);
+            buffer += postCount == 1 ? " post)\n" : " posts)\n";
+        }
+    }
+
+    // Latency summary of one operation, in microseconds
+    void stat(std::string_view operation, uint64_t count, double meanUs, double p50Us, double p99Us, double maxUs) {
+        if (json) {
+            begin("stat")
+                .field("operation", operation)
+                .field("count", static_cast<int64_t>(count))
+                .decimalField("mean_us", meanUs)
+                .decimalField("p50_us", p50Us)
+                .decimalField("p99_us", p99Us)
+                .decimalField("max_us", maxUs)
+                .end();
+            return;
+        }
+        char line[160];
+        std::snprintf(line, sizeof(line), ": %llu calls, mean %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us\n",
+                      static_cast<unsigned long long>(count), meanUs, p50Us, p99Us, maxUs);
+        buffer += operation;
+        buffer += line;
+    }
+
+    void counter(std::string_view name, uint64_t value) {
+        if (json) {
+            begin("counter").field("name", name).field("value", static_cast<int64_t>(value)).end();
+        } else {
+            buffer += name;
+            buffer += ": ";
+            buffer += std::to_string(value);
+            buffer += '\n';
+        }
+    }
+
+    // A chain of connections, first user to last
+    void path(const std::vector<std::string_view>& usernames) {
+        size_t hops = usernames.empty() ? 0 : usernames.size() - 1;
+        if (json) {
+            buffer += "{\"type\":\"path\",\"hops\":";
+            buffer += std::to_string(hops);
+            buffer += ",\"users\":[";
+            for (size_t i = 0; i < usernames.size(); i++) {
+                if (i > 0) buffer += ',';
+                quoted(usernames[i]);
+            }
+            buffer += "]}\n";
+            return;
+        }
+        for (size_t i = 0; i < usernames.size(); i++) {
+            if (i > 0) buffer += " -> ";
+            buffer += '@';
+            buffer += usernames[i];
+        }
+        buffer += '\n';
+        buffer += std::to_string(hops);
+        buffer += hops == 1 ? " degree of separation.\n" : " degrees of separation.\n";
+    }
+};
+
+#endif // RENDER_HPP
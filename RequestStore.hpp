@@ -0,0 +1,296 @@
+#ifndef REQUEST_STORE_HPP
+#define REQUEST_STORE_HPP
+
+#include "UsernameTable.hpp"
+#include "AppendOnlyList.hpp"
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <cstdint>
+
+// Pending connection requests, keyed by (sender, recipient).
+//
+// Requests live in a slot array and are threaded onto three intrusive
+// doubly-linked lists: the recipient's incoming list, the sender's outgoing
+// list and one list per shard in send order. A hash index maps each pair to
+// its slot, so insert, lookup and removal are O(1) however many requests a
+// user has, and the lists keep their order without shifting anything.
+// Expiry walks each shard's list from its oldest end.
+//
+// Users are split over SHARDS shards by id, each behind a reader/writer
+// lock. A shard holds the index and send-order list of the requests to its
+// users, and the incoming and outgoing lists of its users; a slot's links
+// for a list are only touched under the lock of the shard owning that list.
+// Inserting or removing a request locks the shards of both ends, in shard
+// order, so requests between different users run in parallel and readers
+// only wait for writers in their own shard. The slots are an
+// AppendOnlyList, so they never move while other shards add more.
+class RequestStore {
+public:
+    static constexpr int64_t DEFAULT_TTL = 30 * 24 * 60 * 60; // 30 days, in seconds
+
+    struct Request {
+        UserId from;
+        UserId to;
+        int64_t sentAt; // Seconds since the epoch
+    };
+
+    enum class Insertion {
+        Added,
+        AlreadyPending,
+        ReversePending // `to` had already asked `from`; nothing was added
+    };
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFF;
+    static constexpr size_t SHARDS = 16;
+    enum List { INCOMING, OUTGOING, ALL, LIST_COUNT };
+
+    struct Links {
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+    };
+
+    struct Slot {
+        Request request;
+        uint64_t sequence; // Send order across shards
+        Links links[LIST_COUNT];
+    };
+
+    struct Head {
+        uint32_t first = NONE;
+        uint32_t last = NONE;
+        uint32_t count = 0;
+    };
+
+    struct Shard {
+        mutable std::shared_mutex lock;
+        std::unordered_map<uint64_t, uint32_t> index; // (from, to) -> slot, for requests to this shard
+        std::vector<Head> incoming;                   // Indexed by recipient / SHARDS
+        std::vector<Head> outgoing;                   // Indexed by sender / SHARDS
+        Head all;                                     // Requests to this shard, in send order
+        std::vector<uint32_t> freeSlots;
+    };
+
+    using Lock = std::unique_lock<std::shared_mutex>;
+
+    AppendOnlyList<Slot> slots;
+    Shard shards[SHARDS];
+    std::atomic<size_t> count{0};
+    std::atomic<uint64_t> sent{0};
+
+    static uint64_t key(UserId from, UserId to) {
+        return (static_cast<uint64_t>(from) << 32) | to;
+    }
+
+    static size_t shardIndex(UserId id) { return id % SHARDS; }
+    Shard& shardOf(UserId id) { return shards[shardIndex(id)]; }
+    const Shard& shardOf(UserId id) const { return shards[shardIndex(id)]; }
+
+    static Head& headFor(std::vector<Head>& heads, UserId id) {
+        size_t i = id / SHARDS;
+        if (i >= heads.size()) heads.resize(i + 1);
+        return heads[i];
+    }
+
+    static const Head* findHead(const std::vector<Head>& heads, UserId id) {
+        size_t i = id / SHARDS;
+        return i < heads.size() ? &heads[i] : nullptr;
+    }
+
+    // Locks the shards of `a` and `b` exclusively, lower shard first.
+    std::pair<Lock, Lock> lockPair(UserId a, UserId b) {
+        size_t x = shardIndex(a), y = shardIndex(b);
+        Lock first(shards[std::min(x, y)].lock);
+        Lock second;
+        if (x != y) second = Lock(shards[std::max(x, y)].lock);
+        return {std::move(first), std::move(second)};
+    }
+
+    void link(Head& head, uint32_t s, List list) {
+        Links& l = slots[s].links[list];
+        l.prev = head.last;
+        l.next = NONE;
+        if (head.last != NONE) slots[head.last].links[list].next = s;
+        else head.first = s;
+        head.last = s;
+        head.count++;
+    }
+
+    void unlink(Head& head, uint32_t s, List list) {
+        Links& l = slots[s].links[list];
+        if (l.prev != NONE) slots[l.prev].links[list].next = l.next;
+        else head.first = l.next;
+        if (l.next != NONE) slots[l.next].links[list].prev = l.prev;
+        else head.last = l.prev;
+        head.count--;
+    }
+
+    // Callers hold both ends' shard locks.
+    void release(uint32_t s) {
+        Request r = slots[s].request;
+        Shard& to = shardOf(r.to);
+        unlink(to.incoming[r.to / SHARDS], s, INCOMING);
+        unlink(shardOf(r.from).outgoing[r.from / SHARDS], s, OUTGOING);
+        unlink(to.all, s, ALL);
+        to.index.erase(key(r.from, r.to));
+        to.freeSlots.push_back(s);
+        count.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    template <typename Fn>
+    void walk(const Head& head, List list, Fn fn) const {
+        for (uint32_t s = head.first; s != NONE; s = slots[s].links[list].next) {
+            fn(slots[s].request);
+        }
+    }
+
+public:
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+
+    bool contains(UserId from, UserId to) const {
+        const Shard& shard = shardOf(to);
+        std::shared_lock<std::shared_mutex> held(shard.lock);
+        return shard.index.count(key(from, to)) != 0;
+    }
+
+    // Adds the request unless it, or with `checkReverse` one from `to` to
+    // `from`, is pending. fn() runs if it was added, before the shard locks
+    // are released, so whatever it logs is ordered like the store.
+    template <typename Fn>
+    Insertion insert(UserId from, UserId to, int64_t sentAt, bool checkReverse, Fn fn) {
+        auto held = lockPair(from, to);
+        Shard& shard = shardOf(to);
+        if (checkReverse && shardOf(from).index.count(key(to, from))) return Insertion::ReversePending;
+        auto inserted = shard.index.emplace(key(from, to), NONE);
+        if (!inserted.second) return Insertion::AlreadyPending;
+
+        uint32_t s;
+        if (!shard.freeSlots.empty()) {
+            s = shard.freeSlots.back();
+            shard.freeSlots.pop_back();
+        } else {
+            s = static_cast<uint32_t>(slots.emplace_back());
+        }
+        slots[s].request = Request{from, to, sentAt};
+        slots[s].sequence = sent.fetch_add(1, std::memory_order_relaxed);
+        inserted.first->second = s;
+        link(headFor(shard.incoming, to), s, INCOMING);
+        link(headFor(shardOf(from).outgoing, from), s, OUTGOING);
+        link(shard.all, s, ALL);
+        count.fetch_add(1, std::memory_order_relaxed);
+        fn();
+        return Insertion::Added;
+    }
+
+    // Returns false if the request is already pending.
+    bool insert(UserId from, UserId to, int64_t sentAt) {
+        return insert(from, to, sentAt, false, [] {}) == Insertion::Added;
+    }
+
+    // Returns false if there was no such request. fn() runs if it was
+    // removed, before the shard locks are released.
+    template <typename Fn>
+    bool remove(UserId from, UserId to, Fn fn) {
+        auto held = lockPair(from, to);
+        Shard& shard = shardOf(to);
+        auto it = shard.index.find(key(from, to));
+        if (it == shard.index.end()) return false;
+        release(it->second);
+        fn();
+        return true;
+    }
+
+    bool remove(UserId from, UserId to) {
+        return remove(from, to, [] {});
+    }
+
+    size_t incomingCount(UserId to) const {
+        const Shard& shard = shardOf(to);
+        std::shared_lock<std::shared_mutex> held(shard.lock);
+        const Head* head = findHead(shard.incoming, to);
+        return head ? head->count : 0;
+    }
+
+    size_t outgoingCount(UserId from) const {
+        const Shard& shard = shardOf(from);
+        std::shared_lock<std::shared_mutex> held(shard.lock);
+        const Head* head = findHead(shard.outgoing, from);
+        return head ? head->count : 0;
+    }
+
+    // Calls fn(const Request&) for each request to `to`, oldest first, with
+    // its shard locked shared.
+    template <typename Fn>
+    void forEachIncoming(UserId to, Fn fn) const {
+        const Shard& shard = shardOf(to);
+        std::shared_lock<std::shared_mutex> held(shard.lock);
+        if (const Head* head = findHead(shard.incoming, to)) walk(*head, INCOMING, fn);
+    }
+
+    // Calls fn(const Request&) for each request from `from`, oldest first,
+    // with its shard locked shared.
+    template <typename Fn>
+    void forEachOutgoing(UserId from, Fn fn) const {
+        const Shard& shard = shardOf(from);
+        std::shared_lock<std::shared_mutex> held(shard.lock);
+        if (const Head* head = findHead(shard.outgoing, from)) walk(*head, OUTGOING, fn);
+    }
+
+    // Calls fn(const Request&) for every request in the order they were
+    // sent, from a copy taken with every shard locked shared.
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        std::vector<std::pair<uint64_t, Request>> pending;
+        {
+            std::vector<std::shared_lock<std::shared_mutex>> held;
+            held.reserve(SHARDS);
+            for (const Shard& shard : shards) held.emplace_back(shard.lock);
+            for (const Shard& shard : shards) {
+                for (uint32_t s = shard.all.first; s != NONE; s = slots[s].links[ALL].next) {
+                    pending.emplace_back(slots[s].sequence, slots[s].request);
+                }
+            }
+        }
+        std::sort(pending.begin(), pending.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (const auto& entry : pending) fn(entry.second);
+    }
+
+    // Removes requests sent at or before `cutoff`, calling fn(const Request&)
+    // for each before the shard locks are released. Each shard stops at its
+    // first newer request, so one sent with an earlier timestamp than its
+    // predecessor waits for them. Returns how many were removed.
+    template <typename Fn>
+    size_t expire(int64_t cutoff, Fn fn) {
+        size_t removed = 0;
+        std::vector<Request> due;
+        for (Shard& shard : shards) {
+            due.clear();
+            {
+                std::shared_lock<std::shared_mutex> held(shard.lock);
+                for (uint32_t s = shard.all.first; s != NONE && slots[s].request.sentAt <= cutoff;
+                     s = slots[s].links[ALL].next) {
+                    due.push_back(slots[s].request);
+                }
+            }
+            // Relocked with the senders' shards; another thread may have
+            // removed or replaced one meanwhile
+            for (const Request& r : due) {
+                auto held = lockPair(r.from, r.to);
+                auto it = shard.index.find(key(r.from, r.to));
+                if (it == shard.index.end() || slots[it->second].request.sentAt > cutoff) continue;
+                release(it->second);
+                fn(r);
+                removed++;
+            }
+        }
+        return removed;
+    }
+};
+
+#endif // REQUEST_STORE_HPP
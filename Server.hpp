@@ -0,0 +1,386 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "Network.hpp"
+#include "CommandSession.hpp"
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <iostream>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+// Serves many concurrent sessions over a Unix domain socket.
+//
+// Protocol: the client sends CommandSession lines; for each one the server
+// replies with the command's output followed by a line containing only ".".
+//
+// One thread runs an epoll loop that accepts connections and does all socket
+// I/O. Complete lines are handed to a pool of workers that execute them
+// against the shared Network. Feed pages take no server lock at all, only
+// the Network's per-user locks, so they never wait for a writer to finish.
+// Other read-only commands, likes and requests run under a shared lock, in
+// parallel; other mutations, and a request that turns out to connect two
+// users, under an exclusive one. Each connection has at
+// most one command in flight, so a session sees its commands in order. When a
+// peer hangs up, the lines it already sent still run before the connection
+// closes. Lines over MAX_LINE and replies left unread past MAX_OUTPUT drop
+// the connection.
+//
+// A change is acknowledged only once `commit` says it is durable. Workers call
+// it after releasing the lock, so changes from many sessions share one fsync.
+class Server {
+private:
+    struct Connection {
+        int fd;
+        CommandSession session;
+        std::string input;              // Bytes read but not yet split into lines
+        std::deque<std::string> queued; // Complete lines waiting for a worker
+        bool busy = false;              // A worker is running one of its lines
+        std::string output;             // Replies waiting to be written
+        bool closing = false;
+        bool peerClosed = false;        // Read end of the socket reached
+        bool replyLost = false;         // Writing failed; replies are dropped
+
+        Connection(int socket, Network& net) : fd(socket), session(net) {}
+    };
+
+    static constexpr size_t MAX_LINE = 64 * 1024;          // Longest command line accepted
+    static constexpr size_t MAX_QUEUED = 256;              // Lines read ahead per connection
+    static constexpr size_t MAX_OUTPUT = 16 * 1024 * 1024; // Unsent reply bytes per connection
+
+    Network& net;
+    std::shared_mutex netLock;
+    std::function<bool()> commit; // Makes logged changes durable; may be empty
+
+    std::string socketPath;
+    size_t workerCount;
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1; // eventfd: workers finished something, or shutdown
+
+    std::unordered_map<int, std::shared_ptr<Connection>> connections; // Loop thread only
+
+    // Finished replies, handed back from workers to the loop thread
+    std::mutex doneLock;
+    std::vector<std::pair<std::shared_ptr<Connection>, std::string>> done;
+
+    // Work queue for the pool
+    std::mutex taskLock;
+    std::condition_variable taskReady;
+    std::deque<std::pair<std::shared_ptr<Connection>, std::string>> tasks;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    static std::atomic<int>& signalWakeFd() {
+        static std::atomic<int> fd{-1};
+        return fd;
+    }
+
+    static std::atomic<bool>& stopRequested() {
+        static std::atomic<bool> flag{false};
+        return flag;
+    }
+
+    static void onSignal(int) {
+        stopRequested().store(true);
+        uint64_t one = 1;
+        int fd = signalWakeFd().load();
+        if (fd >= 0) {
+            ssize_t ignored = ::write(fd, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+
+    static bool setNonBlocking(int fd) {
+        int flags = ::fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    void workerLoop() {
+        while (true) {
+            std::pair<std::shared_ptr<Connection>, std::string> task;
+            {
+                std::unique_lock<std::mutex> lock(taskLock);
+                taskReady.wait(lock, [&] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+
+            std::ostringstream reply;
+            CommandSession& session = task.first->session;
+            CommandType type = CommandSession::peek(task.second);
+            bool ran = false;
+            if (CommandSession::isLockFree(type)) {
+                session.execute(task.second, reply);
+                ran = true;
+            } else if (CommandSession::isConcurrent(type)) {
+                std::shared_lock<std::shared_mutex> lock(netLock);
+                ran = session.executeShared(task.second, reply);
+            }
+            if (!ran) {
+                std::unique_lock<std::shared_mutex> lock(netLock);
+                session.execute(task.second, reply);
+            }
+            if (commit && !CommandSession::isReadOnly(type) && !commit()) {
+                reply << "Warning: this change could not be saved and may be lost on restart.\n";
+            }
+            reply << ".\n";
+
+            {
+                std::lock_guard<std::mutex> lock(doneLock);
+                done.emplace_back(std::move(task.first), reply.str());
+            }
+            uint64_t one = 1;
+            ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+
+    void submit(const std::shared_ptr<Connection>& conn) {
+        if (conn->busy || conn->queued.empty()) return;
+        conn->busy = true;
+        std::string line = std::move(conn->queued.front());
+        conn->queued.pop_front();
+        {
+            std::lock_guard<std::mutex> lock(taskLock);
+            tasks.emplace_back(conn, std::move(line));
+        }
+        taskReady.notify_one();
+    }
+
+    // Stops reading while a connection has MAX_QUEUED lines waiting, and once
+    // its peer has finished sending.
+    void watch(const std::shared_ptr<Connection>& conn) {
+        uint32_t events = 0;
+        if (!conn->peerClosed && conn->queued.size() < MAX_QUEUED) events |= EPOLLIN;
+        if (!conn->output.empty()) events |= EPOLLOUT;
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = conn->fd;
+        ::epoll_ctl(epollFd, EPOLL_CTL_MOD, conn->fd, &ev);
+    }
+
+    void closeConnection(const std::shared_ptr<Connection>& conn) {
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, conn->fd, nullptr);
+        ::close(conn->fd);
+        conn->closing = true;
+        connections.erase(conn->fd);
+    }
+
+    // Hands the next line to a worker, then closes a connection whose peer
+    // has gone once every line it sent has been answered.
+    void settle(const std::shared_ptr<Connection>& conn) {
+        if (conn->closing) return;
+        submit(conn);
+        if (conn->peerClosed && !conn->busy && conn->queued.empty() && conn->output.empty()) {
+            closeConnection(conn);
+            return;
+        }
+        watch(conn);
+    }
+
+    void acceptClients() {
+        while (true) {
+            int fd = ::accept(listenFd, nullptr, nullptr);
+            if (fd < 0) return; // EAGAIN: no more pending
+            setNonBlocking(fd);
+            auto conn = std::make_shared<Connection>(fd, net);
+            connections[fd] = conn;
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            ::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+        }
+    }
+
+    // Reads until the socket is empty or MAX_QUEUED lines wait; `drain`
+    // reads everything left regardless.
+    void readFrom(const std::shared_ptr<Connection>& conn, bool drain = false) {
+        char buffer[4096];
+        while (!conn->peerClosed && (drain || conn->queued.size() < MAX_QUEUED)) {
+            ssize_t n = ::read(conn->fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                conn->input.append(buffer, static_cast<size_t>(n));
+                splitLines(*conn);
+                if (conn->input.size() > MAX_LINE) {
+                    closeConnection(conn);
+                    return;
+                }
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            // The peer is done sending; its lines still run, and an
+            // unterminated last one counts
+            conn->peerClosed = true;
+            if (!conn->input.empty()) conn->queued.push_back(std::move(conn->input));
+            conn->input.clear();
+        }
+        settle(conn);
+    }
+
+    static void splitLines(Connection& conn) {
+        size_t start = 0;
+        size_t newline;
+        while ((newline = conn.input.find('\n', start)) != std::string::npos) {
+            conn.queued.push_back(conn.input.substr(start, newline - start));
+            start = newline + 1;
+        }
+        conn.input.erase(0, start);
+    }
+
+    // Writes what the socket takes. A peer that lets MAX_OUTPUT bytes of
+    // replies pile up is disconnected.
+    void writeTo(const std::shared_ptr<Connection>& conn) {
+        while (!conn->output.empty()) {
+            ssize_t n = ::write(conn->fd, conn->output.data(), conn->output.size());
+            if (n > 0) {
+                conn->output.erase(0, static_cast<size_t>(n));
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            // The peer is gone: still run the lines it sent, but drop replies
+            conn->replyLost = true;
+            conn->output.clear();
+            readFrom(conn, true);
+            return;
+        }
+        if (conn->output.size() > MAX_OUTPUT) closeConnection(conn);
+    }
+
+    void collectReplies() {
+        uint64_t count = 0;
+        ssize_t ignored = ::read(wakeFd, &count, sizeof(count));
+        (void)ignored;
+
+        std::vector<std::pair<std::shared_ptr<Connection>, std::string>> ready;
+        {
+            std::lock_guard<std::mutex> lock(doneLock);
+            ready.swap(done);
+        }
+        for (auto& item : ready) {
+            auto& conn = item.first;
+            conn->busy = false;
+            if (conn->closing) continue;
+            if (!conn->replyLost) {
+                conn->output += item.second;
+                writeTo(conn);
+            }
+            settle(conn);
+        }
+    }
+
+public:
+    Server(Network& network, const std::string& path, size_t threads, std::function<bool()> durable = nullptr)
+        : net(network), commit(std::move(durable)), socketPath(path), workerCount(threads ? threads : 1) {}
+
+    ~Server() {
+        if (listenFd >= 0) ::close(listenFd);
+        if (epollFd >= 0) ::close(epollFd);
+        if (wakeFd >= 0) ::close(wakeFd);
+    }
+
+    // Runs until SIGINT or SIGTERM. Returns false if the socket cannot be set up.
+    bool run() {
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (listenFd < 0 || socketPath.size() >= sizeof(addr.sun_path)) return false;
+        std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+        ::unlink(socketPath.c_str());
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::listen(listenFd, SOMAXCONN) != 0 || !setNonBlocking(listenFd)) {
+            return false;
+        }
+
+        epollFd = ::epoll_create1(0);
+        wakeFd = ::eventfd(0, EFD_NONBLOCK);
+        if (epollFd < 0 || wakeFd < 0) return false;
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = listenFd;
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+        ev.data.fd = wakeFd;
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+        // Signals set the stop flag and wake the loop through the eventfd
+        stopRequested().store(false);
+        signalWakeFd().store(wakeFd);
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+        std::signal(SIGPIPE, SIG_IGN);
+
+        for (size_t i = 0; i < workerCount; i++) {
+            workers.emplace_back(&Server::workerLoop, this);
+        }
+        std::cout << "Serving on " << socketPath << " with " << workerCount << " workers. Press Ctrl+C to stop.\n";
+
+        std::vector<epoll_event> events(64);
+        while (!stopRequested().load()) {
+            int n = ::epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), -1);
+            if (n < 0 && errno != EINTR) break;
+            for (int i = 0; i < n; i++) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) {
+                    acceptClients();
+                } else if (fd == wakeFd) {
+                    collectReplies();
+                } else {
+                    auto it = connections.find(fd);
+                    if (it == connections.end()) continue;
+                    auto conn = it->second;
+                    if (events[i].events & EPOLLERR) {
+                        closeConnection(conn);
+                        continue;
+                    }
+                    if (events[i].events & EPOLLHUP) {
+                        // Nothing more can be written, but the lines already
+                        // sent still run; stop polling, as HUP cannot be masked
+                        readFrom(conn, true);
+                        if (!conn->closing) ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+                        continue;
+                    }
+                    if (events[i].events & EPOLLIN) readFrom(conn);
+                    if (!conn->closing && (events[i].events & EPOLLOUT)) {
+                        writeTo(conn);
+                        settle(conn);
+                    }
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(taskLock);
+            stopping = true;
+        }
+        taskReady.notify_all();
+        for (auto& worker : workers) worker.join();
+        workers.clear();
+        signalWakeFd().store(-1);
+
+        while (!connections.empty()) closeConnection(connections.begin()->second);
+        ::unlink(socketPath.c_str());
+        std::cout << "Server stopped.\n";
+        return true;
+    }
+};
+
+#endif // SERVER_HPP
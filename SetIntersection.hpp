@@ -0,0 +1,135 @@
+#ifndef SET_INTERSECTION_HPP
+#define SET_INTERSECTION_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Kernels for counting the common elements of two sets of vertex ids, as
+// used for mutual-connection counts.
+//
+// Sorted lists of similar length are merged four ids at a time with SSE2
+// all-pairs compares; a short list against a much longer one gallops through
+// the long one instead; and when one side is a dense neighbourhood it is
+// cheaper to mark it once in an IdBitmap and test the other side's ids.
+
+// One bit per vertex id.
+class IdBitmap {
+private:
+    std::vector<uint64_t> words;
+
+public:
+    IdBitmap() = default;
+    explicit IdBitmap(size_t ids) : words((ids + 63) / 64, 0) {}
+
+    bool test(uint32_t id) const { return (words[id >> 6] >> (id & 63)) & 1; }
+    void set(uint32_t id) { words[id >> 6] |= uint64_t(1) << (id & 63); }
+    void reset(uint32_t id) { words[id >> 6] &= ~(uint64_t(1) << (id & 63)); }
+
+    // Sets `id` and returns true if it was clear.
+    bool testAndSet(uint32_t id) {
+        uint64_t bit = uint64_t(1) << (id & 63);
+        uint64_t& word = words[id >> 6];
+        if (word & bit) return false;
+        word |= bit;
+        return true;
+    }
+
+    // How many of the ids in [first, last) are set.
+    size_t countIn(const uint32_t* first, const uint32_t* last) const {
+        size_t count = 0;
+        for (; first != last; ++first) count += test(*first);
+        return count;
+    }
+};
+
+namespace intersection {
+
+// Lists whose sizes differ by more than this factor are galloped.
+constexpr size_t GALLOP_RATIO = 32;
+
+inline size_t scalarMerge(const uint32_t* a, const uint32_t* aEnd, const uint32_t* b, const uint32_t* bEnd) {
+    size_t count = 0;
+    while (a != aEnd && b != bEnd) {
+        if (*a < *b) {
+            ++a;
+        } else if (*b < *a) {
+            ++b;
+        } else {
+            ++count;
+            ++a;
+            ++b;
+        }
+    }
+    return count;
+}
+
+// Each id of the short list is found in the long one by doubling the step
+// from the last match, then binary searching the bracketed range.
+inline size_t gallop(const uint32_t* small, const uint32_t* smallEnd, const uint32_t* large, const uint32_t* largeEnd) {
+    size_t count = 0;
+    size_t n = static_cast<size_t>(largeEnd - large);
+    size_t lo = 0;
+    for (; small != smallEnd && lo < n; ++small) {
+        size_t step = 1;
+        size_t hi = lo;
+        while (hi < n && large[hi] < *small) {
+            lo = hi + 1;
+            hi += step;
+            step *= 2;
+        }
+        lo = static_cast<size_t>(std::lower_bound(large + lo, large + std::min(hi + 1, n), *small) - large);
+        if (lo < n && large[lo] == *small) {
+            ++count;
+            ++lo;
+        }
+    }
+    return count;
+}
+
+#if defined(__SSE2__)
+// Compares a block of four ids from each list against all four rotations of
+// the other, then advances whichever block has the smaller maximum (both on a
+// tie). Every id appears once per list, so each match is counted once.
+inline size_t simdMerge(const uint32_t* a, const uint32_t* aEnd, const uint32_t* b, const uint32_t* bEnd) {
+    size_t count = 0;
+    while (aEnd - a >= 4 && bEnd - b >= 4) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        __m128i eq = _mm_cmpeq_epi32(va, vb);
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        count += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+
+        uint32_t aMax = a[3];
+        uint32_t bMax = b[3];
+        if (aMax <= bMax) a += 4;
+        if (bMax <= aMax) b += 4;
+    }
+    return count + scalarMerge(a, aEnd, b, bEnd);
+}
+#endif
+
+} // namespace intersection
+
+// Number of ids in both sorted, duplicate-free ranges.
+inline size_t intersectionSize(const uint32_t* a, const uint32_t* aEnd, const uint32_t* b, const uint32_t* bEnd) {
+    size_t na = static_cast<size_t>(aEnd - a);
+    size_t nb = static_cast<size_t>(bEnd - b);
+    if (na == 0 || nb == 0) return 0;
+    if (na > nb * intersection::GALLOP_RATIO) return intersection::gallop(b, bEnd, a, aEnd);
+    if (nb > na * intersection::GALLOP_RATIO) return intersection::gallop(a, aEnd, b, bEnd);
+#if defined(__SSE2__)
+    return intersection::simdMerge(a, aEnd, b, bEnd);
+#else
+    return intersection::scalarMerge(a, aEnd, b, bEnd);
+#endif
+}
+
+#endif // SET_INTERSECTION_HPP
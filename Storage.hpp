@@ -0,0 +1,283 @@
+#ifndef STORAGE_HPP
+#define STORAGE_HPP
+
+#include "Network.hpp"
+#include "WriteAheadLog.hpp"
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <iostream>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Makes a Network durable across restarts.
+//
+// Every mutation is appended to a write-ahead log (wal.log) and, every
+// SNAPSHOT_EVERY records, the whole state is written to snapshot.bin and the
+// log is truncated. Records carry a log sequence number (lsn) and the snapshot
+// stores the last lsn it covers, so a crash between writing the snapshot and
+// truncating the log never applies a record twice.
+//
+// Snapshots are streamed to and from disk rather than built in memory. Post
+// bodies spilled to durable segment files (see PostSegments) stay there: the
+// snapshot records how long each file was, and loading cuts the files back
+// to that, so bodies spilled after it are rebuilt by replaying the log.
+class Storage : public NetworkObserver {
+private:
+    Network& net;
+    std::string directory;
+    WriteAheadLog wal;
+    uint64_t lastLsn = 0;
+    size_t sinceSnapshot = 0;
+    std::mutex logLock; // Likes and requests are logged from several threads at once
+    bool logFailed = false;
+    bool checkpointFailed = false;
+
+    static constexpr size_t SNAPSHOT_EVERY = 10000;
+
+    std::string snapshotPath() const { return directory + "/snapshot.bin"; }
+    std::string logPath() const { return directory + "/wal.log"; }
+
+    void apply(LogRecordType type, BinaryReader& in) {
+        switch (type) {
+            case LogRecordType::AddUser: {
+                char kind = static_cast<char>(in.u8());
+                std::string uname = in.str();
+                std::string pwd = in.str();
+                std::string name = in.str();
+                std::string detail1 = in.str();
+                std::string detail2 = in.str();
+                net.addUser(makeUser(kind, uname, pwd, name, detail1, detail2));
+                break;
+            }
+            case LogRecordType::CreatePost: {
+                UserId author = in.u32();
+                std::string content = in.str();
+                int64_t timestamp = in.remaining() >= 8 ? static_cast<int64_t>(in.u64()) : Network::currentTime();
+                net.addPost(author, content, timestamp);
+                break;
+            }
+            case LogRecordType::SendRequest: {
+                UserId from = in.u32();
+                UserId to = in.u32();
+                // Logs written before requests expired have no timestamp
+                int64_t sentAt = in.remaining() >= 8 ? static_cast<int64_t>(in.u64()) : Network::currentTime();
+                net.requestConnection(from, to, sentAt);
+                break;
+            }
+            case LogRecordType::AcceptRequest: {
+                UserId recipient = in.u32();
+                net.acceptConnection(recipient, in.u32());
+                break;
+            }
+            case LogRecordType::ExpireRequest: {
+                UserId from = in.u32();
+                net.expireRequest(from, in.u32());
+                break;
+            }
+            case LogRecordType::LikePost: {
+                UserId user = in.u32();
+                net.addLike(user, in.u64());
+                break;
+            }
+            case LogRecordType::UnlikePost: {
+                UserId user = in.u32();
+                net.removeLike(user, in.u64());
+                break;
+            }
+        }
+    }
+
+    // Likes are logged while their LikeSet shard lock is held, and requests
+    // and their expiry while their RequestStore shard locks are; a
+    // checkpoint takes all of those locks, so none of these records starts
+    // one: the next other mutation does, and those never run alongside them.
+    //
+    // Returns false if the record cannot be logged or the checkpoint it
+    // started failed; either is reported once on stderr until it clears.
+    bool log(LogRecordType type, const BinaryWriter& payload) {
+        std::lock_guard<std::mutex> lock(logLock);
+        uint64_t lsn = wal.append(type, payload);
+        bool good = lsn != 0;
+        if (good) lastLsn = lsn;
+        report(logFailed, good, "Cannot write log; changes since the last snapshot may be lost.");
+
+        bool concurrent = type == LogRecordType::LikePost || type == LogRecordType::UnlikePost ||
+                          type == LogRecordType::SendRequest || type == LogRecordType::ExpireRequest;
+        if (++sinceSnapshot >= SNAPSHOT_EVERY && !concurrent) {
+            // A failed checkpoint waits for another SNAPSHOT_EVERY records
+            // rather than being retried on every one
+            bool saved = writeCheckpoint();
+            sinceSnapshot = 0;
+            report(checkpointFailed, saved, "Cannot write snapshot; the log keeps growing until one succeeds.");
+            if (saved) logFailed = false; // The snapshot holds what the log lost
+            good = good && saved;
+        }
+        return good;
+    }
+
+    void report(bool& failing, bool good, const char* message) {
+        if (!good && !failing) std::cerr << directory << ": " << message << "\n";
+        failing = !good;
+    }
+
+    // Callers hold logLock, and no likes or requests may be running.
+    bool writeCheckpoint() {
+        // The snapshot names segment files by size, so they go to disk first
+        if (!net.syncPostSegments()) return false;
+
+        std::string tmp = snapshotPath() + ".tmp";
+        int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        FileWriter out(fd);
+        bool good = net.writeSnapshot(out, lastLsn) && out.flush() && ::fsync(fd) == 0;
+        ::close(fd);
+        if (!good || std::rename(tmp.c_str(), snapshotPath().c_str()) != 0) {
+            return false;
+        }
+
+        // Make the rename itself durable before dropping the log
+        int dirFd = ::open(directory.c_str(), O_RDONLY);
+        if (dirFd >= 0) {
+            ::fsync(dirFd);
+            ::close(dirFd);
+        }
+        sinceSnapshot = 0;
+        return wal.truncate();
+    }
+
+public:
+    Storage(Network& network, const std::string& dir) : net(network), directory(dir) {}
+
+    ~Storage() {
+        if (wal.isOpen()) {
+            net.setObserver(nullptr);
+            wal.close();
+        }
+    }
+
+    // Loads the latest snapshot, replays the log tail and starts logging.
+    // Must be called on an empty Network. Returns false if the data directory
+    // is unusable; the Network then stays purely in memory.
+    bool open() {
+        auto start = std::chrono::steady_clock::now();
+        if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+            std::cerr << "Cannot create data directory " << directory << ".\n";
+            return false;
+        }
+
+        uint64_t snapshotLsn = 0;
+        int snapshotFd = ::open(snapshotPath().c_str(), O_RDONLY);
+        if (snapshotFd >= 0) {
+            struct stat st;
+            bool empty = ::fstat(snapshotFd, &st) == 0 && st.st_size == 0;
+            bool good = empty || net.readSnapshot(snapshotFd, snapshotLsn, directory);
+            ::close(snapshotFd);
+            if (!good) {
+                std::cerr << "Snapshot " << snapshotPath() << " is corrupt.\n";
+                return false;
+            }
+        }
+        size_t loadedPosts = net.postCount();
+        lastLsn = snapshotLsn;
+
+        // Records at or below the snapshot's lsn are already part of it
+        size_t replayed = 0;
+        WriteAheadLog::replay(logPath(), [&](uint64_t lsn, LogRecordType type, BinaryReader& in) {
+            if (lsn <= snapshotLsn) return;
+            apply(type, in);
+            lastLsn = lsn;
+            replayed++;
+        });
+
+        if (!wal.open(logPath(), lastLsn + 1)) {
+            std::cerr << "Cannot open log " << logPath() << ".\n";
+            return false;
+        }
+        sinceSnapshot = replayed;
+        net.setObserver(this);
+
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        std::cout << "Restored " << net.userCount() << " users and " << net.postCount() << " posts ("
+                  << loadedPosts << " from snapshot, " << replayed << " log records replayed) in "
+                  << elapsed.count() << " ms.\n";
+        return true;
+    }
+
+
+    // Writes a snapshot of the current state and truncates the log. Must not
+    // run alongside likes or requests.
+    bool checkpoint() {
+        std::lock_guard<std::mutex> lock(logLock);
+        return writeCheckpoint();
+    }
+
+    // Blocks until every logged mutation is on disk. Returns false if some
+    // of them are not, and will not be until the next checkpoint.
+    bool sync() {
+        return wal.sync();
+    }
+
+    // --- NetworkObserver ---
+
+    void userAdded(const User& user) override {
+        BinaryWriter out;
+        out.u8(static_cast<uint8_t>(user.getTypeCode()));
+        out.str(user.getUsername());
+        out.str(user.getPassword());
+        out.str(user.getFullName());
+        out.str(user.getDetail1());
+        out.str(user.getDetail2());
+        log(LogRecordType::AddUser, out);
+    }
+
+    void postCreated(UserId author, const std::string& content, int64_t timestamp) override {
+        BinaryWriter out;
+        out.u32(author);
+        out.str(content);
+        out.u64(static_cast<uint64_t>(timestamp));
+        log(LogRecordType::CreatePost, out);
+    }
+
+    void requestSent(UserId from, UserId to, int64_t sentAt) override {
+        BinaryWriter out;
+        out.u32(from);
+        out.u32(to);
+        out.u64(static_cast<uint64_t>(sentAt));
+        log(LogRecordType::SendRequest, out);
+    }
+
+    void requestAccepted(UserId recipient, UserId sender) override {
+        BinaryWriter out;
+        out.u32(recipient);
+        out.u32(sender);
+        log(LogRecordType::AcceptRequest, out);
+    }
+
+    void requestExpired(UserId from, UserId to) override {
+        BinaryWriter out;
+        out.u32(from);
+        out.u32(to);
+        log(LogRecordType::ExpireRequest, out);
+    }
+
+    void postLiked(UserId user, size_t post) override {
+        BinaryWriter out;
+        out.u32(user);
+        out.u64(post);
+        log(LogRecordType::LikePost, out);
+    }
+
+    void postUnliked(UserId user, size_t post) override {
+        BinaryWriter out;
+        out.u32(user);
+        out.u64(post);
+        log(LogRecordType::UnlikePost, out);
+    }
+};
+
+#endif // STORAGE_HPP
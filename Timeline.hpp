@@ -0,0 +1,76 @@
+#ifndef TIMELINE_HPP
+#define TIMELINE_HPP
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+
+// A bounded ring of post references (indices into Network's post list).
+// Entries are kept in ascending order, oldest first; once the ring is full
+// the oldest entry is overwritten by each new push.
+class Timeline {
+private:
+    std::vector<size_t> ring;
+    size_t head = 0;  // Position of the oldest entry
+    size_t count = 0;
+
+public:
+    explicit Timeline(size_t capacity = 0) : ring(capacity) {}
+
+    size_t size() const { return count; }
+    size_t capacity() const { return ring.size(); }
+
+    // i = 0 is the oldest entry still held.
+    size_t at(size_t i) const {
+        return ring[(head + i) % ring.size()];
+    }
+
+    // As at(), so FeedMerge can page through a timeline.
+    size_t operator[](size_t i) const { return at(i); }
+
+    // Appends a reference that is newer than everything already held.
+    void push(size_t postIndex) {
+        if (ring.empty()) return;
+        if (count < ring.size()) {
+            ring[(head + count) % ring.size()] = postIndex;
+            count++;
+        } else {
+            ring[head] = postIndex;
+            head = (head + 1) % ring.size();
+        }
+    }
+
+    // Copies the newest `n` references held out, oldest first.
+    std::vector<size_t> newest(size_t n) const {
+        size_t skip = count > n ? count - n : 0;
+        std::vector<size_t> out;
+        out.reserve(count - skip);
+        for (size_t i = skip; i < count; i++) {
+            out.push_back(at(i));
+        }
+        return out;
+    }
+
+    // Copies the held references out, oldest first.
+    std::vector<size_t> toVector() const { return newest(count); }
+
+    // Merges an ascending list of references (e.g. a new connection's recent
+    // posts) into the ring, dropping duplicates and keeping only the newest.
+    void merge(const std::vector<size_t>& refs) {
+        if (refs.empty()) return;
+        std::vector<size_t> current = toVector();
+        std::vector<size_t> merged;
+        merged.reserve(current.size() + refs.size());
+        std::set_union(current.begin(), current.end(), refs.begin(), refs.end(), std::back_inserter(merged));
+
+        size_t skip = merged.size() > ring.size() ? merged.size() - ring.size() : 0;
+        head = 0;
+        count = 0;
+        for (size_t i = skip; i < merged.size(); i++) {
+            push(merged[i]);
+        }
+    }
+};
+
+#endif // TIMELINE_HPP
@@ -0,0 +1,58 @@
+#ifndef TOP_K_HPP
+#define TOP_K_HPP
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <cmath>
+#include <cstdint>
+
+// Keeps the K highest-scoring items offered so far, in a min-heap of size K,
+// so picking the best K of n costs O(n log K) and O(K) memory.
+template <typename T>
+class TopK {
+private:
+    using Entry = std::pair<double, T>;
+
+    size_t k;
+    std::vector<Entry> heap; // Min-heap on score: the weakest kept item is on top
+
+public:
+    explicit TopK(size_t limit) : k(limit) {
+        heap.reserve(limit);
+    }
+
+    void offer(double score, const T& item) {
+        if (k == 0) return;
+        if (heap.size() < k) {
+            heap.emplace_back(score, item);
+            std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        } else if (score > heap.front().first) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+            heap.back() = Entry(score, item);
+            std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        }
+    }
+
+    bool full() const { return k > 0 && heap.size() == k; }
+
+    // Score of the weakest kept item; an offer must beat it once full().
+    double weakest() const { return heap.front().first; }
+
+    // The kept items, best first.
+    std::vector<Entry> sorted() const {
+        std::vector<Entry> result = heap;
+        std::sort(result.begin(), result.end(), std::greater<Entry>());
+        return result;
+    }
+};
+
+// Ranks a post by likes, decayed with age so fresh posts can outrank old ones
+// with more likes: (likes + 1) / (hours + 2)^1.5.
+inline double engagementScore(int likes, int64_t ageSeconds) {
+    double hours = ageSeconds > 0 ? ageSeconds / 3600.0 : 0.0;
+    return (likes + 1) / std::pow(hours + 2.0, 1.5);
+}
+
+#endif // TOP_K_HPP
@@ -0,0 +1,249 @@
+#ifndef TRENDING_TAGS_HPP
+#define TRENDING_TAGS_HPP
+
+#include "TopK.hpp"
+#include <vector>
+#include <array>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// Approximate hashtag counts over a sliding window of recent posts, in fixed
+// memory however many posts or distinct tags there are.
+//
+// The window is cut into SLICES time slices, each a count-min sketch of
+// DEPTH rows by WIDTH counters, plus a running total of the live slices. A
+// tag's count is the smallest of its DEPTH total counters: never too low,
+// and too high by at most about e / WIDTH of the tags in the window with
+// probability 1 - e^-DEPTH. When time moves past a slice, the slice is
+// subtracted from the total and reused. A cell keeps its counter in every
+// slice and the total on one cache line, so counting a tag touches DEPTH
+// lines.
+//
+// The heaviest tags are kept in a table of CANDIDATES entries along with
+// their text. A tag outside the table takes the place of the entry with the
+// lowest count once its own count beats it.
+class TrendingTags {
+public:
+    static constexpr size_t DEPTH = 4;
+    static constexpr size_t WIDTH = 2048; // A power of two
+    static constexpr size_t SLICES = 12;
+    static constexpr size_t CANDIDATES = 64;
+    static constexpr size_t MAX_TAG = 32;         // Longer tags are cut to this many bytes
+    static constexpr size_t MAX_TAGS_PER_POST = 16; // Further tags in one post are ignored
+
+private:
+    struct alignas(64) Cell {
+        uint32_t slices[SLICES]; // Slot = slice % SLICES
+        uint32_t total;
+    };
+
+    struct Candidate {
+        uint32_t count;
+        uint8_t length;
+        char tag[MAX_TAG];
+    };
+
+    int64_t sliceSeconds;
+    int64_t current = -1;                 // Newest slice, counted in sliceSeconds since the epoch
+    std::array<int64_t, SLICES> sliceIds; // The slice each ring slot holds, or -1
+    std::vector<Cell> cells;              // Row-major, DEPTH rows of WIDTH
+    std::array<uint64_t, CANDIDATES> candidateHashes; // Apart from the rest, for a quick scan
+    std::array<Candidate, CANDIDATES> candidates;
+    size_t candidateCount = 0;
+    size_t weakest = 0; // The candidate with the lowest count, once the table is full
+
+    static bool isTagByte(unsigned char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c >= 0x80;
+    }
+
+    // FNV-1a, then a 64-bit finaliser so both halves are well mixed
+    static uint64_t hashOf(std::string_view tag) {
+        uint64_t h = 0xcbf29ce484222325ull;
+        for (char c : tag) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 0x100000001b3ull;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // Row r's counter for a hash, by double hashing
+    static size_t cell(uint64_t hash, size_t row) {
+        uint32_t h1 = static_cast<uint32_t>(hash);
+        uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+        return row * WIDTH + ((h1 + row * h2) & (WIDTH - 1));
+    }
+
+    static size_t slotOf(int64_t slice) { return static_cast<size_t>(slice % static_cast<int64_t>(SLICES)); }
+
+    // Makes `slice` the newest, retiring the slices that fall out of the window.
+    void advanceTo(int64_t slice) {
+        if (slice <= current) return;
+        for (int64_t s = std::max(current + 1, slice - static_cast<int64_t>(SLICES) + 1); s <= slice; s++) {
+            size_t slot = slotOf(s);
+            if (sliceIds[slot] >= 0) {
+                for (Cell& c : cells) {
+                    c.total -= c.slices[slot];
+                    c.slices[slot] = 0;
+                }
+            }
+            sliceIds[slot] = s;
+        }
+        current = slice;
+
+        size_t kept = 0;
+        for (size_t i = 0; i < candidateCount; i++) {
+            candidates[i].count = countOf(candidateHashes[i]);
+            if (candidates[i].count == 0) continue;
+            candidateHashes[kept] = candidateHashes[i];
+            candidates[kept++] = candidates[i];
+        }
+        candidateCount = kept;
+        findWeakest();
+    }
+
+    void findWeakest() {
+        weakest = 0;
+        for (size_t i = 1; i < candidateCount; i++) {
+            if (candidates[i].count < candidates[weakest].count) weakest = i;
+        }
+    }
+
+    uint32_t countOf(uint64_t hash) const {
+        uint32_t count = UINT32_MAX;
+        for (size_t r = 0; r < DEPTH; r++) count = std::min(count, cells[cell(hash, r)].total);
+        return count;
+    }
+
+    // Counts only grow between rotations, so the weakest candidate changes
+    // only when it is the one counted or replaced.
+    void offer(uint64_t hash, std::string_view tag, uint32_t count) {
+        size_t i = static_cast<size_t>(std::find(candidateHashes.begin(), candidateHashes.begin() + candidateCount, hash) -
+                                       candidateHashes.begin());
+        if (i < candidateCount) {
+            candidates[i].count = count;
+            if (i == weakest) findWeakest();
+            return;
+        }
+        if (candidateCount < CANDIDATES) {
+            i = candidateCount++;
+        } else if (count > candidates[weakest].count) {
+            i = weakest;
+        } else {
+            return;
+        }
+        candidateHashes[i] = hash;
+        Candidate& c = candidates[i];
+        c.count = count;
+        c.length = static_cast<uint8_t>(tag.size());
+        std::memcpy(c.tag, tag.data(), tag.size());
+        if (candidateCount == CANDIDATES) findWeakest();
+    }
+
+public:
+    // Counts cover the last `windowSeconds`, to within one slice.
+    explicit TrendingTags(int64_t windowSeconds = 3600)
+        : sliceSeconds(std::max<int64_t>(1, windowSeconds / static_cast<int64_t>(SLICES))),
+          cells(DEPTH * WIDTH, Cell{}) {
+        sliceIds.fill(-1);
+    }
+
+    int64_t windowSeconds() const { return sliceSeconds * static_cast<int64_t>(SLICES); }
+
+    // Calls fn(std::string_view) for each hashtag in `text`: a '#' followed
+    // by letters, digits, '_' or non-ASCII bytes, lowercased, without the '#'.
+    template <typename Fn>
+    static void forEachHashtag(std::string_view text, Fn fn) {
+        char tag[MAX_TAG];
+        for (size_t i = text.find('#'); i != std::string_view::npos; i = text.find('#', i + 1)) {
+            size_t length = 0;
+            for (; i + 1 < text.size() && isTagByte(static_cast<unsigned char>(text[i + 1])); i++) {
+                char c = text[i + 1];
+                if (length < MAX_TAG) tag[length++] = c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+            }
+            if (length > 0) fn(std::string_view(tag, length));
+        }
+    }
+
+    // Counts each distinct hashtag of a post made at `timestamp` (seconds).
+    // Posts older than the window are ignored.
+    void addPost(std::string_view content, int64_t timestamp) {
+        int64_t slice = std::max<int64_t>(timestamp, 0) / sliceSeconds;
+        if (slice + static_cast<int64_t>(SLICES) <= current) return;
+        bool advanced = false;
+
+        uint64_t seen[MAX_TAGS_PER_POST];
+        size_t seenCount = 0;
+        forEachHashtag(content, [&](std::string_view tag) {
+            uint64_t hash = hashOf(tag);
+            if (seenCount == MAX_TAGS_PER_POST || std::find(seen, seen + seenCount, hash) != seen + seenCount) return;
+            seen[seenCount++] = hash;
+            if (!advanced) {
+                advanceTo(slice);
+                advanced = true;
+            }
+
+            size_t slot = slotOf(slice);
+            uint32_t count = UINT32_MAX;
+            for (size_t r = 0; r < DEPTH; r++) {
+                Cell& c = cells[cell(hash, r)];
+                c.slices[slot]++;
+                count = std::min(count, ++c.total);
+            }
+            offer(hash, tag, count);
+        });
+    }
+
+    // About how many posts in the window ending at `now` had `tag` (given
+    // without the '#', lowercased).
+    uint32_t count(std::string_view tag, int64_t now) const {
+        return countAt(hashOf(tag), now);
+    }
+
+private:
+    // The total, less any slices that have left the window by `now`
+    uint32_t countAt(uint64_t hash, int64_t now) const {
+        int64_t nowSlice = std::max(std::max<int64_t>(now, 0) / sliceSeconds, current);
+        uint32_t count = UINT32_MAX;
+        for (size_t r = 0; r < DEPTH; r++) {
+            const Cell& c = cells[cell(hash, r)];
+            uint32_t value = c.total;
+            for (size_t slot = 0; slot < SLICES; slot++) {
+                if (sliceIds[slot] >= 0 && sliceIds[slot] + static_cast<int64_t>(SLICES) <= nowSlice) {
+                    value -= c.slices[slot];
+                }
+            }
+            count = std::min(count, value);
+        }
+        return count;
+    }
+
+public:
+    // Up to `k` tags with the most posts in the window ending at `now`, most
+    // first, with their approximate counts.
+    std::vector<std::pair<std::string, uint32_t>> top(size_t k, int64_t now) const {
+        TopK<size_t> best(k);
+        for (size_t i = 0; i < candidateCount; i++) {
+            uint32_t n = countAt(candidateHashes[i], now);
+            if (n > 0) best.offer(n, i);
+        }
+        std::vector<std::pair<std::string, uint32_t>> result;
+        for (const auto& entry : best.sorted()) {
+            const Candidate& c = candidates[entry.second];
+            result.emplace_back(std::string(c.tag, c.length), static_cast<uint32_t>(entry.first));
+        }
+        return result;
+    }
+
+    size_t memoryBytes() const {
+        return cells.capacity() * sizeof(Cell) + sizeof(candidateHashes) + sizeof(candidates);
+    }
+};
+
+#endif // TRENDING_TAGS_HPP
@@ -1,112 +1,107 @@
-#ifndef USER_HPP
-#define USER_HPP
-
-#include <iostream>
-#include <string>
-#include <vector>
-#include <algorithm>
-#include <memory>
-
-class Post {
-private:
-    std::string authorUsername;
-    std::string content;
-    int likes;
-
-public:
-    Post(const std::string& author, const std::string& text)
-        : authorUsername(author), content(text), likes(0) {}
-
-    void display() const {
-        std::cout << "    \"" << content << "\"\n";
-        std::cout << "    - " << authorUsername << " | Likes: " << likes << std::endl;
-    }
-
-    void likePost() {
-        likes++;
-    }
-
-    std::string getAuthor() const {
-        return authorUsername;
-    }
-};
-
-// Base class for all users - demonstrates Abstraction
-class User {
-protected:
-    std::string username;
-    std::string password;
-    std::string fullName;
-    std::vector<std::string> connections; // Store usernames of connections
-
-public:
-    User(const std::string& uname, const std::string& pwd, const std::string& name)
-        : username(uname), password(pwd), fullName(name) {}
-
-    // Virtual destructor for base class
-    virtual ~User() = default;
-
-    // Pure virtual function - makes User an abstract class and enforces polymorphism
-    virtual void displayProfile() const = 0;
-
-    std::string getUsername() const { return username; } //:: scope resolution operator
-    std::string getFullName() const { return fullName; }
-
-    bool checkPassword(const std::string& pwd) const {
-        return password == pwd;
-    }
-
-    void addConnection(const std::string& connUsername) {
-        connections.push_back(connUsername);
-    }
-
-    const std::vector<std::string>& getConnections() const {
-        return connections;
-    }
-
-    bool isConnectedTo(const std::string& otherUsername) const {
-        return std::find(connections.begin(), connections.end(), otherUsername) != connections.end();
-    }
-};
-
-// Derived class for Students
-class Student : public User {
-private:
-    std::string university;
-    std::string major;
-
-public:
-    Student(const std::string& uname, const std::string& pwd, const std::string& name, const std::string& uni, const std::string& maj)
-        : User(uname, pwd, name), university(uni), major(maj) {}
-
-    void displayProfile() const override {
-        std::cout << "\n--- Student Profile ---\n";
-        std::cout << "Name: " << fullName << " (@" << username << ")\n";
-        std::cout << "University: " << university << "\n";
-        std::cout << "Major: " << major << "\n";
-        std::cout << "Connections: " << connections.size() << "\n";
-        std::cout << "-----------------------\n";
-    }
-};
-
-// Derived class for Professionals
-class Professional : public User {
-private:
-    std::string company;
-    std::string jobTitle;
-
-public:
-    Professional(const std::string& uname, const std::string& pwd, const std::string& name, const std::string& comp, const std::string& title)
-        : User(uname, pwd, name), company(comp), jobTitle(title) {}
-
-    void displayProfile() const override {
-        std::cout << "\n--- Professional Profile ---\n";
-        std::cout << "Name: " << fullName << " (@" << username << ")\n";
-        std::cout << "Company: " << company << "\n";
-        std::cout << "Title: " << jobTitle << "\n";
-        std::cout << "Connections: " << connections.size() << "\n";
-        std::cout << "--------------------------\n";
-    }
-};
-
+#ifndef USER_HPP
+#define USER_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include "UsernameTable.hpp"
+#include "Render.hpp"
+
+// Base class for all users - demonstrates Abstraction
+class User {
+protected:
+    UserId id = NO_USER; // Assigned by Network::addUser
+    std::string username;
+    std::string password;
+    std::string fullName;
+    size_t connectionCount = 0; // The connection graph itself is owned by Network
+
+public:
+    User(const std::string& uname, const std::string& pwd, const std::string& name)
+        : username(uname), password(pwd), fullName(name) {}
+
+    // Virtual destructor for base class
+    virtual ~User() = default;
+
+    // Pure virtual function - makes User an abstract class and enforces polymorphism
+    virtual void displayProfile(std::ostream& out = std::cout) const = 0;
+
+    // Registration type ('1' = Student, '2' = Professional) and the two
+    // type-specific fields, so the user can be persisted and rebuilt by makeUser
+    virtual char getTypeCode() const = 0;
+    virtual const std::string& getDetail1() const = 0;
+    virtual const std::string& getDetail2() const = 0;
+
+    UserId getId() const { return id; }
+    void setId(UserId newId) { id = newId; }
+
+    const std::string& getUsername() const { return username; } //:: scope resolution operator
+    const std::string& getFullName() const { return fullName; }
+
+    bool checkPassword(const std::string& pwd) const {
+        return password == pwd;
+    }
+
+    const std::string& getPassword() const { return password; }
+
+    void setConnectionCount(size_t count) {
+        connectionCount = count;
+    }
+
+    size_t getConnectionCount() const {
+        return connectionCount;
+    }
+};
+
+// Derived class for Students
+class Student : public User {
+private:
+    std::string university;
+    std::string major;
+
+public:
+    Student(const std::string& uname, const std::string& pwd, const std::string& name, const std::string& uni, const std::string& maj)
+        : User(uname, pwd, name), university(uni), major(maj) {}
+
+    void displayProfile(std::ostream& out = std::cout) const override {
+        Renderer(out).profile("Student", username, fullName, "University", university, "Major", major, connectionCount);
+    }
+
+    char getTypeCode() const override { return '1'; }
+    const std::string& getDetail1() const override { return university; }
+    const std::string& getDetail2() const override { return major; }
+};
+
+// Derived class for Professionals
+class Professional : public User {
+private:
+    std::string company;
+    std::string jobTitle;
+
+public:
+    Professional(const std::string& uname, const std::string& pwd, const std::string& name, const std::string& comp, const std::string& title)
+        : User(uname, pwd, name), company(comp), jobTitle(title) {}
+
+    void displayProfile(std::ostream& out = std::cout) const override {
+        Renderer(out).profile("Professional", username, fullName, "Company", company, "Title", jobTitle, connectionCount);
+    }
+
+    char getTypeCode() const override { return '2'; }
+    const std::string& getDetail1() const override { return company; }
+    const std::string& getDetail2() const override { return jobTitle; }
+};
+
+// Rebuilds a user from its type code and fields; returns nullptr for an unknown type.
+inline std::unique_ptr<User> makeUser(char type, const std::string& uname, const std::string& pwd, const std::string& name,
+                                      const std::string& detail1, const std::string& detail2) {
+    if (type == '1') {
+        return std::make_unique<Student>(uname, pwd, name, detail1, detail2);
+    } else if (type == '2') {
+        return std::make_unique<Professional>(uname, pwd, name, detail1, detail2);
+    }
+    return nullptr;
+}
+
 #endif // USER_HPP
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef USERNAME_TABLE_HPP
+#define USERNAME_TABLE_HPP
+
+#include "AppendOnlyList.hpp"
+#include <string>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <cstdint>
+
+// Dense 32-bit user id. Ids are handed out sequentially by addUser and every
+// internal structure (graph, posts, requests) is keyed by them.
+using UserId = uint32_t;
+constexpr UserId NO_USER = 0xFFFFFFFFu;
+
+// Interns each username exactly once. Strings are only looked up at the edges
+// (login, menu input) and materialised again for display.
+//
+// Names are split over SHARDS maps by hash, each behind its own
+// reader/writer lock, so lookups run in parallel with each other and with
+// interning names in other shards. Ids map back to names through an
+// AppendOnlyList, which nameOf reads without a lock.
+class UsernameTable {
+private:
+    static constexpr size_t SHARDS = 16;
+
+    struct Shard {
+        mutable std::shared_mutex lock;
+        std::unordered_map<std::string, UserId> ids;
+    };
+
+    Shard shards[SHARDS];
+    AppendOnlyList<const std::string*> names; // Points at the keys stored in the shards
+
+    Shard& shardOf(const std::string& name) { return shards[std::hash<std::string>()(name) % SHARDS]; }
+    const Shard& shardOf(const std::string& name) const {
+        return shards[std::hash<std::string>()(name) % SHARDS];
+    }
+
+public:
+    size_t size() const { return names.size(); }
+
+    void reserve(size_t n) {
+        for (Shard& shard : shards) {
+            std::unique_lock<std::shared_mutex> held(shard.lock);
+            shard.ids.reserve(n / SHARDS + 1);
+        }
+    }
+
+    UserId find(const std::string& name) const {
+        const Shard& shard = shardOf(name);
+        std::shared_lock<std::shared_mutex> held(shard.lock);
+        auto it = shard.ids.find(name);
+        return it != shard.ids.end() ? it->second : NO_USER;
+    }
+
+    // Returns the existing id if the name is already interned.
+    UserId intern(const std::string& name) {
+        Shard& shard = shardOf(name);
+        std::unique_lock<std::shared_mutex> held(shard.lock);
+        auto result = shard.ids.emplace(name, NO_USER);
+        if (result.second) {
+            result.first->second = static_cast<UserId>(names.emplace_back(&result.first->first));
+        }
+        return result.first->second;
+    }
+
+    const std::string& nameOf(UserId id) const { return *names[id]; }
+};
+
+#endif // USERNAME_TABLE_HPP
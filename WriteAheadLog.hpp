@@ -0,0 +1,229 @@
+#ifndef WRITE_AHEAD_LOG_HPP
+#define WRITE_AHEAD_LOG_HPP
+
+#include "BinaryIO.hpp"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+enum class LogRecordType : uint8_t {
+    AddUser = 1,
+    CreatePost = 2,
+    SendRequest = 3,
+    AcceptRequest = 4,
+    ExpireRequest = 5,
+    LikePost = 6,
+    UnlikePost = 7
+};
+
+// Append-only binary log of Network mutations.
+//
+// Each record is framed as [u32 length][u32 crc32][u8 type][u64 lsn][payload],
+// where length and crc cover everything after the crc. Appends are buffered in
+// memory and a background thread writes and fdatasyncs them as a group, once
+// GROUP_SIZE records are pending or GROUP_WINDOW has passed, so a burst of
+// writes shares one fsync.
+//
+// append() returns before its record is on disk: a record is durable only
+// once sync() has returned true, and a crash loses whatever was appended in
+// the last GROUP_WINDOW without a sync. Callers that acknowledge a change to
+// someone else must sync() first.
+//
+// A failed write or fdatasync is sticky: nothing more is written (records
+// after a torn one could never be replayed), append() and sync() report the
+// failure, and only a successful truncate() clears it.
+class WriteAheadLog {
+private:
+    int fd = -1;
+    std::string pending;
+    size_t pendingRecords = 0;
+    uint64_t nextLsn = 1;
+    bool stopping = false;
+
+    std::mutex mutex;
+    std::condition_variable wake;     // Flusher waits for work
+    std::condition_variable flushed;  // sync() waits for the flusher
+    std::thread flusher;
+    uint64_t writtenLsn = 0;          // Highest lsn known to be on disk
+    bool failed = false;              // A write or fdatasync failed
+    size_t waiters = 0;               // Threads blocked in sync()
+
+    static constexpr size_t GROUP_SIZE = 64;
+    static constexpr std::chrono::milliseconds GROUP_WINDOW{5};
+
+    // Takes the pending batch and writes it out; called with the lock held.
+    void writeBatch(std::unique_lock<std::mutex>& lock) {
+        std::string batch;
+        batch.swap(pending);
+        pendingRecords = 0;
+        uint64_t batchLsn = nextLsn - 1;
+
+        if (failed) {
+            flushed.notify_all();
+            return;
+        }
+
+        lock.unlock();
+        bool good = writeAll(fd, batch.data(), batch.size()) && ::fdatasync(fd) == 0;
+        lock.lock();
+
+        if (good) {
+            writtenLsn = batchLsn;
+        } else {
+            failed = true;
+        }
+        flushed.notify_all();
+    }
+
+    void flushLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&] { return stopping || pendingRecords > 0; });
+            if (pendingRecords == 0 && stopping) break;
+            // Give the rest of the group a moment to arrive, unless someone
+            // is waiting: then whatever arrives during this fsync forms the
+            // next group
+            wake.wait_for(lock, GROUP_WINDOW, [&] { return stopping || waiters > 0 || pendingRecords >= GROUP_SIZE; });
+            writeBatch(lock);
+        }
+    }
+
+public:
+    WriteAheadLog() = default;
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    ~WriteAheadLog() {
+        close();
+    }
+
+    // Opens (or creates) the log for appending. Records are numbered from firstLsn.
+    bool open(const std::string& path, uint64_t firstLsn) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) return false;
+        nextLsn = firstLsn;
+        writtenLsn = firstLsn - 1;
+        stopping = false;
+        flusher = std::thread(&WriteAheadLog::flushLoop, this);
+        return true;
+    }
+
+    bool isOpen() const { return fd >= 0; }
+
+    // Queues a record and returns its lsn, or 0 if the log has failed.
+    uint64_t append(LogRecordType type, const BinaryWriter& payload) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failed) return 0;
+        uint64_t lsn = nextLsn++;
+
+        BinaryWriter body;
+        body.u8(static_cast<uint8_t>(type));
+        body.u64(lsn);
+        body.raw(payload.data().data(), payload.size());
+
+        BinaryWriter frame;
+        frame.u32(static_cast<uint32_t>(body.size()));
+        frame.u32(crc32(body.data().data(), body.size()));
+        pending += frame.data();
+        pending += body.data();
+
+        // Wake the flusher to open a group window, or to close it early when full
+        if (++pendingRecords == 1 || pendingRecords >= GROUP_SIZE) {
+            wake.notify_one();
+        }
+        return lsn;
+    }
+
+    // Blocks until every record appended so far is on disk. Returns false if
+    // any of them never will be.
+    bool sync() {
+        std::unique_lock<std::mutex> lock(mutex);
+        uint64_t target = nextLsn - 1;
+        waiters++;
+        wake.notify_one();
+        flushed.wait(lock, [&] { return writtenLsn >= target || failed || fd < 0; });
+        waiters--;
+        return !failed && writtenLsn >= target;
+    }
+
+    bool ok() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !failed;
+    }
+
+    // Discards the log contents once a snapshot covers them. Also recovers
+    // from a failed write, since the snapshot holds what the log lost.
+    bool truncate() {
+        sync();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (::ftruncate(fd, 0) != 0 || ::fsync(fd) != 0) return false;
+        failed = false;
+        writtenLsn = nextLsn - 1;
+        return true;
+    }
+
+    void close() {
+        if (fd < 0) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        flusher.join();
+        ::close(fd);
+        fd = -1;
+    }
+
+    // Calls fn(lsn, type, payload) for every intact record in the file, then
+    // cuts off any torn or corrupted tail. Returns the number of records read.
+    static size_t replay(const std::string& path, const std::function<void(uint64_t, LogRecordType, BinaryReader&)>& fn) {
+        int in = ::open(path.c_str(), O_RDWR);
+        if (in < 0) return 0;
+
+        struct stat st;
+        std::vector<char> bytes;
+        if (::fstat(in, &st) == 0 && st.st_size > 0) {
+            bytes.resize(static_cast<size_t>(st.st_size));
+            size_t got = 0;
+            while (got < bytes.size()) {
+                ssize_t n = ::read(in, bytes.data() + got, bytes.size() - got);
+                if (n <= 0) break;
+                got += static_cast<size_t>(n);
+            }
+            bytes.resize(got);
+        }
+
+        size_t count = 0;
+        size_t offset = 0;
+        while (true) {
+            BinaryReader header(bytes.data() + offset, bytes.size() - offset);
+            uint32_t length = header.u32();
+            uint32_t crc = header.u32();
+            if (!header.ok() || header.remaining() < length || length < 9) break;
+            if (crc32(header.position(), length) != crc) break;
+
+            BinaryReader body(header.position(), length);
+            auto type = static_cast<LogRecordType>(body.u8());
+            uint64_t lsn = body.u64();
+            fn(lsn, type, body);
+            count++;
+            offset += 8 + length;
+        }
+
+        if (offset < bytes.size()) {
+            ::ftruncate(in, static_cast<off_t>(offset));
+        }
+        ::close(in);
+        return count;
+    }
+};
+
+#endif // WRITE_AHEAD_LOG_HPP
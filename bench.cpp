@@ -0,0 +1,1319 @@
+#include "Network.hpp"
+#include "GraphGenerator.hpp"
+#include "LatencySamples.hpp"
+#include "BulkImport.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <utility>
+#include <thread>
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_set>
+#include <unordered_map>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <unistd.h>
+
+// Benchmarks for Network operations on a generated power-law graph.
+// Every result is printed to stdout as one JSON object per line so runs can
+// be compared across changes.
+//
+// Usage: bench [--users N] [--degree D] [--posts P] [--skew S] [--ops N] [--seed N]
+//              [--mode serial|scaling|stress|import] [--threads N]
+//
+//   serial   Latency of each Network operation on one thread (default)
+//   scaling  Network throughput on a mixed workload, 1 to N threads, with
+//            the server's locking: feeds lock-free, writes exclusive
+//   stress   Races Network writers and readers the same way on N threads, then
+//            checks its invariants; exits with 1 if any is violated
+//   import   BulkImporter rows/s from generated CSV and JSON-lines files on N
+//            threads, against adding the same data one item at a time
+
+size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+size_t peakResidentBytes() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::stoul(line.substr(6)) * 1024;
+        }
+    }
+    return 0;
+}
+
+// Builds one flat JSON object.
+class JsonLine {
+private:
+    std::ostringstream out;
+    bool first = true;
+
+    void key(const std::string& k) {
+        out << (first ? "{" : ",") << "\"" << k << "\":";
+        first = false;
+    }
+
+public:
+    JsonLine() {
+        out.precision(12);
+    }
+
+    JsonLine& add(const std::string& k, const std::string& v) {
+        key(k);
+        out << "\"" << v << "\"";
+        return *this;
+    }
+
+    JsonLine& add(const std::string& k, double v) {
+        key(k);
+        out << v;
+        return *this;
+    }
+
+    std::string str() const { return out.str() + "}"; }
+};
+
+struct BenchContext {
+    GeneratorConfig config;
+    size_t ops = 10000;
+    std::string mode = "serial";
+    size_t threads = 0; // 0 = hardware concurrency
+};
+
+JsonLine resultLine(const BenchContext& ctx, const std::string& name) {
+    JsonLine line;
+    line.add("bench", name)
+        .add("users", static_cast<double>(ctx.config.users))
+        .add("avg_degree", ctx.config.averageDegree)
+        .add("posts_per_user", ctx.config.postsPerUser)
+        .add("skew", ctx.config.skew)
+        .add("seed", static_cast<double>(ctx.config.seed));
+    return line;
+}
+
+void report(const BenchContext& ctx, const std::string& name, LatencySamples& samples) {
+    JsonLine line = resultLine(ctx, name);
+    line.add("ops", static_cast<double>(samples.count()))
+        .add("mean_us", samples.mean())
+        .add("p50_us", samples.percentile(0.50))
+        .add("p99_us", samples.percentile(0.99))
+        .add("max_us", samples.max())
+        .add("rss_bytes", static_cast<double>(residentBytes()));
+    std::cout << line.str() << "\n";
+}
+
+// Times fn(i) for i in [0, ops), one sample per call.
+template <typename Fn>
+LatencySamples measure(size_t ops, Fn fn) {
+    LatencySamples samples;
+    for (size_t i = 0; i < ops; i++) {
+        auto start = std::chrono::steady_clock::now();
+        fn(i);
+        samples.add(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    return samples;
+}
+
+// Post `i`'s body, or an empty one if it cannot be read back from disk.
+std::string_view bodyOf(const PostStore& posts, size_t i) {
+    std::string_view body;
+    posts.content(i, body);
+    return body;
+}
+
+// One heap object per post, as posts were stored before PostStore; kept as
+// the baseline for comparePostLayouts.
+struct ObjectPost {
+    UserId author;
+    int likes;
+    std::string content;
+
+    ObjectPost(UserId authorId, const std::string& text, int likeCount) : author(authorId), likes(likeCount), content(text) {}
+};
+
+// Collects the newest FEED_SCAN_LIMIT posts whose author is in `authors` by
+// scanning posts from newest to oldest, and sums their lengths as a stand-in
+// for rendering them.
+const size_t FEED_SCAN_LIMIT = 200;
+
+size_t scanFeed(const std::vector<ObjectPost>& posts, const std::vector<bool>& authors) {
+    size_t found = 0, bytes = 0;
+    for (size_t i = posts.size(); i-- > 0 && found < FEED_SCAN_LIMIT;) {
+        if (authors[posts[i].author]) {
+            found++;
+            bytes += posts[i].content.size();
+        }
+    }
+    return bytes;
+}
+
+size_t scanFeed(const PostStore& posts, const std::vector<bool>& authors, int64_t since) {
+    size_t found = 0, bytes = 0;
+    for (size_t i = posts.size(); i-- > 0 && found < FEED_SCAN_LIMIT;) {
+        if (authors[posts.author(i)] && posts.timestamp(i) >= since) {
+            found++;
+            bytes += bodyOf(posts, i).size();
+        }
+    }
+    return bytes;
+}
+
+// Compares the old one-object-per-post layout with the columnar PostStore:
+// heap bytes per post and the time to scan for one user's feed.
+void comparePostLayouts(const BenchContext& ctx, const Network& net, GraphGenerator& gen) {
+    size_t count = net.postCount();
+    if (count == 0) return;
+    const ConnectionGraph& graph = net.getGraph();
+
+    size_t rssBefore = residentBytes();
+    std::vector<ObjectPost> objects;
+    for (size_t i = 0; i < count; i++) {
+        PostView p = net.getPost(i);
+        objects.emplace_back(p.getAuthor(), std::string(p.getContent()), p.getLikes());
+    }
+    size_t objectRss = residentBytes() - rssBefore;
+    size_t objectHeap = objects.capacity() * sizeof(ObjectPost);
+    for (const ObjectPost& p : objects) {
+        const std::string& text = p.content;
+        bool inline_ = text.data() >= reinterpret_cast<const char*>(&p) &&
+                       text.data() < reinterpret_cast<const char*>(&p + 1); // Short-string optimisation
+        if (!inline_) objectHeap += malloc_usable_size(const_cast<char*>(text.data())) + sizeof(size_t);
+    }
+
+    rssBefore = residentBytes();
+    PostStore columns;
+    for (size_t i = 0; i < count; i++) {
+        PostView p = net.getPost(i);
+        columns.append(p.getAuthor(), p.getTimestamp(), p.getContent(), p.getLikes());
+    }
+    size_t columnRss = residentBytes() - rssBefore;
+
+    size_t scans = std::min<size_t>(ctx.ops, 200);
+    std::vector<std::vector<bool>> readers; // Each reader's own id and connections
+    for (size_t i = 0; i < scans; i++) {
+        UserId id = gen.pickUniform();
+        std::vector<bool> authors(net.userCount(), false);
+        authors[id] = true;
+        graph.forEachNeighbor(id, [&](UserId conn) { authors[conn] = true; });
+        readers.push_back(std::move(authors));
+    }
+
+    size_t checksum = 0;
+    LatencySamples objectScan = measure(scans, [&](size_t i) {
+        checksum += scanFeed(objects, readers[i]);
+    });
+    LatencySamples columnScan = measure(scans, [&](size_t i) {
+        checksum += scanFeed(columns, readers[i], 0);
+    });
+
+    std::cout << resultLine(ctx, "post_layout")
+                     .add("posts", static_cast<double>(count))
+                     .add("object_heap_bytes_per_post", static_cast<double>(objectHeap) / count)
+                     .add("object_rss_bytes_per_post", static_cast<double>(objectRss) / count)
+                     .add("column_heap_bytes_per_post", static_cast<double>(columns.memoryBytes()) / count)
+                     .add("column_rss_bytes_per_post", static_cast<double>(columnRss) / count)
+                     .add("object_scan_p50_us", objectScan.percentile(0.50))
+                     .add("object_scan_p99_us", objectScan.percentile(0.99))
+                     .add("column_scan_p50_us", columnScan.percentile(0.50))
+                     .add("column_scan_p99_us", columnScan.percentile(0.99))
+                     .add("checksum", static_cast<double>(checksum % 1000))
+                     .str()
+              << "\n";
+}
+
+// Mutual counts of the best `k` friends of friends, the straightforward way:
+// a hash map counter bumped once per two-hop path.
+std::vector<size_t> naiveSuggestionScores(const ConnectionGraph& graph, UserId user, size_t k) {
+    std::unordered_map<UserId, size_t> counts;
+    graph.forEachNeighbor(user, [&](UserId f) {
+        graph.forEachNeighbor(f, [&](UserId c) {
+            if (c != user && !graph.connected(user, c)) counts[c]++;
+        });
+    });
+    std::vector<size_t> scores;
+    for (const auto& entry : counts) scores.push_back(entry.second);
+    std::sort(scores.rbegin(), scores.rend());
+    if (scores.size() > k) scores.resize(k);
+    return scores;
+}
+
+// "People you may know" latency for random users and for the best connected
+// ones, against the naive counter, then with a new connection accepted
+// before each query; also checks both rank the same scores.
+void compareSuggestions(const BenchContext& ctx, Network& net, GraphGenerator& gen) {
+    const size_t k = 10;
+    const ConnectionGraph& graph = net.getGraph();
+
+    std::vector<UserId> hubs(net.userCount());
+    for (UserId id = 0; id < hubs.size(); id++) hubs[id] = id;
+    size_t hubCount = std::min<size_t>(hubs.size(), 20);
+    std::partial_sort(hubs.begin(), hubs.begin() + hubCount, hubs.end(), [&](UserId a, UserId b) {
+        return graph.degree(a) > graph.degree(b);
+    });
+    hubs.resize(hubCount);
+
+    size_t mismatches = 0;
+    auto check = [&](UserId id, const std::vector<Suggestion>& got) {
+        std::vector<size_t> expected = naiveSuggestionScores(graph, id, k);
+        bool same = got.size() == expected.size();
+        for (size_t i = 0; same && i < got.size(); i++) same = got[i].mutual == expected[i];
+        if (!same) mismatches++;
+    };
+
+    std::vector<UserId> users;
+    for (size_t i = 0; i < std::min<size_t>(ctx.ops, 1000); i++) users.push_back(gen.pickUniform());
+    LatencySamples uniform = measure(users.size(), [&](size_t i) { net.suggestions(users[i], k); });
+    LatencySamples hub = measure(hubs.size(), [&](size_t i) { net.suggestions(hubs[i], k); });
+    LatencySamples naiveHub = measure(hubs.size(), [&](size_t i) { naiveSuggestionScores(graph, hubs[i], k); });
+    for (size_t i = 0; i < std::min<size_t>(users.size(), 200); i++) check(users[i], net.suggestions(users[i], k));
+    for (UserId id : hubs) check(id, net.suggestions(id, k));
+
+    // Writes between reads: the sorted lists are kept current on each accept
+    LatencySamples accept, interleaved;
+    for (size_t i = 0; i < users.size(); i++) {
+        UserId a = gen.pickUniform(), b = gen.pickUniform();
+        auto start = std::chrono::steady_clock::now();
+        if (net.requestConnection(a, b) == RequestStatus::Sent) net.acceptConnection(b, a);
+        accept.add(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        start = std::chrono::steady_clock::now();
+        net.suggestions(users[i], k);
+        interleaved.add(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    for (size_t i = 0; i < std::min<size_t>(users.size(), 200); i++) check(users[i], net.suggestions(users[i], k));
+
+    std::cout << resultLine(ctx, "suggestions")
+                     .add("uniform_p50_us", uniform.percentile(0.50))
+                     .add("uniform_p99_us", uniform.percentile(0.99))
+                     .add("hub_degree", static_cast<double>(hubs.empty() ? 0 : graph.degree(hubs[0])))
+                     .add("hub_p50_us", hub.percentile(0.50))
+                     .add("hub_max_us", hub.max())
+                     .add("naive_hub_p50_us", naiveHub.percentile(0.50))
+                     .add("naive_hub_max_us", naiveHub.max())
+                     .add("interleaved_p50_us", interleaved.percentile(0.50))
+                     .add("interleaved_p99_us", interleaved.percentile(0.99))
+                     .add("interleaved_accept_p50_us", accept.percentile(0.50))
+                     .add("interleaved_accept_max_us", accept.max())
+                     .add("mismatches", static_cast<double>(mismatches))
+                     .str()
+              << "\n";
+}
+
+// Hops from `from` to `to` by plain one-sided BFS (SIZE_MAX if more than
+// `maxHops`), and how many vertices it reached.
+size_t naiveSeparation(const SortedAdjacency& csr, UserId from, UserId to, size_t maxHops, size_t& visited) {
+    std::vector<uint32_t> dist(csr.vertexCount(), UINT32_MAX);
+    std::vector<UserId> frontier{from}, next;
+    dist[from] = 0;
+    visited = 1;
+    for (size_t depth = 0; depth < maxHops && !frontier.empty() && dist[to] == UINT32_MAX; depth++) {
+        next.clear();
+        for (UserId u : frontier) {
+            for (const uint32_t* v = csr.begin(u); v != csr.end(u); ++v) {
+                if (dist[*v] != UINT32_MAX) continue;
+                dist[*v] = static_cast<uint32_t>(depth + 1);
+                visited++;
+                next.push_back(*v);
+            }
+        }
+        frontier.swap(next);
+    }
+    return dist[to] == UINT32_MAX ? SIZE_MAX : dist[to];
+}
+
+// Degrees of separation between random pairs: latency, share of the graph
+// each search reached, and agreement with a one-sided BFS.
+void compareSeparation(const BenchContext& ctx, const Network& net, GraphGenerator& gen) {
+    const size_t maxHops = 6;
+    const SortedAdjacency& csr = net.getGraph().snapshot();
+    size_t queries = std::min<size_t>(ctx.ops, 2000);
+    std::vector<std::pair<UserId, UserId>> pairs;
+    for (size_t i = 0; i < queries; i++) pairs.emplace_back(gen.pickUniform(), gen.pickUniform());
+
+    std::vector<PathResult> results(queries);
+    LatencySamples bidirectional = measure(queries, [&](size_t i) {
+        results[i] = net.pathBetween(pairs[i].first, pairs[i].second, maxHops);
+    });
+
+    double visitedShare = 0;
+    size_t found = 0, hops = 0, mismatches = 0;
+    for (size_t i = 0; i < queries; i++) {
+        const PathResult& r = results[i];
+        visitedShare += static_cast<double>(r.visited) / net.userCount();
+        if (!r.found) continue;
+        found++;
+        hops += r.hops;
+        bool valid = r.path.front() == pairs[i].first && r.path.back() == pairs[i].second;
+        for (size_t j = 1; valid && j < r.path.size(); j++) valid = csr.contains(r.path[j - 1], r.path[j]);
+        if (!valid) mismatches++;
+    }
+
+    size_t checks = std::min<size_t>(queries, 100);
+    double naiveVisited = 0;
+    LatencySamples oneSided = measure(checks, [&](size_t i) {
+        size_t visited = 0;
+        size_t expected = naiveSeparation(csr, pairs[i].first, pairs[i].second, maxHops, visited);
+        naiveVisited += static_cast<double>(visited) / net.userCount();
+        size_t got = results[i].found ? results[i].hops : SIZE_MAX;
+        if (got != expected) mismatches++;
+    });
+
+    std::cout << resultLine(ctx, "separation")
+                     .add("p50_us", bidirectional.percentile(0.50))
+                     .add("p99_us", bidirectional.percentile(0.99))
+                     .add("found_share", static_cast<double>(found) / queries)
+                     .add("mean_hops", found ? static_cast<double>(hops) / found : 0.0)
+                     .add("mean_visited_share", visitedShare / queries)
+                     .add("one_sided_p50_us", oneSided.percentile(0.50))
+                     .add("one_sided_visited_share", naiveVisited / checks)
+                     .add("mismatches", static_cast<double>(mismatches))
+                     .str()
+              << "\n";
+}
+
+// Post search: index size and build rate, latency for random users, for
+// the best-connected ones and over every post, and agreement with testing
+// every visible post's words directly.
+void comparePostSearch(const BenchContext& ctx, const Network& net, GraphGenerator& gen) {
+    const size_t limit = 20;
+    const ConnectionGraph& graph = net.getGraph();
+    const PostStore& posts = net.getPosts();
+    const std::vector<std::string> queries = {"cloud", "hiring cloud", "cpp OR python", "startup mentor remote",
+                                              "#ai OR leadership growth", "nosuchword"};
+
+    auto buildStart = std::chrono::steady_clock::now();
+    PostIndex rebuilt;
+    for (size_t i = 0; i < posts.size(); i++) rebuilt.add(static_cast<uint32_t>(i), bodyOf(posts, i));
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+    const PostIndex& index = net.getPostIndex();
+
+    std::vector<UserId> hubs(net.userCount());
+    for (UserId id = 0; id < hubs.size(); id++) hubs[id] = id;
+    size_t hubCount = std::min<size_t>(hubs.size(), 20);
+    std::partial_sort(hubs.begin(), hubs.begin() + hubCount, hubs.end(), [&](UserId a, UserId b) {
+        return graph.degree(a) > graph.degree(b);
+    });
+    hubs.resize(hubCount);
+
+    std::vector<UserId> users;
+    for (size_t i = 0; i < std::min<size_t>(ctx.ops, 2000); i++) users.push_back(gen.pickUniform());
+    LatencySamples uniform = measure(users.size(), [&](size_t i) {
+        net.findPosts(users[i], queries[i % queries.size()], limit);
+    });
+    LatencySamples hub = measure(hubs.size() * queries.size(), [&](size_t i) {
+        net.findPosts(hubs[i / queries.size()], queries[i % queries.size()], limit);
+    });
+    size_t everyScanned = 0;
+    LatencySamples every = measure(std::min<size_t>(ctx.ops, 2000), [&](size_t i) {
+        PostQuery parsed = index.parse(queries[i % queries.size()]);
+        parsed.newest(limit, [](uint32_t) { return true; }, everyScanned);
+    });
+
+    // The newest `limit` visible posts whose words satisfy the query, found
+    // by tokenising every visible post
+    auto naive = [&](UserId id, const std::string& query) {
+        std::vector<std::vector<std::string>> groups(1);
+        std::string term;
+        std::istringstream words(query);
+        std::string word;
+        while (words >> word) {
+            if (word == "OR") groups.emplace_back();
+            else if (word != "AND") PostIndex::forEachTerm(word, term, [&](const std::string& t) { groups.back().push_back(t); });
+        }
+        std::vector<size_t> found;
+        FeedCursor cursor;
+        for (size_t post : net.feedPage(id, cursor, SIZE_MAX)) {
+            std::unordered_set<std::string> present;
+            PostIndex::forEachTerm(bodyOf(posts, post), term, [&](const std::string& t) { present.insert(t); });
+            bool match = false;
+            for (const auto& group : groups) {
+                bool all = !group.empty();
+                for (const auto& t : group) all = all && present.count(t);
+                match = match || all;
+            }
+            if (match) found.push_back(post);
+            if (found.size() == limit) break;
+        }
+        return found;
+    };
+    size_t checks = 0, mismatches = 0;
+    for (size_t i = 0; i < std::min<size_t>(users.size(), 100); i++) {
+        checks++;
+        if (net.findPosts(users[i], queries[i % queries.size()], limit) != naive(users[i], queries[i % queries.size()])) mismatches++;
+    }
+    for (size_t i = 0; i < hubs.size(); i++) {
+        checks++;
+        if (net.findPosts(hubs[i], queries[i % queries.size()], limit) != naive(hubs[i], queries[i % queries.size()])) mismatches++;
+    }
+
+    std::cout << resultLine(ctx, "post_search")
+                     .add("posts", static_cast<double>(posts.size()))
+                     .add("terms", static_cast<double>(index.termCount()))
+                     .add("postings", static_cast<double>(index.postingCount()))
+                     .add("index_bytes", static_cast<double>(index.memoryBytes()))
+                     .add("bytes_per_posting", index.postingCount() ? static_cast<double>(index.memoryBytes()) / index.postingCount() : 0.0)
+                     .add("build_ns_per_post", posts.size() ? buildMs * 1e6 / posts.size() : 0.0)
+                     .add("uniform_p50_us", uniform.percentile(0.50))
+                     .add("uniform_p99_us", uniform.percentile(0.99))
+                     .add("hub_degree", static_cast<double>(hubs.empty() ? 0 : graph.degree(hubs[0])))
+                     .add("hub_p50_us", hub.percentile(0.50))
+                     .add("hub_p99_us", hub.percentile(0.99))
+                     .add("all_posts_p50_us", every.percentile(0.50))
+                     .add("all_posts_p99_us", every.percentile(0.99))
+                     .add("checks", static_cast<double>(checks))
+                     .add("mismatches", static_cast<double>(mismatches))
+                     .str()
+              << "\n";
+}
+
+// Mutual-connection counts for pending requests and recent searches: sends
+// requests to mostly popular users, runs searches, then accepts half of the
+// requests so the counts of the rest are updated edge by edge. Reports
+// accept latency, tracked pairs visited per new edge, and lookup cost
+// against intersecting the two neighbour sets, and checks every tracked
+// count against that intersection.
+void compareMutualCounts(const BenchContext& ctx, Network& net, GraphGenerator& gen) {
+    const ConnectionGraph& graph = net.getGraph();
+    std::ostream discard(nullptr);
+    auto intersect = [&](UserId a, UserId b) {
+        if (graph.degree(a) > graph.degree(b)) std::swap(a, b);
+        size_t count = 0;
+        graph.forEachNeighbor(a, [&](UserId n) {
+            if (graph.connected(b, n)) count++;
+        });
+        return count;
+    };
+
+    std::vector<std::pair<UserId, UserId>> pending; // (sender, recipient)
+    for (size_t i = 0; i < ctx.ops; i++) {
+        UserId from = gen.pickUniform();
+        UserId to = gen.pickUser();
+        if (net.requestConnection(from, to) == RequestStatus::Sent) pending.emplace_back(from, to);
+    }
+    const std::vector<std::string> queries = {"ali", "smith", "user1", "an", "ro", "grace lee", "e", "olivia jones"};
+    for (size_t i = 0; i < std::min<size_t>(ctx.ops, 2000); i++) {
+        net.searchUsers(queries[i % queries.size()], 20, discard, gen.pickUniform());
+    }
+
+    std::shuffle(pending.begin(), pending.end(), std::mt19937_64(ctx.config.seed));
+    size_t accepted = pending.size() / 2;
+    uint64_t visitedBefore = Metrics::snapshot().of(Counter::MutualPairsVisited);
+    LatencySamples accept = measure(accepted, [&](size_t i) {
+        net.acceptConnection(pending[i].second, pending[i].first);
+    });
+    uint64_t visited = Metrics::snapshot().of(Counter::MutualPairsVisited) - visitedBefore;
+
+    std::vector<std::pair<UserId, UserId>> open;
+    for (size_t i = accepted; i < pending.size(); i++) {
+        if (net.getRequests().contains(pending[i].first, pending[i].second)) open.push_back(pending[i]);
+    }
+    // Both sums must agree; they also keep the loops from being optimised out
+    size_t trackedSum = 0, naiveSum = 0;
+    auto trackedStart = std::chrono::steady_clock::now();
+    for (const auto& pair : open) trackedSum += net.mutualConnections(pair.first, pair.second);
+    double trackedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - trackedStart).count();
+    auto naiveStart = std::chrono::steady_clock::now();
+    for (const auto& pair : open) naiveSum += intersect(pair.first, pair.second);
+    double naiveNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - naiveStart).count();
+
+    size_t tracked = 0, mismatches = 0;
+    for (const auto& pair : open) {
+        if (!net.getMutualCounts().tracked(pair.first, pair.second)) continue;
+        tracked++;
+        if (net.mutualConnections(pair.first, pair.second) != intersect(pair.first, pair.second)) mismatches++;
+    }
+
+    std::cout << resultLine(ctx, "mutual_counts")
+                     .add("requests", static_cast<double>(pending.size()))
+                     .add("accepted", static_cast<double>(accepted))
+                     .add("tracked_pairs", static_cast<double>(net.getMutualCounts().trackedPairs()))
+                     .add("memory_bytes", static_cast<double>(net.getMutualCounts().memoryBytes()))
+                     .add("accept_p50_us", accept.percentile(0.50))
+                     .add("accept_p99_us", accept.percentile(0.99))
+                     .add("pairs_visited_per_edge", accepted ? static_cast<double>(visited) / accepted : 0.0)
+                     .add("lookup_ns", open.empty() ? 0.0 : trackedNs / open.size())
+                     .add("intersect_ns", open.empty() ? 0.0 : naiveNs / open.size())
+                     .add("checks", static_cast<double>(tracked))
+                     .add("mismatches", static_cast<double>(mismatches + (trackedSum != naiveSum)))
+                     .str()
+              << "\n";
+}
+
+// Ingest cost and accuracy of the trending-hashtag counts. Posts carry two
+// tags drawn from a Zipf-like distribution over TAG_VOCABULARY tags, and
+// arrive at a steady rate over three windows, so slices are retired as they
+// would be in a running server. The sketch's top 10 at the end is checked
+// against exact counts over the same window.
+void compareTrending(const BenchContext& ctx, Network& net, GraphGenerator& gen) {
+    const size_t TAG_VOCABULARY = 100000;
+    const size_t k = 10;
+    const size_t postTotal = std::max<size_t>(ctx.ops * 20, 200000);
+    std::mt19937_64 rng(ctx.config.seed);
+    std::vector<double> cumulative;
+    double sum = 0;
+    for (size_t i = 0; i < TAG_VOCABULARY; i++) {
+        sum += std::pow(static_cast<double>(i + 1), -1.1);
+        cumulative.push_back(sum);
+    }
+    auto pickTag = [&] {
+        std::uniform_real_distribution<double> dist(0.0, sum);
+        return static_cast<size_t>(std::upper_bound(cumulative.begin(), cumulative.end(), dist(rng)) - cumulative.begin());
+    };
+
+    TrendingTags sketch;
+    const int64_t start = 1700000000;
+    const double secondsPerPost = 3.0 * sketch.windowSeconds() / postTotal;
+    std::vector<std::string> contents;
+    std::vector<std::pair<size_t, size_t>> tags;
+    contents.reserve(postTotal);
+    for (size_t i = 0; i < postTotal; i++) {
+        tags.emplace_back(pickTag(), pickTag());
+        contents.push_back("shipping today #tag" + std::to_string(tags.back().first) + " and #tag" +
+                           std::to_string(tags.back().second));
+    }
+    auto timestampOf = [&](size_t i) { return start + static_cast<int64_t>(i * secondsPerPost); };
+
+    auto ingestStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < postTotal; i++) sketch.addPost(contents[i], timestampOf(i));
+    double ingestNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - ingestStart).count() / postTotal;
+
+    // Exact counts over the slices the sketch still holds
+    int64_t end = timestampOf(postTotal - 1);
+    int64_t sliceSeconds = sketch.windowSeconds() / static_cast<int64_t>(TrendingTags::SLICES);
+    int64_t windowStart = (end / sliceSeconds - static_cast<int64_t>(TrendingTags::SLICES) + 1) * sliceSeconds;
+    std::unordered_map<std::string, uint32_t> exact;
+    for (size_t i = 0; i < postTotal; i++) {
+        if (timestampOf(i) < windowStart) continue;
+        exact["tag" + std::to_string(tags[i].first)]++;
+        if (tags[i].second != tags[i].first) exact["tag" + std::to_string(tags[i].second)]++;
+    }
+    TopK<std::string> exactTop(k);
+    for (const auto& entry : exact) exactTop.offer(entry.second, entry.first);
+    std::unordered_set<std::string> exactNames;
+    for (const auto& entry : exactTop.sorted()) exactNames.insert(entry.second);
+
+    size_t found = 0;
+    double relativeError = 0;
+    std::vector<std::pair<std::string, uint32_t>> top = sketch.top(k, end);
+    for (const auto& entry : top) {
+        if (exactNames.count(entry.first)) found++;
+        uint32_t truth = exact[entry.first];
+        relativeError += truth ? std::abs(static_cast<double>(entry.second) - truth) / truth : 1.0;
+    }
+
+    // The same on generated post text, from a few posts that stay in cache as
+    // a post's content does in createPost
+    std::vector<std::string> generated;
+    for (size_t i = 0; i < 64; i++) generated.push_back(gen.postContent());
+    TrendingTags plain;
+    auto plainStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < postTotal; i++) plain.addPost(generated[i % generated.size()], timestampOf(i));
+    double generatedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - plainStart).count() / postTotal;
+
+    std::ostream discard(nullptr);
+    LatencySamples view = measure(ctx.ops, [&](size_t) { net.viewTrending(discard); });
+
+    std::cout << resultLine(ctx, "trending")
+                     .add("posts", static_cast<double>(postTotal))
+                     .add("tag_vocabulary", static_cast<double>(TAG_VOCABULARY))
+                     .add("window_tags", static_cast<double>(exact.size()))
+                     .add("ingest_ns_per_post", ingestNs)
+                     .add("generated_ns_per_post", generatedNs)
+                     .add("memory_bytes", static_cast<double>(sketch.memoryBytes()))
+                     .add("top10_recall", exactNames.empty() ? 0.0 : static_cast<double>(found) / exactNames.size())
+                     .add("top10_mean_relative_error", top.empty() ? 0.0 : relativeError / top.size())
+                     .add("view_p50_us", view.percentile(0.50))
+                     .add("view_p99_us", view.percentile(0.99))
+                     .str()
+              << "\n";
+}
+
+// Cost of the per-operation metrics: one OperationTimer in a tight loop,
+// then login and feed latency with recording switched off and back on. Also
+// checks the feed histogram's p50 against the bench's own samples.
+void measureMetricsOverhead(const BenchContext& ctx, Network& net, GraphGenerator& gen) {
+    std::ostream discard(nullptr);
+    const size_t timerOps = 1000000;
+    auto timeTimers = [&] {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < timerOps; i++) {
+            OperationTimer timer(Operation::Login);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / timerOps;
+    };
+    auto timeOps = [&] {
+        LatencySamples login = measure(ctx.ops, [&](size_t) {
+            UserId id = gen.pickUniform();
+            net.login(GraphGenerator::usernameFor(id), "pw" + std::to_string(id));
+        });
+        LatencySamples feed = measure(ctx.ops, [&](size_t) {
+            net.viewNewsFeed(GraphGenerator::usernameFor(gen.pickUniform()), FeedCursor(), discard);
+        });
+        return std::make_pair(login.percentile(0.50), feed.percentile(0.50));
+    };
+
+    Metrics::setEnabled(false);
+    double timerOffNs = timeTimers();
+    auto off = timeOps();
+    Metrics::setEnabled(true);
+    double timerOnNs = timeTimers();
+    MetricsSnapshot before = Metrics::snapshot();
+    LatencySamples feed = measure(ctx.ops, [&](size_t) {
+        net.viewNewsFeed(GraphGenerator::usernameFor(gen.pickUniform()), FeedCursor(), discard);
+    });
+    LatencyHistogram histogram =
+        Metrics::snapshot().of(Operation::ViewNewsFeed).since(before.of(Operation::ViewNewsFeed));
+    auto on = timeOps();
+
+    std::cout << resultLine(ctx, "metrics_overhead")
+                     .add("timer_on_ns", timerOnNs)
+                     .add("timer_off_ns", timerOffNs)
+                     .add("login_p50_on_us", on.first)
+                     .add("login_p50_off_us", off.first)
+                     .add("feed_p50_on_us", on.second)
+                     .add("feed_p50_off_us", off.second)
+                     .add("feed_recorded", static_cast<double>(histogram.count()))
+                     .add("feed_sample_p50_us", feed.percentile(0.50))
+                     .add("feed_histogram_p50_us", histogram.percentileNs(0.50) / 1000)
+                     .str()
+              << "\n";
+}
+
+// Sustained posting into a PostStore with a retention budget, against one
+// without. Resident post-body bytes are sampled as posts arrive and should
+// level off at the budget while the unbounded store keeps growing. Then
+// every post is read back and checked against a CRC taken when it was
+// added, and random ten-post pages from the spilled range are timed as a
+// deep feed page would read them.
+void compareRetention(const BenchContext& ctx, GraphGenerator& gen) {
+    const size_t budget = size_t(8) << 20;
+    const size_t postTotal = std::max<size_t>(ctx.ops * 100, 500000);
+    const size_t pageSize = 10;
+    char directory[] = "/tmp/bench-segments-XXXXXX";
+    if (!mkdtemp(directory)) return;
+
+    std::vector<std::string> contents;
+    std::vector<uint32_t> checksums;
+    contents.reserve(postTotal);
+    size_t rawBytes = 0;
+    for (size_t i = 0; i < postTotal; i++) {
+        contents.push_back(gen.postContent() + " #" + std::to_string(i));
+        checksums.push_back(crc32(contents.back().data(), contents.back().size()));
+        rawBytes += contents.back().size();
+    }
+
+    JsonLine line = resultLine(ctx, "post_retention");
+    {
+        PostStore unbounded;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < postTotal; i++) unbounded.append(static_cast<UserId>(i % 1000), 1700000000 + i, contents[i]);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / postTotal;
+        line.add("unbounded_append_ns", ns)
+            .add("unbounded_memory_bytes", static_cast<double>(unbounded.memoryBytes()));
+    }
+
+    PostStore store;
+    store.setRetention(directory, budget);
+    std::vector<double> residentAt;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < postTotal; i++) {
+        store.append(static_cast<UserId>(i % 1000), 1700000000 + i, contents[i]);
+        if ((i + 1) % (postTotal / 4) == 0) residentAt.push_back(static_cast<double>(store.residentContentBytes()));
+    }
+    double appendNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / postTotal;
+
+    size_t mismatches = 0;
+    auto readStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < postTotal; i++) {
+        std::string_view content;
+        if (!store.content(i, content) || crc32(content.data(), content.size()) != checksums[i]) mismatches++;
+    }
+    double readNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - readStart).count() / postTotal;
+
+    size_t spilled = store.spilledPosts();
+    std::mt19937_64 rng(ctx.config.seed);
+    std::uniform_int_distribution<size_t> pick(0, spilled > pageSize ? spilled - pageSize : 0);
+    size_t pageBytes = 0;
+    size_t readsBefore = store.getSegments().blocksRead();
+    LatencySamples page = measure(spilled > pageSize ? ctx.ops : 0, [&](size_t) {
+        size_t first = pick(rng);
+        for (size_t i = first + pageSize; i-- > first;) pageBytes += bodyOf(store, i).size();
+    });
+    double blocksPerPage = page.count() ? static_cast<double>(store.getSegments().blocksRead() - readsBefore) / page.count() : 0.0;
+
+    const PostSegments& segments = store.getSegments();
+    std::cout << line.add("posts", static_cast<double>(postTotal))
+                     .add("content_bytes", static_cast<double>(rawBytes))
+                     .add("budget_bytes", static_cast<double>(budget))
+                     .add("resident_bytes_25", residentAt.size() > 0 ? residentAt[0] : 0.0)
+                     .add("resident_bytes_50", residentAt.size() > 1 ? residentAt[1] : 0.0)
+                     .add("resident_bytes_75", residentAt.size() > 2 ? residentAt[2] : 0.0)
+                     .add("resident_bytes_100", residentAt.size() > 3 ? residentAt[3] : 0.0)
+                     .add("memory_bytes", static_cast<double>(store.memoryBytes()))
+                     .add("spilled_posts", static_cast<double>(spilled))
+                     .add("segment_files", static_cast<double>(segments.fileCount()))
+                     .add("disk_bytes", static_cast<double>(segments.bytesOnDisk()))
+                     .add("compression_ratio", segments.bytesOnDisk() ? static_cast<double>(segments.bytesStored()) / segments.bytesOnDisk() : 0.0)
+                     .add("append_ns", appendNs)
+                     .add("sequential_read_ns", readNs)
+                     .add("mismatches", static_cast<double>(mismatches))
+                     .add("spilled_page_p50_us", page.percentile(0.50))
+                     .add("spilled_page_p99_us", page.percentile(0.99))
+                     .add("blocks_read_per_page", blocksPerPage)
+                     .add("page_bytes", static_cast<double>(pageBytes))
+                     .str()
+              << "\n";
+    rmdir(directory);
+}
+
+void runSerial(const BenchContext& ctx) {
+    Network net;
+    GraphGenerator gen(ctx.config);
+    std::ostream discard(nullptr);
+
+    // Bulk load: register everyone, connect the edges and create the posts
+    size_t rssBefore = residentBytes();
+    auto loadStart = std::chrono::steady_clock::now();
+    gen.populate(net);
+    double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+    size_t loadBytes = residentBytes() - rssBefore;
+    std::cout << resultLine(ctx, "bulk_load")
+                     .add("ms", loadMs)
+                     .add("users_loaded", static_cast<double>(net.userCount()))
+                     .add("edges_loaded", static_cast<double>(net.getGraph().snapshot().edgeCount() / 2))
+                     .add("posts_loaded", static_cast<double>(net.postCount()))
+                     .add("rss_delta_bytes", static_cast<double>(loadBytes))
+                     .add("rss_bytes", static_cast<double>(residentBytes()))
+                     .str()
+              << "\n";
+
+    LatencySamples login = measure(ctx.ops, [&](size_t) {
+        UserId id = gen.pickUniform();
+        net.login(GraphGenerator::usernameFor(id), "pw" + std::to_string(id));
+    });
+    report(ctx, "login", login);
+
+    LatencySamples feed = measure(ctx.ops, [&](size_t) {
+        net.viewNewsFeed(GraphGenerator::usernameFor(gen.pickUniform()), FeedCursor(), discard);
+    });
+    report(ctx, "view_news_feed", feed);
+
+    std::ostream jsonDiscard(nullptr);
+    setOutputFormat(jsonDiscard, OutputFormat::JsonLines);
+    LatencySamples feedJson = measure(ctx.ops, [&](size_t) {
+        net.viewNewsFeed(GraphGenerator::usernameFor(gen.pickUniform()), FeedCursor(), jsonDiscard);
+    });
+    report(ctx, "view_news_feed_json", feedJson);
+
+    const std::vector<std::string> queries = {"ali", "smith", "user1", "an", "ro", "grace lee", "e", "olivia jones"};
+    LatencySamples search = measure(ctx.ops, [&](size_t i) {
+        net.searchUsers(queries[i % queries.size()], 20, discard);
+    });
+    report(ctx, "search_users", search);
+
+    LatencySamples post = measure(ctx.ops, [&](size_t) {
+        net.createPost(GraphGenerator::usernameFor(gen.pickUser()), gen.postContent(), discard);
+    });
+    report(ctx, "create_post", post);
+
+    std::vector<std::pair<std::string, std::string>> sent;
+    sent.reserve(ctx.ops);
+    LatencySamples request = measure(ctx.ops, [&](size_t) {
+        std::string from = GraphGenerator::usernameFor(gen.pickUniform());
+        std::string to = GraphGenerator::usernameFor(gen.pickUser());
+        net.sendConnectionRequest(from, to, discard);
+        sent.emplace_back(to, from);
+    });
+    report(ctx, "send_connection_request", request);
+
+    LatencySamples accept = measure(sent.size(), [&](size_t i) {
+        net.acceptConnectionRequest(sent[i].first, sent[i].second, discard);
+    });
+    report(ctx, "accept_connection_request", accept);
+
+    LatencySamples like = measure(ctx.ops, [&](size_t) {
+        net.addLike(gen.pickUniform(), gen.pickUser() % net.postCount());
+    });
+    report(ctx, "like_post", like);
+
+    LatencySamples top = measure(ctx.ops, [&](size_t) {
+        net.viewTopPosts(GraphGenerator::usernameFor(gen.pickUniform()), discard);
+    });
+    report(ctx, "view_top_posts", top);
+
+    measureMetricsOverhead(ctx, net, gen);
+    comparePostLayouts(ctx, net, gen);
+    compareSuggestions(ctx, net, gen);
+    compareSeparation(ctx, net, gen);
+    comparePostSearch(ctx, net, gen);
+    compareTrending(ctx, net, gen);
+    compareMutualCounts(ctx, net, gen);
+    compareRetention(ctx, gen);
+
+    std::cout << resultLine(ctx, "memory")
+                     .add("rss_bytes", static_cast<double>(residentBytes()))
+                     .add("peak_rss_bytes", static_cast<double>(peakResidentBytes()))
+                     .str()
+              << "\n";
+}
+
+// Network shared between threads the way Server shares it: feed pages
+// (what CommandSession::isLockFree allows) without the lock, other reads,
+// likes and requests (isConcurrent) under a shared lock, every other
+// mutation under an exclusive one.
+struct SharedNetwork {
+    Network net;
+    std::shared_mutex lock;
+
+    template <typename Fn>
+    auto unlocked(Fn fn) {
+        return fn(net);
+    }
+
+    template <typename Fn>
+    auto read(Fn fn) {
+        std::shared_lock<std::shared_mutex> held(lock);
+        return fn(net);
+    }
+
+    template <typename Fn>
+    auto write(Fn fn) {
+        std::unique_lock<std::shared_mutex> held(lock);
+        return fn(net);
+    }
+
+    // Under the shared lock, or the exclusive one if it connects the two
+    RequestStatus request(UserId from, UserId to) {
+        RequestStatus status = read([&](Network& n) { return n.requestConnection(from, to, Network::currentTime(), false); });
+        if (status != RequestStatus::Deferred) return status;
+        return write([&](Network& n) { return n.requestConnection(from, to); });
+    }
+};
+
+// Mixed workload for the concurrent benchmarks: mostly feed reads, with
+// posts, requests and accepts interleaved.
+struct MixedWorker {
+    GraphGenerator gen;
+    std::ostream discard{nullptr};
+    std::vector<std::pair<UserId, UserId>> sent; // (recipient, sender) awaiting accept
+
+    MixedWorker(const GeneratorConfig& config, uint64_t seed) : gen([&] {
+        GeneratorConfig c = config;
+        c.seed = seed;
+        return c;
+    }()) {}
+
+    // Returns true if the op was a feed read.
+    bool step(SharedNetwork& shared, size_t i) {
+        size_t kind = i % 50;
+        if (kind < 4) {
+            UserId author = gen.pickUser();
+            std::string content = gen.postContent();
+            shared.write([&](Network& net) { return net.addPost(author, content); });
+        } else if (kind == 4) {
+            UserId from = gen.pickUniform();
+            UserId to = gen.pickUser();
+            if (shared.request(from, to) == RequestStatus::Sent) sent.emplace_back(to, from);
+        } else if (kind == 5 && !sent.empty()) {
+            shared.write([&](Network& net) { return net.acceptConnection(sent.back().first, sent.back().second); });
+            sent.pop_back();
+        } else {
+            UserId id = gen.pickUniform();
+            FeedCursor cursor;
+            shared.unlocked([&](Network& net) { return net.feedPage(id, cursor, 50); });
+            return true;
+        }
+        return false;
+    }
+};
+
+std::vector<size_t> threadCounts(size_t maxThreads) {
+    std::vector<size_t> counts;
+    for (size_t t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+// Throughput of a SharedNetwork as threads are added. Each thread runs
+// `ops` operations, so the total work grows with the thread count.
+void runScaling(const BenchContext& ctx) {
+    SharedNetwork shared;
+    Network& net = shared.net;
+    GraphGenerator gen(ctx.config);
+    auto loadStart = std::chrono::steady_clock::now();
+    gen.populate(net);
+    double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+    std::cout << resultLine(ctx, "concurrent_load")
+                     .add("ms", loadMs)
+                     .add("users_loaded", static_cast<double>(net.userCount()))
+                     .add("posts_loaded", static_cast<double>(net.postCount()))
+                     .add("rss_bytes", static_cast<double>(residentBytes()))
+                     .str()
+              << "\n";
+
+    double singleThreadRate = 0;
+    for (size_t threads : threadCounts(ctx.threads)) {
+        std::vector<LatencySamples> feedSamples(threads);
+        std::vector<std::thread> pool;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < threads; t++) {
+            pool.emplace_back([&, t] {
+                MixedWorker worker(ctx.config, ctx.config.seed + 1000 + t);
+                for (size_t i = 0; i < ctx.ops; i++) {
+                    auto opStart = std::chrono::steady_clock::now();
+                    if (worker.step(shared, i)) {
+                        feedSamples[t].add(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - opStart).count());
+                    }
+                }
+            });
+        }
+        for (auto& thread : pool) thread.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        LatencySamples feed;
+        for (auto& samples : feedSamples) feed.merge(samples);
+        double rate = static_cast<double>(threads * ctx.ops) / seconds;
+        if (threads == 1) singleThreadRate = rate;
+        std::cout << resultLine(ctx, "concurrent_scaling")
+                         .add("threads", static_cast<double>(threads))
+                         .add("ops", static_cast<double>(threads * ctx.ops))
+                         .add("ops_per_sec", rate)
+                         .add("speedup", singleThreadRate > 0 ? rate / singleThreadRate : 0.0)
+                         .add("feed_p50_us", feed.percentile(0.50))
+                         .add("feed_p99_us", feed.percentile(0.99))
+                         .add("feed_max_us", feed.max())
+                         .str()
+                  << "\n";
+    }
+
+    // Every thread likes and unlikes the same post as its own set of users
+    double singleThreadLikes = 0;
+    for (size_t threads : threadCounts(ctx.threads)) {
+        std::vector<std::thread> pool;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < threads; t++) {
+            pool.emplace_back([&, t] {
+                for (size_t i = 0; i < ctx.ops; i++) {
+                    UserId user = static_cast<UserId>((t + i * threads) % net.userCount());
+                    shared.read([&](Network& n) { return n.addLike(user, 0) || n.removeLike(user, 0); });
+                }
+            });
+        }
+        for (auto& thread : pool) thread.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double rate = static_cast<double>(threads * ctx.ops) / seconds;
+        if (threads == 1) singleThreadLikes = rate;
+        std::cout << resultLine(ctx, "hot_post_likes")
+                         .add("threads", static_cast<double>(threads))
+                         .add("ops", static_cast<double>(threads * ctx.ops))
+                         .add("ops_per_sec", rate)
+                         .add("speedup", singleThreadLikes > 0 ? rate / singleThreadLikes : 0.0)
+                         .add("likes", static_cast<double>(net.getPost(0).getLikes()))
+                         .str()
+                  << "\n";
+    }
+}
+
+// Runs conflicting operations from many threads at once, then checks that
+// the SharedNetwork ended up consistent. Returns the number of violations.
+size_t runStress(const BenchContext& ctx) {
+    SharedNetwork shared;
+    Network& net = shared.net;
+    GraphGenerator gen(ctx.config);
+    gen.populate(net);
+    size_t initialPosts = net.postCount();
+    size_t threads = ctx.threads;
+    const size_t contested = 100; // Usernames every thread tries to register
+
+    std::atomic<size_t> failures{0};
+    std::atomic<size_t> postsAdded{0};
+    std::atomic<size_t> contestedWins{0};
+    auto fail = [&](const std::string& what) {
+        if (failures.fetch_add(1) < 10) std::cerr << "stress: " << what << "\n";
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; t++) {
+        pool.emplace_back([&, t] {
+            MixedWorker worker(ctx.config, ctx.config.seed + 2000 + t);
+            for (size_t i = 0; i < contested; i++) {
+                auto user = worker.gen.makeUserFor(ctx.config.users + i);
+                if (shared.write([&](Network& n) { return n.addUser(std::move(user)); })) contestedWins++;
+            }
+            for (size_t i = 0; i < ctx.ops; i++) {
+                switch (i % 10) {
+                    case 0: {
+                        UserId author = worker.gen.pickUser();
+                        std::string content = worker.gen.postContent();
+                        if (shared.write([&](Network& n) { return n.addPost(author, content); })) postsAdded++;
+                        break;
+                    }
+                    case 1: {
+                        // Requests in both directions between hubs, so the
+                        // second often accepts the first, and accepts from
+                        // both sides racing each other
+                        UserId a = worker.gen.pickUser();
+                        UserId b = worker.gen.pickUser();
+                        shared.request(a, b);
+                        shared.request(b, a);
+                        shared.write([&](Network& n) { return n.acceptConnection(a, b); });
+                        shared.write([&](Network& n) { return n.acceptConnection(b, a); });
+                        break;
+                    }
+                    case 2:
+                    case 3: {
+                        // Everyone piles onto the first few posts
+                        UserId user = worker.gen.pickUniform();
+                        size_t post = i % 4;
+                        shared.read([&](Network& n) { return n.addLike(user, post) || n.removeLike(user, post); });
+                        break;
+                    }
+                    default: {
+                        UserId id = worker.gen.pickUniform();
+                        // Alongside the writers; connections are never
+                        // removed, so ones made since the page still count
+                        shared.unlocked([&](Network& n) {
+                            FeedCursor cursor;
+                            std::vector<size_t> items = n.feedPage(id, cursor, 50);
+                            std::vector<size_t> more = n.feedPage(id, cursor, 50);
+                            if (!items.empty() && !more.empty() && more.front() >= items.back()) fail("feed pages overlap");
+                            std::unordered_set<UserId> allowed = {id};
+                            n.forEachNeighbor(id, [&](UserId conn) { allowed.insert(conn); });
+                            for (size_t k = 0; k < items.size(); k++) {
+                                if (k && items[k - 1] <= items[k]) fail("feed out of order");
+                                if (!allowed.count(n.getPost(items[k]).getAuthor())) fail("feed post from a stranger");
+                            }
+                            return items.size();
+                        });
+                        break;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : pool) thread.join();
+
+    if (contestedWins != contested) fail("contested usernames registered " + std::to_string(contestedWins.load()) + " times");
+    if (net.postCount() != initialPosts + postsAdded) fail("post count mismatch");
+
+    const ConnectionGraph& graph = net.getGraph();
+    size_t postsSeen = 0;
+    size_t edgeEnds = 0;
+    for (UserId id = 0; id < net.userCount(); id++) {
+        if (net.getUser(id).getId() != id) fail("user id mismatch");
+        if (net.idOf(net.getUser(id).getUsername()) != id) fail("username lookup mismatch");
+
+        size_t previous = 0;
+        bool first = true;
+        for (size_t index : net.postsOf(id)) {
+            if (!first && index <= previous) fail("author posts out of order");
+            if (net.getPost(index).getAuthor() != id) fail("post filed under the wrong author");
+            previous = index;
+            first = false;
+            postsSeen++;
+        }
+
+        std::unordered_set<UserId> seen;
+        graph.forEachNeighbor(id, [&](UserId conn) {
+            if (!seen.insert(conn).second) fail("duplicate connection");
+            if (!graph.connected(conn, id)) fail("connection not symmetric");
+            edgeEnds++;
+        });
+        if (seen.size() != net.getUser(id).getConnectionCount()) fail("connection count out of date");
+    }
+    if (postsSeen != net.postCount()) fail("posts missing from author lists");
+
+    // A request never stands between connected users or in both directions
+    net.getRequests().forEach([&](const RequestStore::Request& r) {
+        if (graph.connected(r.from, r.to)) fail("pending request between connected users");
+        if (net.getRequests().contains(r.to, r.from)) fail("pending requests in both directions");
+    });
+
+    size_t likesCounted = 0;
+    for (size_t i = 0; i < net.postCount(); i++) {
+        int n = net.getPost(i).getLikes();
+        if (n < 0) fail("negative like count");
+        likesCounted += static_cast<size_t>(n);
+    }
+    size_t likers = 0;
+    net.forEachLike([&](UserId, size_t) { likers++; });
+    if (likesCounted != likers) fail("like counts disagree with likers");
+
+    std::cout << resultLine(ctx, "concurrent_stress")
+                     .add("threads", static_cast<double>(threads))
+                     .add("ops", static_cast<double>(threads * ctx.ops))
+                     .add("users_final", static_cast<double>(net.userCount()))
+                     .add("edges", static_cast<double>(edgeEnds / 2))
+                     .add("posts", static_cast<double>(net.postCount()))
+                     .add("failures", static_cast<double>(failures.load()))
+                     .str()
+              << "\n";
+    return failures;
+}
+
+void reportImport(const BenchContext& ctx, const std::string& name, const ImportStats& stats, size_t threads,
+                  double incrementalMs) {
+    std::cout << resultLine(ctx, name)
+                     .add("threads", static_cast<double>(threads))
+                     .add("rows", static_cast<double>(stats.rows))
+                     .add("imported", static_cast<double>(stats.imported))
+                     .add("rejected", static_cast<double>(stats.rejected))
+                     .add("ms", stats.seconds * 1000)
+                     .add("rows_per_s", stats.rowsPerSecond())
+                     .add("incremental_ms", incrementalMs)
+                     .str()
+              << "\n";
+}
+
+// Writes the generated users, edges and posts to files, imports them into one
+// Network and adds the same data item by item to another, then checks the two
+// agree. Returns the number of disagreements.
+size_t runImport(const BenchContext& ctx) {
+    GraphGenerator gen(ctx.config);
+    char dirTemplate[] = "/tmp/careerconnect-import-XXXXXX";
+    if (!mkdtemp(dirTemplate)) {
+        std::cerr << "Cannot create a temporary directory\n";
+        return 1;
+    }
+    std::string dir = dirTemplate;
+    const std::string usersPath = dir + "/users.csv";
+    const std::string edgesPath = dir + "/edges.csv";
+    const std::string edgesJsonPath = dir + "/edges.jsonl";
+    const std::string postsPath = dir + "/posts.csv";
+
+    std::vector<std::pair<UserId, UserId>> edges = gen.edges();
+    struct GeneratedPost {
+        UserId author;
+        std::string content;
+    };
+    std::vector<GeneratedPost> posts(static_cast<size_t>(ctx.config.users * ctx.config.postsPerUser));
+    for (auto& post : posts) post = {gen.pickUser(), gen.postContent()};
+    const int64_t firstPostTime = 1700000000;
+    {
+        std::ofstream users(usersPath), edgeCsv(edgesPath), edgeJson(edgesJsonPath), postCsv(postsPath);
+        users << "type,username,password,name,detail1,detail2\n";
+        for (size_t i = 0; i < ctx.config.users; i++) {
+            std::unique_ptr<User> user = gen.makeUserFor(i);
+            users << user->getTypeCode() << ',' << user->getUsername() << ',' << user->getPassword() << ','
+                  << user->getFullName() << ',' << user->getDetail1() << ',' << user->getDetail2() << '\n';
+        }
+        edgeCsv << "from,to\n";
+        for (const auto& edge : edges) {
+            std::string a = GraphGenerator::usernameFor(edge.first), b = GraphGenerator::usernameFor(edge.second);
+            edgeCsv << a << ',' << b << '\n';
+            edgeJson << "{\"from\":\"" << a << "\",\"to\":\"" << b << "\"}\n";
+        }
+        postCsv << "author,timestamp,content\n";
+        for (size_t i = 0; i < posts.size(); i++) {
+            postCsv << GraphGenerator::usernameFor(posts[i].author) << ',' << firstPostTime + static_cast<int64_t>(i)
+                    << ",\"" << posts[i].content << "\"\n";
+        }
+    }
+
+    // One item at a time, as the menus and the log replay do
+    Network incremental;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ctx.config.users; i++) incremental.addUser(gen.makeUserFor(i));
+    double usersMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (const auto& edge : edges) {
+        incremental.requestConnection(edge.first, edge.second);
+        incremental.acceptConnection(edge.second, edge.first);
+    }
+    double edgesMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < posts.size(); i++) {
+        incremental.addPost(posts[i].author, posts[i].content, firstPostTime + static_cast<int64_t>(i));
+    }
+    double postsMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    Network imported;
+    BulkImporter importer(imported, ctx.threads);
+    ImportStats userStats, edgeStats, postStats;
+    size_t failures = 0;
+    failures += !importer.importUsers(usersPath, userStats);
+    failures += !importer.importConnections(edgesPath, edgeStats);
+    failures += !importer.importPosts(postsPath, postStats);
+    reportImport(ctx, "import_users", userStats, ctx.threads, usersMs);
+    reportImport(ctx, "import_edges", edgeStats, ctx.threads, edgesMs);
+    reportImport(ctx, "import_posts", postStats, ctx.threads, postsMs);
+
+    // Every edge again, as JSON lines: all of them are duplicates now
+    ImportStats jsonStats;
+    failures += !importer.importConnections(edgesJsonPath, jsonStats);
+    reportImport(ctx, "import_edges_jsonl", jsonStats, ctx.threads, edgesMs);
+
+    // The two networks must hold the same users, connections and posts
+    if (imported.userCount() != incremental.userCount() || imported.postCount() != incremental.postCount()) failures++;
+    if (jsonStats.imported != 0 || jsonStats.duplicates() != edges.size()) failures++;
+    for (UserId id = 0; id < imported.userCount() && id < incremental.userCount(); id++) {
+        if (imported.usernameOf(id) != incremental.usernameOf(id)) failures++;
+        if (imported.getUser(id).getConnectionCount() != incremental.getUser(id).getConnectionCount()) failures++;
+        if (imported.postsOf(id) != incremental.postsOf(id)) failures++;
+    }
+    const SortedAdjacency& a = imported.getGraph().snapshot();
+    const SortedAdjacency& b = incremental.getGraph().snapshot();
+    for (UserId id = 0; id < a.vertexCount() && id < b.vertexCount(); id++) {
+        if (!std::equal(a.begin(id), a.end(id), b.begin(id), b.end(id))) failures++;
+    }
+    for (size_t i = 0; i < imported.postCount() && i < incremental.postCount(); i++) {
+        if (imported.getPost(i).content != incremental.getPost(i).content) failures++;
+    }
+
+    std::cout << resultLine(ctx, "import_check")
+                     .add("edges", static_cast<double>(a.edgeCount() / 2))
+                     .add("failures", static_cast<double>(failures))
+                     .str()
+              << "\n";
+    for (const std::string& path : {usersPath, edgesPath, edgesJsonPath, postsPath}) std::remove(path.c_str());
+    rmdir(dir.c_str());
+    return failures;
+}
+
+int main(int argc, char* argv[]) {
+    BenchContext ctx;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        std::string value = argv[i + 1];
+        if (arg == "--users") ctx.config.users = std::stoul(value);
+        else if (arg == "--degree") ctx.config.averageDegree = std::stod(value);
+        else if (arg == "--posts") ctx.config.postsPerUser = std::stod(value);
+        else if (arg == "--skew") ctx.config.skew = std::stod(value);
+        else if (arg == "--ops") ctx.ops = std::stoul(value);
+        else if (arg == "--seed") ctx.config.seed = std::stoull(value);
+        else if (arg == "--mode") ctx.mode = value;
+        else if (arg == "--threads") ctx.threads = std::stoul(value);
+        else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    if (ctx.threads == 0) ctx.threads = std::max(1u, std::thread::hardware_concurrency());
+
+    if (ctx.mode == "serial") {
+        runSerial(ctx);
+    } else if (ctx.mode == "scaling") {
+        runScaling(ctx);
+    } else if (ctx.mode == "stress") {
+        return runStress(ctx) == 0 ? 0 : 1;
+    } else if (ctx.mode == "import") {
+        return runImport(ctx) == 0 ? 0 : 1;
+    } else {
+        std::cerr << "Unknown mode " << ctx.mode << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Minimal line-protocol client for `main --serve`. Sends each line read from
+// stdin as one command and prints the server's reply, which ends with a line
+// containing only ".".
+//
+// Usage: client SOCKET_PATH
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::write(fd, data.data() + sent, data.size() - sent);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Reads one reply, printing it without the terminating "." line.
+bool readReply(int fd, std::string& pending) {
+    char buffer[4096];
+    while (true) {
+        size_t newline;
+        while ((newline = pending.find('\n')) != std::string::npos) {
+            std::string line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            if (line == ".") return true;
+            std::cout << line << "\n";
+        }
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n <= 0) return false;
+        pending.append(buffer, static_cast<size_t>(n));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: client SOCKET_PATH\n";
+        return 1;
+    }
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, argv[1], sizeof(addr.sun_path) - 1);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "Cannot connect to " << argv[1] << ".\n";
+        return 1;
+    }
+
+    bool interactive = ::isatty(STDIN_FILENO);
+    std::string line, pending;
+    while (true) {
+        if (interactive) std::cout << "> " << std::flush;
+        if (!getline(std::cin, line)) break;
+        if (!sendAll(fd, line + "\n") || !readReply(fd, pending)) {
+            std::cerr << "Connection closed by server.\n";
+            break;
+        }
+        std::cout << std::flush;
+    }
+    ::close(fd);
+    return 0;
+}
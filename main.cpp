@@ -1,186 +1,496 @@
-#include "Network.hpp"
-#include <iostream>
-#include <limits>
-
-void clearInputBuffer() {
-    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-}
-
-void showMainMenu() {
-    std::cout << "\n===== CareerConnect Main Menu =====\n";
-    std::cout << "1. Register\n";
-    std::cout << "2. Login\n";
-    std::cout << "3. Exit\n";
-    std::cout << "===================================\n";
-    std::cout << "Enter your choice: ";
-}
-
-void showUserMenu(const std::string& username) {
-    std::cout << "\n--- Welcome, " << username << "! ---\n";
-    std::cout << "1. View My Profile\n";
-    std::cout << "2. View News Feed\n";
-    std::cout << "3. Create a Post\n";
-    std::cout << "4. Search for Users\n";
-    std::cout << "5. Send Connection Request\n";
-    std::cout << "6. View Connection Requests\n";
-    std::cout << "7. Accept Connection Request\n";
-    std::cout << "8. Logout\n";
-    std::cout << "---------------------------\n";
-    std::cout << "Enter your choice: ";
-}
-
-void handleRegistration(Network& net) {
-    std::string type, uname, pwd, name, field1, field2;
-    std::cout << "Are you a (1) Student or (2) Professional? ";
-    std::cin >> type;
-    clearInputBuffer();
-
-    std::cout << "Enter username: ";
-    getline(std::cin, uname);
-    std::cout << "Enter password: ";
-    getline(std::cin, pwd);
-    std::cout << "Enter full name: ";
-    getline(std::cin, name);
-
-    if (type == "1") {
-        std::cout << "Enter university: ";
-        getline(std::cin, field1);
-        std::cout << "Enter major: ";
-        getline(std::cin, field2);
-        auto student = std::make_unique<Student>(uname, pwd, name, field1, field2);
-        if (net.addUser(std::move(student))) {
-            std::cout << "Student registration successful!\n";
-        } else {
-            std::cout << "Username already exists. Please try another.\n";
-        }
-    } else if (type == "2") {
-        std::cout << "Enter company: ";
-        getline(std::cin, field1);
-        std::cout << "Enter job title: ";
-        getline(std::cin, field2);
-        auto prof = std::make_unique<Professional>(uname, pwd, name, field1, field2);
-        if (net.addUser(std::move(prof))) {
-            std::cout << "Professional registration successful!\n";
-        } else {
-            std::cout << "Username already exists. Please try another.\n";
-        }
-    } else {
-        std::cout << "Invalid choice. Please try again.\n";
-    }
-}
-
-void loggedInLoop(User* currentUser, Network& net) {
-    int choice = 0;
-    while (choice != 8) {
-        showUserMenu(currentUser->getUsername());
-        std::cin >> choice;
-
-        if (std::cin.fail()) {
-            std::cout << "Invalid input. Please enter a number.\n";
-            std::cin.clear();
-            clearInputBuffer();
-            choice = 0;
-            continue;
-        }
-        clearInputBuffer();
-
-        switch (choice) {
-            case 1:
-                currentUser->displayProfile();
-                break;
-            case 2:
-                net.viewNewsFeed(currentUser->getUsername());
-                break;
-            case 3: {
-                std::string content;
-                std::cout << "What's on your mind? ";
-                getline(std::cin, content);
-                net.createPost(currentUser->getUsername(), content);
-                break;
-            }
-            case 4: {
-                std::string query;
-                std::cout << "Search by name or username: ";
-                getline(std::cin, query);
-                net.searchUsers(query);
-                break;
-            }
-            case 5: {
-                std::string targetUser;
-                std::cout << "Enter username to connect with: ";
-                getline(std::cin, targetUser);
-                net.sendConnectionRequest(currentUser->getUsername(), targetUser);
-                break;
-            }
-            case 6:
-                net.viewConnectionRequests(currentUser->getUsername());
-                break;
-            case 7: {
-                std::string requestUser;
-                std::cout << "Enter username of the request to accept: ";
-                getline(std::cin, requestUser);
-                net.acceptConnectionRequest(currentUser->getUsername(), requestUser);
-                break;
-            }
-            case 8:
-                std::cout << "Logging out...\n";
-                break;
-            default:
-                std::cout << "Invalid choice. Please try again.\n";
-                break;
-        }
-    }
-}
-
-int main() {
-    Network net;
-    int choice = 0;
-
-    // Pre-populate with some data for a better demo
-    net.addUser(std::make_unique<Professional>("jdoe", "pass123", "John Doe", "Innovate Inc.", "Software Engineer"));
-    net.addUser(std::make_unique<Student>("asmith", "pass123", "Alice Smith", "State University", "Computer Science"));
-
-    while (choice != 3) {
-        showMainMenu();
-        std::cin >> choice;
-
-        if (std::cin.fail()) {
-            std::cout << "Invalid input. Please enter a number.\n";
-            std::cin.clear();
-            clearInputBuffer();
-            choice = 0; // Reset choice
-            continue;
-        }
-        clearInputBuffer();
-
-        switch (choice) {
-            case 1:
-                handleRegistration(net);
-                break;
-            case 2: {
-                std::string uname, pwd;
-                std::cout << "Enter username: ";
-                getline(std::cin, uname);
-                std::cout << "Enter password: ";
-                getline(std::cin, pwd);
-
-                User* currentUser = net.login(uname, pwd);
-                if (currentUser) {
-                    std::cout << "Login successful!\n";
-                    loggedInLoop(currentUser, net);
-                } else {
-                    std::cout << "Invalid username or password.\n";
-                }
-                break;
-            }
-            case 3:
-                std::cout << "Exiting CareerConnect. Goodbye!\n";
-                break;
-            default:
-                std::cout << "Invalid choice. Please try again.\n";
-                break;
-        }
-    }
-
-    return 0;
+#include "Network.hpp"
+#include "Storage.hpp"
+#include "MappedNetwork.hpp"
+#include "CommandSession.hpp"
+#include "LatencySamples.hpp"
+#include "Server.hpp"
+#include "BulkImport.hpp"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <chrono>
+#include <thread>
+#include <charconv>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+void clearInputBuffer() {
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+}
+
+void showMainMenu() {
+    std::cout << "\n===== CareerConnect Main Menu =====\n";
+    std::cout << "1. Register\n";
+    std::cout << "2. Login\n";
+    std::cout << "3. Exit\n";
+    std::cout << "===================================\n";
+    std::cout << "Enter your choice: ";
+}
+
+void showUserMenu(const std::string& username) {
+    std::cout << "\n--- Welcome, " << username << "! ---\n";
+    std::cout << "1. View My Profile\n";
+    std::cout << "2. View News Feed\n";
+    std::cout << "3. Create a Post\n";
+    std::cout << "4. Search for Users\n";
+    std::cout << "5. Send Connection Request\n";
+    std::cout << "6. View Connection Requests\n";
+    std::cout << "7. Accept Connection Request\n";
+    std::cout << "8. Like/Unlike a Post\n";
+    std::cout << "9. View Top Posts\n";
+    std::cout << "10. People You May Know\n";
+    std::cout << "11. How Am I Connected?\n";
+    std::cout << "12. Search Posts\n";
+    std::cout << "13. Trending Hashtags\n";
+    std::cout << "14. Performance Stats\n";
+    std::cout << "15. Logout\n";
+    std::cout << "---------------------------\n";
+    std::cout << "Enter your choice: ";
+}
+
+// Templated so the same menus drive both Network and a read-mostly MappedNetwork
+template <typename NetworkT>
+void handleRegistration(NetworkT& net) {
+    std::string type, uname, pwd, name, field1, field2;
+    std::cout << "Are you a (1) Student or (2) Professional? ";
+    std::cin >> type;
+    clearInputBuffer();
+
+    std::cout << "Enter username: ";
+    getline(std::cin, uname);
+    std::cout << "Enter password: ";
+    getline(std::cin, pwd);
+    std::cout << "Enter full name: ";
+    getline(std::cin, name);
+
+    if (type == "1") {
+        std::cout << "Enter university: ";
+        getline(std::cin, field1);
+        std::cout << "Enter major: ";
+        getline(std::cin, field2);
+        auto student = std::make_unique<Student>(uname, pwd, name, field1, field2);
+        if (net.addUser(std::move(student))) {
+            std::cout << "Student registration successful!\n";
+        } else {
+            std::cout << "Username already exists. Please try another.\n";
+        }
+    } else if (type == "2") {
+        std::cout << "Enter company: ";
+        getline(std::cin, field1);
+        std::cout << "Enter job title: ";
+        getline(std::cin, field2);
+        auto prof = std::make_unique<Professional>(uname, pwd, name, field1, field2);
+        if (net.addUser(std::move(prof))) {
+            std::cout << "Professional registration successful!\n";
+        } else {
+            std::cout << "Username already exists. Please try another.\n";
+        }
+    } else {
+        std::cout << "Invalid choice. Please try again.\n";
+    }
+}
+
+template <typename NetworkT>
+void loggedInLoop(User* currentUser, NetworkT& net) {
+    int choice = 0;
+    while (choice != 15) {
+        showUserMenu(currentUser->getUsername());
+        std::cin >> choice;
+
+        if (std::cin.fail()) {
+            std::cout << "Invalid input. Please enter a number.\n";
+            std::cin.clear();
+            clearInputBuffer();
+            choice = 0;
+            continue;
+        }
+        clearInputBuffer();
+
+        switch (choice) {
+            case 1:
+                currentUser->displayProfile();
+                break;
+            case 2: {
+                FeedCursor cursor = net.viewNewsFeed(currentUser->getUsername());
+                while (!cursor.atEnd()) {
+                    std::string answer;
+                    std::cout << "Show older posts? (y/n): ";
+                    getline(std::cin, answer);
+                    if (answer != "y" && answer != "Y") break;
+                    cursor = net.viewNewsFeed(currentUser->getUsername(), cursor);
+                }
+                break;
+            }
+            case 3: {
+                std::string content;
+                std::cout << "What's on your mind? ";
+                getline(std::cin, content);
+                net.createPost(currentUser->getUsername(), content);
+                break;
+            }
+            case 4: {
+                std::string query;
+                std::cout << "Search by name or username: ";
+                getline(std::cin, query);
+                net.searchUsers(currentUser->getUsername(), query);
+                break;
+            }
+            case 5: {
+                std::string targetUser;
+                std::cout << "Enter username to connect with: ";
+                getline(std::cin, targetUser);
+                net.sendConnectionRequest(currentUser->getUsername(), targetUser);
+                break;
+            }
+            case 6:
+                net.viewConnectionRequests(currentUser->getUsername());
+                break;
+            case 7: {
+                std::string requestUser;
+                std::cout << "Enter username of the request to accept: ";
+                getline(std::cin, requestUser);
+                net.acceptConnectionRequest(currentUser->getUsername(), requestUser);
+                break;
+            }
+            case 8: {
+                size_t post = 0;
+                std::cout << "Enter the post number to like or unlike: ";
+                std::cin >> post;
+                if (std::cin.fail()) {
+                    std::cout << "Invalid input. Please enter a number.\n";
+                    std::cin.clear();
+                } else {
+                    net.toggleLike(currentUser->getUsername(), post);
+                }
+                clearInputBuffer();
+                break;
+            }
+            case 9:
+                net.viewTopPosts(currentUser->getUsername());
+                break;
+            case 10:
+                net.viewSuggestions(currentUser->getUsername());
+                break;
+            case 11: {
+                std::string targetUser;
+                std::cout << "Enter username to find: ";
+                getline(std::cin, targetUser);
+                net.viewConnectionPath(currentUser->getUsername(), targetUser);
+                break;
+            }
+            case 12: {
+                std::string query;
+                std::cout << "Search posts (words to match, OR between alternatives): ";
+                getline(std::cin, query);
+                net.searchPosts(currentUser->getUsername(), query);
+                break;
+            }
+            case 13:
+                net.viewTrending();
+                break;
+            case 14:
+                viewStats();
+                break;
+            case 15:
+                std::cout << "Logging out...\n";
+                break;
+            default:
+                std::cout << "Invalid choice. Please try again.\n";
+                break;
+        }
+    }
+}
+
+template <typename NetworkT>
+void runMainMenu(NetworkT& net) {
+    int choice = 0;
+    while (choice != 3) {
+        showMainMenu();
+        std::cin >> choice;
+
+        if (std::cin.fail()) {
+            std::cout << "Invalid input. Please enter a number.\n";
+            std::cin.clear();
+            clearInputBuffer();
+            choice = 0; // Reset choice
+            continue;
+        }
+        clearInputBuffer();
+
+        switch (choice) {
+            case 1:
+                handleRegistration(net);
+                break;
+            case 2: {
+                std::string uname, pwd;
+                std::cout << "Enter username: ";
+                getline(std::cin, uname);
+                std::cout << "Enter password: ";
+                getline(std::cin, pwd);
+
+                User* currentUser = net.login(uname, pwd);
+                if (currentUser) {
+                    std::cout << "Login successful!\n";
+                    loggedInLoop(currentUser, net);
+                } else {
+                    std::cout << "Invalid username or password.\n";
+                }
+                break;
+            }
+            case 3:
+                std::cout << "Exiting CareerConnect. Goodbye!\n";
+                break;
+            default:
+                std::cout << "Invalid choice. Please try again.\n";
+                break;
+        }
+    }
+}
+
+// Executes a command script (see CommandSession.hpp) without any prompts and
+// reports throughput and per-command latency on stderr. With `quiet` the
+// command output itself is discarded.
+void runBatch(Network& net, std::istream& in, bool quiet, OutputFormat format) {
+    CommandSession session(net, format);
+    std::ostream discard(nullptr);
+    std::ostream& out = quiet ? discard : std::cout;
+
+    const size_t kinds = static_cast<size_t>(CommandType::COUNT);
+    std::vector<LatencySamples> latencies(kinds); // Per command type
+    size_t total = 0;
+
+    auto batchStart = std::chrono::steady_clock::now();
+    std::string line;
+    while (getline(in, line)) {
+        auto start = std::chrono::steady_clock::now();
+        CommandType type = session.execute(line, out);
+        auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+        if (type == CommandType::None) continue;
+        latencies[static_cast<size_t>(type)].add(elapsed.count());
+        total++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStart).count();
+
+    std::cerr << "\n--- Batch Summary ---\n";
+    std::cerr << total << " commands in " << std::fixed << std::setprecision(3) << seconds * 1000 << " ms ("
+              << std::setprecision(0) << (seconds > 0 ? total / seconds : 0) << " commands/s)\n";
+    std::cerr << std::left << std::setw(10) << "command" << std::right << std::setw(10) << "count"
+              << std::setw(12) << "mean_us" << std::setw(12) << "p50_us" << std::setw(12) << "p99_us"
+              << std::setw(12) << "max_us" << "\n";
+    std::cerr << std::setprecision(2);
+    for (size_t k = 0; k < kinds; k++) {
+        LatencySamples& samples = latencies[k];
+        if (samples.empty()) continue;
+        std::cerr << std::left << std::setw(10) << CommandSession::name(static_cast<CommandType>(k)) << std::right
+                  << std::setw(10) << samples.count() << std::setw(12) << samples.mean()
+                  << std::setw(12) << samples.percentile(0.50) << std::setw(12) << samples.percentile(0.99)
+                  << std::setw(12) << samples.max() << "\n";
+    }
+}
+
+// Loads one file with `load` (a BulkImporter call) and reports how it went.
+template <typename Load>
+bool runImport(const std::string& kind, const std::string& path, Load load) {
+    ImportStats stats;
+    if (!load(path, stats)) {
+        std::cout << "Cannot import " << kind << " from " << path << ".\n";
+        return false;
+    }
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << "Imported " << stats.imported << " " << kind << " from " << path << " in " << std::fixed
+              << std::setprecision(1) << stats.seconds * 1000 << " ms (" << std::setprecision(0)
+              << stats.rowsPerSecond() << " rows/s); " << stats.rejected << " rows rejected, "
+              << stats.duplicates() << " duplicates.\n";
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+    return true;
+}
+
+// Parses a command-line option's value, which must be a non-negative
+// number (a whole one for counts). Returns false, leaving `value` alone, if
+// it is not.
+bool parseOption(const char* text, double& value) {
+    char* end = nullptr;
+    errno = 0;
+    double parsed = std::strtod(text, &end);
+    if (end == text || *end != '\0' || errno != 0 || !std::isfinite(parsed) || parsed < 0) return false;
+    value = parsed;
+    return true;
+}
+
+bool parseOption(const char* text, size_t& value) {
+    const char* end = text + std::strlen(text);
+    auto result = std::from_chars(text, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+int invalidOption(const std::string& option, const char* value) {
+    std::cout << "Invalid value for " << option << ": " << value << ".\n";
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    Network net;
+
+    // State is kept in a data directory (snapshot + write-ahead log) between runs.
+    // --no-persist keeps everything in memory only.
+    // --export-map FILE writes the restored state as a mapped snapshot and exits;
+    // --map FILE serves the menus straight from such a file instead.
+    // --batch FILE runs a command script ('-' for stdin) instead of the menus,
+    // --quiet discards its command output and --format json writes it as
+    // JSON lines.
+    // --serve SOCKET accepts client sessions on a Unix domain socket, running
+    // commands on --workers N threads (default: one per core).
+    // --import-users, --import-edges and --import-posts FILE bulk-load CSV or
+    // JSON-lines files (see BulkImport.hpp), parsing on --workers threads.
+    // Each may be given more than once.
+    // --stats-file FILE rewrites FILE with operation latencies and counters as
+    // JSON lines every --stats-every SECONDS (default 10) and on exit.
+    // --post-memory MB keeps about that many megabytes of posts in memory
+    // and moves older ones, with their index entries, to files in the data
+    // directory.
+    std::string dataDir = "careerconnect-data";
+    std::string exportPath, mapPath, batchPath, socketPath;
+    std::vector<std::string> usersPaths, edgesPaths, postsPaths;
+    std::string statsPath;
+    double statsEvery = 10;
+    double postMemory = 0;
+    size_t workers = std::thread::hardware_concurrency();
+    bool persist = true;
+    bool quiet = false;
+    OutputFormat format = OutputFormat::Text;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--data" && hasValue) {
+            dataDir = argv[++i];
+        } else if (arg == "--export-map" && hasValue) {
+            exportPath = argv[++i];
+        } else if (arg == "--map" && hasValue) {
+            mapPath = argv[++i];
+        } else if (arg == "--batch" && hasValue) {
+            batchPath = argv[++i];
+        } else if (arg == "--serve" && hasValue) {
+            socketPath = argv[++i];
+        } else if (arg == "--import-users" && hasValue) {
+            usersPaths.push_back(argv[++i]);
+        } else if (arg == "--import-edges" && hasValue) {
+            edgesPaths.push_back(argv[++i]);
+        } else if (arg == "--import-posts" && hasValue) {
+            postsPaths.push_back(argv[++i]);
+        } else if (arg == "--stats-file" && hasValue) {
+            statsPath = argv[++i];
+        } else if (arg == "--stats-every" && hasValue) {
+            if (!parseOption(argv[++i], statsEvery)) return invalidOption(arg, argv[i]);
+        } else if (arg == "--post-memory" && hasValue) {
+            if (!parseOption(argv[++i], postMemory)) return invalidOption(arg, argv[i]);
+        } else if (arg == "--workers" && hasValue) {
+            if (!parseOption(argv[++i], workers)) return invalidOption(arg, argv[i]);
+        } else if (arg == "--no-persist") {
+            persist = false;
+        } else if (arg == "--quiet") {
+            quiet = true;
+        } else if (arg == "--format" && hasValue) {
+            std::string value = argv[++i];
+            if (value != "text" && value != "json") return invalidOption(arg, argv[i]);
+            format = value == "json" ? OutputFormat::JsonLines : OutputFormat::Text;
+        }
+    }
+
+    std::unique_ptr<MetricsDumper> statsDumper;
+    if (!statsPath.empty()) {
+        auto every = std::chrono::milliseconds(static_cast<int64_t>(std::max(statsEvery, 0.001) * 1000));
+        statsDumper = std::make_unique<MetricsDumper>(statsPath, every);
+    }
+
+    if (!mapPath.empty()) {
+        auto start = std::chrono::steady_clock::now();
+        MappedNetwork mapped;
+        if (!mapped.open(mapPath)) {
+            std::cout << "Cannot open mapped snapshot " << mapPath << ".\n";
+            return 1;
+        }
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        std::cout << "Mapped " << mapped.userCount() << " users and " << mapped.postCount() << " posts in "
+                  << elapsed.count() << " ms. Changes made in this session are not saved.\n";
+        runMainMenu(mapped);
+        return 0;
+    }
+
+    // Before the snapshot is loaded, so it can take back the segment files it
+    // names. Without persistence they are only a cache, named apart from those.
+    if (postMemory > 0 && !net.setPostRetention(dataDir, static_cast<size_t>(postMemory * (1 << 20)), persist)) {
+        std::cout << "Cannot keep post segments in " << dataDir << "; keeping all posts in memory.\n";
+    }
+
+    Storage storage(net, dataDir);
+    bool persistent = persist && storage.open();
+    if (persist && !persistent) {
+        std::cout << "Continuing without persistence; changes will be lost on exit.\n";
+    }
+
+    // Users first, so edges and posts can name them
+    if (!usersPaths.empty() || !edgesPaths.empty() || !postsPaths.empty()) {
+        BulkImporter importer(net, workers);
+        for (const std::string& path : usersPaths) {
+            if (!runImport("users", path, [&](const std::string& p, ImportStats& s) { return importer.importUsers(p, s); })) return 1;
+        }
+        for (const std::string& path : edgesPaths) {
+            if (!runImport("connections", path, [&](const std::string& p, ImportStats& s) { return importer.importConnections(p, s); })) return 1;
+        }
+        for (const std::string& path : postsPaths) {
+            if (!runImport("posts", path, [&](const std::string& p, ImportStats& s) { return importer.importPosts(p, s); })) return 1;
+        }
+        // Imports bypass the log, so fold them into a snapshot straight away
+        if (persistent && !storage.checkpoint()) {
+            std::cout << "Cannot write snapshot to " << dataDir << "; the imports are not saved yet.\n";
+        }
+    }
+
+    // Pre-populate with some data for a better demo (ignored if restored already)
+    net.addUser(std::make_unique<Professional>("jdoe", "pass123", "John Doe", "Innovate Inc.", "Software Engineer"));
+    net.addUser(std::make_unique<Student>("asmith", "pass123", "Alice Smith", "State University", "Computer Science"));
+
+    if (!exportPath.empty()) {
+        if (!MappedSnapshot::write(net, exportPath)) {
+            std::cout << "Cannot write mapped snapshot " << exportPath << ".\n";
+            return 1;
+        }
+        std::cout << "Wrote mapped snapshot " << exportPath << ".\n";
+        return 0;
+    }
+
+    if (!socketPath.empty()) {
+        std::function<bool()> durable;
+        if (persistent) durable = [&storage] { return storage.sync(); };
+        Server server(net, socketPath, workers, durable);
+        if (!server.run()) {
+            std::cout << "Cannot listen on " << socketPath << ".\n";
+            return 1;
+        }
+    } else if (!batchPath.empty()) {
+        if (batchPath == "-") {
+            runBatch(net, std::cin, quiet, format);
+        } else {
+            std::ifstream script(batchPath);
+            if (!script) {
+                std::cout << "Cannot open command script " << batchPath << ".\n";
+                return 1;
+            }
+            runBatch(net, script, quiet, format);
+        }
+    } else {
+        runMainMenu(net);
+    }
+
+    // Fold the log into a fresh snapshot so the next start has nothing to replay
+    if (persistent && !storage.checkpoint()) {
+        std::cout << "Cannot write snapshot to " << dataDir << "; the log will be replayed on the next start.\n";
+        return 1;
+    }
+    return 0;
 }
\ No newline at end of file
@@ -1,302 +1,467 @@
-#include <iostream>
-#include <vector>
-#include <string>
-#include <sstream>
-#include <memory>
-#include <algorithm>
-
-using namespace std;
-
-// --- 1. Base Class: Profile (Uses Inheritance) ---
-
-/**
- * The abstract base class for all professionals.
- */
-class Profile {
-protected:
-    int profileID;
-    string name;
-    string profession;
-    vector<shared_ptr<Profile>> connections;
-
-public:
-    // Constructor
-    Profile(int id, const string& n, const string& p) : profileID(id), name(n), profession(p) {}
-
-    // Virtual destructor is crucial for proper memory management with inheritance
-    virtual ~Profile() {}
-
-    // Pure virtual function (makes Profile an Abstract Class)
-    virtual void introduce() const = 0;
-
-    // Common method for all profiles
-    void addConnection(shared_ptr<Profile> newConnection) {
-        // Check if already connected (simple ID check)
-        auto it = find_if(connections.begin(), connections.end(), 
-                          [&](const shared_ptr<Profile>& conn){
-                              return conn->getID() == newConnection->getID();
-                          });
-
-        if (it == connections.end() && this->profileID != newConnection->getID()) {
-            connections.push_back(newConnection);
-            cout << name << " connected with " << newConnection->getName() << "." << endl;
-        }
-    }
-
-    // Accessors
-    int getID() const { return profileID; }
-    string getName() const { return name; }
-    string getProfession() const { return profession; }
-
-    // Display connections
-    void displayConnections() const {
-        cout << "\n--- Connections of " << name << " (" << profession << ") ---" << endl;
-        if (connections.empty()) {
-            cout << "No connections yet." << endl;
-            return;
-        }
-        for (const auto& conn : connections) {
-            cout << "- ID: " << conn->getID() << ", Name: " << conn->getName() << ", Field: " << conn->getProfession() << endl;
-        }
-    }
-};
-
-// --- 2. Derived Classes (Demonstrating Inheritance) ---
-
-class Engineer : public Profile {
-private:
-    string specialization;
-public:
-    Engineer(int id, const string& n, const string& spec)
-        : Profile(id, n, "Engineer"), specialization(spec) {}
-
-    // Polymorphic implementation of introduce()
-    void introduce() const override {
-        cout << "Hello, I am " << name << ", an " << profession 
-             << " specializing in " << specialization << "." << endl;
-    }
-};
-
-class Doctor : public Profile {
-private:
-    string medicalField;
-public:
-    Doctor(int id, const string& n, const string& field)
-        : Profile(id, n, "Doctor"), medicalField(field) {}
-
-    // Polymorphic implementation of introduce()
-    void introduce() const override {
-        cout << "Greetings, I am Dr. " << name << ", a " << profession 
-             << " working in " << medicalField << "." << endl;
-    }
-};
-
-class Artist : public Profile {
-private:
-    string medium;
-public:
-    Artist(int id, const string& n, const string& m)
-        : Profile(id, n, "Artist"), medium(m) {}
-
-    // Polymorphic implementation of introduce()
-    void introduce() const override {
-        cout << "Hi, I'm " << name << ", an " << profession 
-             << ". My primary medium is " << medium << "." << endl;
-    }
-};
-
-
-// --- 3. Interaction Components (Post & Comment Classes) ---
-
-/**
- * Class to represent a comment on a Post.
- */
-class Comment {
-private:
-    string content;
-    string authorName;
-public:
-    Comment(const string& c, const string& a) : content(c), authorName(a) {}
-
-    void display() const {
-        cout << "    [Comment by " << authorName << "]: " << content << endl;
-    }
-};
-
-/**
- * Class to represent a post made by a professional.
- */
-class Post {
-private:
-    int postID;
-    string content;
-    string authorName;
-    string authorProfession;
-    vector<Comment> comments;
-
-public:
-    Post(int id, const string& c, const string& n, const string& p)
-        : postID(id), content(c), authorName(n), authorProfession(p) {}
-    
-    // <<< --- FIX APPLIED HERE --- >>>
-    // We need a public accessor to read the private member postID.
-    int getPostID() const { return postID; } 
-
-    void addComment(const string& content, const string& authorName) {
-        comments.emplace_back(content, authorName);
-    }
-
-    void display() const {
-        cout << "\n=========================================" << endl;
-        cout << "POST ID: " << postID << endl;
-        cout << "Author: " << authorName << " (" << authorProfession << ")" << endl;
-        cout << "Content: " << content << endl;
-        cout << "--- Comments (" << comments.size() << ") ---" << endl;
-        if (comments.empty()) {
-            cout << "  No comments yet." << endl;
-        } else {
-            for (const auto& c : comments) {
-                c.display();
-            }
-        }
-        cout << "=========================================" << endl;
-    }
-};
-
-
-// --- 4. Network Management Class (Encapsulation) ---
-
-/**
- * The central class that manages all profiles and posts.
- * It encapsulates the entire data store.
- */
-class SocialNetwork {
-private:
-    vector<shared_ptr<Profile>> allProfiles;
-    vector<Post> allPosts;
-    int nextProfileID = 101;
-    int nextPostID = 1;
-
-public:
-    // Factory method to create and add profiles
-    shared_ptr<Profile> createProfile(const string& type, const string& name, const string& detail) {
-        shared_ptr<Profile> newProfile;
-        if (type == "Engineer") {
-            newProfile = make_shared<Engineer>(nextProfileID++, name, detail);
-        } else if (type == "Doctor") {
-            newProfile = make_shared<Doctor>(nextProfileID++, name, detail);
-        } else if (type == "Artist") {
-            newProfile = make_shared<Artist>(nextProfileID++, name, detail);
-        } else {
-            cout << "Invalid profession type." << endl;
-            return nullptr;
-        }
-        allProfiles.push_back(newProfile);
-        cout << "Profile created for " << name << " (ID: " << newProfile->getID() << ")." << endl;
-        return newProfile;
-    }
-
-    // Method to create a new Post
-    void createPost(shared_ptr<Profile> author, const string& content) {
-        if (!author) return;
-        allPosts.emplace_back(nextPostID++, content, author->getName(), author->getProfession());
-        cout << "\nPost created successfully by " << author->getName() << "." << endl;
-    }
-
-    // Method to add a comment to a Post
-    void addComment(int postID, shared_ptr<Profile> commenter, const string& content) {
-        if (!commenter) return;
-        for (auto& post : allPosts) {
-            // <<< --- FIX IS USED HERE --- >>>
-            if (post.getPostID() == postID) { 
-                post.addComment(content, commenter->getName());
-                cout << "Comment added to Post ID " << postID << " by " << commenter->getName() << "." << endl;
-                return;
-            }
-        }
-        cout << "Error: Post ID " << postID << " not found." << endl;
-    }
-    
-    // Method to find a profile by ID
-    shared_ptr<Profile> getProfileByID(int id) {
-        for (const auto& p : allProfiles) {
-            if (p->getID() == id) {
-                return p;
-            }
-        }
-        return nullptr;
-    }
-
-    // Display all posts
-    void displayFeed() const {
-        cout << "\n\n=========================================" << endl;
-        cout << "         PROFESSIONAL FEED" << endl;
-        cout << "=========================================" << endl;
-        if (allPosts.empty()) {
-            cout << "The feed is empty." << endl;
-            return;
-        }
-        for (const auto& post : allPosts) {
-            post.display();
-        }
-    }
-
-    // Display all profiles (for connection look-up)
-    void displayAllProfiles() const {
-        cout << "\n--- All Network Profiles ---" << endl;
-        for (const auto& p : allProfiles) {
-            cout << "ID: " << p->getID() << ", Name: " << p->getName() << ", Profession: " << p->getProfession() << endl;
-        }
-    }
-};
-
-// --- 5. Main Execution and Demonstration ---
-
-int main() {
-    // Enable fast I/O
-    ios_base::sync_with_stdio(false);
-    cin.tie(NULL);
-
-    cout << "--- Professional Social Network Simulation (C++ OOPS) ---" << endl;
-    
-    // Create the network manager object
-    SocialNetwork net; 
-
-    // 1. OBJECT CREATION (Profiles)
-    cout << "\n--- Creating Professional Profiles (Objects) ---" << endl;
-    
-    shared_ptr<Profile> eng1 = net.createProfile("Engineer", "Alice Johnson", "AI Development");
-    shared_ptr<Profile> doc1 = net.createProfile("Doctor", "Bob Williams", "Cardiology");
-    shared_ptr<Profile> art1 = net.createProfile("Artist", "Clara Smith", "Digital Painting");
-    shared_ptr<Profile> eng2 = net.createProfile("Engineer", "David Lee", "Mechanical Design");
-    
-    // 2. POLYMORPHISM Demonstration
-    cout << "\n--- Introducing Professionals (Polymorphism) ---" << endl;
-    if (eng1) eng1->introduce();
-    if (doc1) doc1->introduce();
-    if (art1) art1->introduce();
-
-    // 3. CONNECTION (Interaction)
-    cout << "\n--- Establishing Connections ---" << endl;
-    if (eng1 && doc1) eng1->addConnection(doc1);
-    if (eng1 && art1) eng1->addConnection(art1);
-    if (doc1 && eng2) doc1->addConnection(eng2);
-
-    // 4. POSTING (Creating Interaction Objects)
-    net.createPost(eng1, "Just finished a new framework for neural network training!");
-    net.createPost(doc1, "A quick guide on preventing burnout for young professionals.");
-    net.createPost(art1, "My latest piece: 'The Logic Gate'.");
-    
-    // 5. COMMENTING (Object Interaction)
-    net.addComment(1, doc1, "Great work, Alice! How's the performance optimization?");
-    net.addComment(3, eng1, "Fantastic use of light and shadow, Clara.");
-    net.addComment(2, eng2, "Very helpful advice, Dr. Williams!");
-
-    // 6. FEED DISPLAY & REVIEW
-    net.displayFeed();
-    
-    // 7. REVIEW CONNECTIONS
-    if (eng1) eng1->displayConnections();
-    
-    return 0;
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <memory>
+#include <algorithm>
+#include <deque>
+#include <unordered_set>
+#include <utility>
+#include "PostIndex.hpp"
+
+using namespace std;
+
+// --- 1. Base Class: Profile (Uses Inheritance) ---
+
+/**
+ * The abstract base class for all professionals.
+ *
+ * Connections are stored as the other profiles' ids, not pointers: the
+ * profiles themselves are owned by SocialNetwork, which resolves ids. The
+ * id list keeps traversal a plain array walk and the hash set answers
+ * "already connected?" in O(1).
+ */
+class Profile {
+protected:
+    int profileID;
+    string name;
+    string profession;
+    vector<int> connections;
+    unordered_set<int> connectionSet; // Same ids as `connections`, for membership checks
+
+public:
+    // Constructor
+    Profile(int id, const string& n, const string& p) : profileID(id), name(n), profession(p) {}
+
+    // Virtual destructor is crucial for proper memory management with inheritance
+    virtual ~Profile() {}
+
+    // Pure virtual function (makes Profile an Abstract Class)
+    virtual void introduce() const = 0;
+
+    // Returns false if already connected to `id` (or `id` is this profile).
+    // Use SocialNetwork::connect, which records both sides.
+    bool addConnection(int id) {
+        if (id == profileID || !connectionSet.insert(id).second) return false;
+        connections.push_back(id);
+        return true;
+    }
+
+    // Returns false if not connected to `id`. Order of the rest is not kept.
+    bool removeConnection(int id) {
+        if (!connectionSet.erase(id)) return false;
+        auto it = find(connections.begin(), connections.end(), id);
+        *it = connections.back();
+        connections.pop_back();
+        return true;
+    }
+
+    void reserveConnections(size_t count) {
+        connections.reserve(count);
+        connectionSet.reserve(count);
+    }
+
+    bool isConnectedTo(int id) const { return connectionSet.count(id) != 0; }
+
+    // Accessors
+    int getID() const { return profileID; }
+    const string& getName() const { return name; }
+    const string& getProfession() const { return profession; }
+    const vector<int>& getConnections() const { return connections; }
+};
+
+// --- 2. Derived Classes (Demonstrating Inheritance) ---
+
+class Engineer : public Profile {
+private:
+    string specialization;
+public:
+    Engineer(int id, const string& n, const string& spec)
+        : Profile(id, n, "Engineer"), specialization(spec) {}
+
+    // Polymorphic implementation of introduce()
+    void introduce() const override {
+        cout << "Hello, I am " << name << ", an " << profession 
+             << " specializing in " << specialization << ".\n";
+    }
+};
+
+class Doctor : public Profile {
+private:
+    string medicalField;
+public:
+    Doctor(int id, const string& n, const string& field)
+        : Profile(id, n, "Doctor"), medicalField(field) {}
+
+    // Polymorphic implementation of introduce()
+    void introduce() const override {
+        cout << "Greetings, I am Dr. " << name << ", a " << profession 
+             << " working in " << medicalField << ".\n";
+    }
+};
+
+class Artist : public Profile {
+private:
+    string medium;
+public:
+    Artist(int id, const string& n, const string& m)
+        : Profile(id, n, "Artist"), medium(m) {}
+
+    // Polymorphic implementation of introduce()
+    void introduce() const override {
+        cout << "Hi, I'm " << name << ", an " << profession 
+             << ". My primary medium is " << medium << ".\n";
+    }
+};
+
+
+// --- 3. Interaction Components (Post & Comment Classes) ---
+
+/**
+ * Class to represent a comment on a Post.
+ */
+class Comment {
+private:
+    string content;
+    string authorName;
+public:
+    Comment(const string& c, const string& a) : content(c), authorName(a) {}
+
+    void display() const {
+        cout << "    [Comment by " << authorName << "]: " << content << '\n';
+    }
+};
+
+/**
+ * Class to represent a post made by a professional.
+ * Comments are kept in arrival order and shown a page at a time.
+ */
+class Post {
+private:
+    int postID;
+    string content;
+    int authorID;
+    string authorName;
+    string authorProfession;
+    vector<Comment> comments;
+
+public:
+    static const size_t COMMENT_PAGE_SIZE = 5;
+
+    Post(int id, const string& c, int a, const string& n, const string& p)
+        : postID(id), content(c), authorID(a), authorName(n), authorProfession(p) {}
+    
+    // <<< --- FIX APPLIED HERE --- >>>
+    // We need a public accessor to read the private member postID.
+    int getPostID() const { return postID; } 
+    int getAuthorID() const { return authorID; }
+    const string& getAuthorName() const { return authorName; }
+    const string& getContent() const { return content; }
+    size_t getCommentCount() const { return comments.size(); }
+
+    void addComment(const string& content, const string& authorName) {
+        comments.emplace_back(content, authorName);
+    }
+
+    // Shows the post with one page of its comments, oldest first (page 0 is
+    // the first COMMENT_PAGE_SIZE comments).
+    void display(size_t page = 0) const {
+        cout << "\n=========================================\n";
+        cout << "POST ID: " << postID << '\n';
+        cout << "Author: " << authorName << " (" << authorProfession << ")\n";
+        cout << "Content: " << content << '\n';
+        cout << "--- Comments (" << comments.size() << ") ---\n";
+        size_t first = page * COMMENT_PAGE_SIZE;
+        size_t last = min(first + COMMENT_PAGE_SIZE, comments.size());
+        if (comments.empty()) {
+            cout << "  No comments yet.\n";
+        } else if (first >= comments.size()) {
+            cout << "  No comments on this page.\n";
+        } else {
+            for (size_t i = first; i < last; i++) {
+                comments[i].display();
+            }
+            if (first > 0 || last < comments.size()) {
+                cout << "  (Comments " << first + 1 << "-" << last << " of " << comments.size()
+                     << ", page " << page + 1 << " of " << (comments.size() + COMMENT_PAGE_SIZE - 1) / COMMENT_PAGE_SIZE
+                     << ")\n";
+            }
+        }
+        cout << "=========================================\n";
+    }
+};
+
+
+// --- 4. Network Management Class (Encapsulation) ---
+
+/**
+ * The central class that manages all profiles and posts.
+ * It encapsulates the entire data store, and is the sole owner of every
+ * profile: callers get plain pointers that stay valid until the profile is
+ * removed.
+ *
+ * Ids are handed out sequentially, so each table is indexed directly by
+ * id minus the first id: finding a profile or post costs the same however
+ * many there are. Posts sit in a deque, which never moves existing elements
+ * as it grows, so a post (and its comments) is never copied after creation.
+ * Every post's words also go into a PostIndex, for searchPosts.
+ */
+class SocialNetwork {
+private:
+    static const int FIRST_PROFILE_ID = 101;
+    static const int FIRST_POST_ID = 1;
+
+    vector<unique_ptr<Profile>> allProfiles; // allProfiles[id - FIRST_PROFILE_ID]; null once removed
+    deque<Post> allPosts;                    // allPosts[id - FIRST_POST_ID]
+    PostIndex postIndex;                     // Keyed by id - FIRST_POST_ID
+    int nextProfileID = FIRST_PROFILE_ID;
+    int nextPostID = FIRST_POST_ID;
+
+public:
+    // Factory method to create and add profiles
+    Profile* createProfile(const string& type, const string& name, const string& detail) {
+        unique_ptr<Profile> newProfile;
+        if (type == "Engineer") {
+            newProfile = make_unique<Engineer>(nextProfileID++, name, detail);
+        } else if (type == "Doctor") {
+            newProfile = make_unique<Doctor>(nextProfileID++, name, detail);
+        } else if (type == "Artist") {
+            newProfile = make_unique<Artist>(nextProfileID++, name, detail);
+        } else {
+            cout << "Invalid profession type.\n";
+            return nullptr;
+        }
+        Profile* created = newProfile.get();
+        allProfiles.push_back(move(newProfile));
+        cout << "Profile created for " << name << " (ID: " << created->getID() << ").\n";
+        return created;
+    }
+
+    // Removes a profile and every connection to it. Its posts and comments
+    // stay, signed with its name.
+    bool removeProfile(int id) {
+        Profile* profile = getProfileByID(id);
+        if (!profile) return false;
+        for (int other : profile->getConnections()) {
+            allProfiles[other - FIRST_PROFILE_ID]->removeConnection(id);
+        }
+        cout << "Profile " << profile->getName() << " (ID: " << id << ") removed.\n";
+        allProfiles[id - FIRST_PROFILE_ID].reset();
+        return true;
+    }
+
+    // Connects two profiles both ways. Returns false if either is missing or
+    // they are already connected.
+    bool connect(int a, int b) {
+        Profile* first = getProfileByID(a);
+        Profile* second = getProfileByID(b);
+        if (!first || !second || !first->addConnection(b)) return false;
+        second->addConnection(a);
+        cout << first->getName() << " connected with " << second->getName() << ".\n";
+        return true;
+    }
+
+    // Connects many pairs at once, sizing every profile's lists up front and
+    // printing one summary line. Returns the number of new connections.
+    size_t connectAll(const vector<pair<int, int>>& pairs) {
+        vector<size_t> added(allProfiles.size(), 0);
+        for (const auto& p : pairs) {
+            if (!getProfileByID(p.first) || !getProfileByID(p.second)) continue;
+            added[p.first - FIRST_PROFILE_ID]++;
+            added[p.second - FIRST_PROFILE_ID]++;
+        }
+        for (size_t i = 0; i < allProfiles.size(); i++) {
+            if (added[i] > 0) allProfiles[i]->reserveConnections(allProfiles[i]->getConnections().size() + added[i]);
+        }
+
+        size_t made = 0;
+        for (const auto& p : pairs) {
+            Profile* first = getProfileByID(p.first);
+            Profile* second = getProfileByID(p.second);
+            if (first && second && first->addConnection(p.second)) {
+                second->addConnection(p.first);
+                made++;
+            }
+        }
+        cout << "Made " << made << " new connections from " << pairs.size() << " pairs.\n";
+        return made;
+    }
+
+    // Method to create a new Post
+    void createPost(const Profile* author, const string& content) {
+        if (!author) return;
+        allPosts.emplace_back(nextPostID++, content, author->getID(), author->getName(), author->getProfession());
+        postIndex.add(static_cast<uint32_t>(allPosts.size() - 1), content);
+        cout << "\nPost created successfully by " << author->getName() << ".\n";
+    }
+
+    // Lists the newest posts by `viewer` or their connections that contain
+    // every word of `query`; "OR" between words separates alternatives.
+    void searchPosts(const Profile* viewer, const string& query, size_t limit = 10) const {
+        if (!viewer) return;
+        PostQuery parsed = postIndex.parse(query);
+        size_t scanned = 0;
+        vector<uint32_t> found = parsed.newest(limit, [&](uint32_t index) {
+            int author = allPosts[index].getAuthorID();
+            return author == viewer->getID() || viewer->isConnectedTo(author);
+        }, scanned);
+
+        cout << "\n--- Posts matching \"" << query << "\" for " << viewer->getName() << " ---\n";
+        if (found.empty()) {
+            cout << "No posts found.\n";
+            return;
+        }
+        for (uint32_t index : found) {
+            const Post& post = allPosts[index];
+            cout << "- Post " << post.getPostID() << " by " << post.getAuthorName() << ": " << post.getContent() << '\n';
+        }
+    }
+
+    // Method to find a post by ID
+    Post* getPostByID(int id) {
+        if (id < FIRST_POST_ID || id >= nextPostID) return nullptr;
+        return &allPosts[id - FIRST_POST_ID];
+    }
+
+    // Method to add a comment to a Post
+    void addComment(int postID, const Profile* commenter, const string& content) {
+        if (!commenter) return;
+        Post* post = getPostByID(postID);
+        if (!post) {
+            cout << "Error: Post ID " << postID << " not found.\n";
+            return;
+        }
+        post->addComment(content, commenter->getName());
+        cout << "Comment added to Post ID " << postID << " by " << commenter->getName() << ".\n";
+    }
+
+    // Display one post with a page of its comments
+    void displayPost(int postID, size_t page = 0) {
+        Post* post = getPostByID(postID);
+        if (!post) {
+            cout << "Error: Post ID " << postID << " not found.\n";
+            return;
+        }
+        post->display(page);
+    }
+    
+    // Method to find a profile by ID
+    Profile* getProfileByID(int id) {
+        if (id < FIRST_PROFILE_ID || id >= nextProfileID) return nullptr;
+        return allProfiles[id - FIRST_PROFILE_ID].get();
+    }
+
+    // Display connections
+    void displayConnections(int id) {
+        Profile* profile = getProfileByID(id);
+        if (!profile) return;
+        cout << "\n--- Connections of " << profile->getName() << " (" << profile->getProfession() << ") ---\n";
+        if (profile->getConnections().empty()) {
+            cout << "No connections yet.\n";
+            return;
+        }
+        for (int connID : profile->getConnections()) {
+            const Profile* conn = getProfileByID(connID);
+            cout << "- ID: " << conn->getID() << ", Name: " << conn->getName() << ", Field: " << conn->getProfession() << '\n';
+        }
+    }
+
+    // Display all posts
+    void displayFeed() const {
+        cout << "\n\n=========================================\n";
+        cout << "         PROFESSIONAL FEED\n";
+        cout << "=========================================\n";
+        if (allPosts.empty()) {
+            cout << "The feed is empty.\n";
+            return;
+        }
+        for (const auto& post : allPosts) {
+            post.display();
+        }
+    }
+
+    // Display all profiles (for connection look-up)
+    void displayAllProfiles() const {
+        cout << "\n--- All Network Profiles ---\n";
+        for (const auto& p : allProfiles) {
+            if (!p) continue;
+            cout << "ID: " << p->getID() << ", Name: " << p->getName() << ", Profession: " << p->getProfession() << '\n';
+        }
+    }
+};
+
+// --- 5. Main Execution and Demonstration ---
+
+int main() {
+    // Enable fast I/O
+    ios_base::sync_with_stdio(false);
+    cin.tie(NULL);
+
+    cout << "--- Professional Social Network Simulation (C++ OOPS) ---\n";
+    
+    // Create the network manager object
+    SocialNetwork net; 
+
+    // 1. OBJECT CREATION (Profiles)
+    cout << "\n--- Creating Professional Profiles (Objects) ---\n";
+    
+    Profile* eng1 = net.createProfile("Engineer", "Alice Johnson", "AI Development");
+    Profile* doc1 = net.createProfile("Doctor", "Bob Williams", "Cardiology");
+    Profile* art1 = net.createProfile("Artist", "Clara Smith", "Digital Painting");
+    Profile* eng2 = net.createProfile("Engineer", "David Lee", "Mechanical Design");
+    Profile* art2 = net.createProfile("Artist", "Erin Park", "Sculpture");
+    
+    // 2. POLYMORPHISM Demonstration
+    cout << "\n--- Introducing Professionals (Polymorphism) ---\n";
+    if (eng1) eng1->introduce();
+    if (doc1) doc1->introduce();
+    if (art1) art1->introduce();
+
+    // 3. CONNECTION (Interaction)
+    cout << "\n--- Establishing Connections ---\n";
+    if (eng1 && doc1) net.connect(eng1->getID(), doc1->getID());
+    if (eng1 && art1) net.connect(eng1->getID(), art1->getID());
+    if (doc1 && eng2) net.connect(doc1->getID(), eng2->getID());
+
+    // Many connections at once, e.g. from an import; duplicates are skipped
+    if (art2) net.connectAll({{art2->getID(), eng1->getID()}, {art2->getID(), art1->getID()},
+                              {art2->getID(), doc1->getID()}, {eng1->getID(), doc1->getID()}});
+
+    // 4. POSTING (Creating Interaction Objects)
+    net.createPost(eng1, "Just finished a new framework for neural network training!");
+    net.createPost(doc1, "A quick guide on preventing burnout for young professionals.");
+    net.createPost(art1, "My latest piece: 'The Logic Gate'.");
+    
+    // 5. COMMENTING (Object Interaction)
+    net.addComment(1, doc1, "Great work, Alice! How's the performance optimization?");
+    net.addComment(3, eng1, "Fantastic use of light and shadow, Clara.");
+    net.addComment(2, eng2, "Very helpful advice, Dr. Williams!");
+    net.addComment(1, eng2, "Which datasets did you train it on?");
+    net.addComment(1, art1, "Could it help with generative art?");
+    net.addComment(1, eng1, "Mostly public benchmarks for now, David.");
+    net.addComment(1, doc1, "Any plans for medical imaging?");
+    net.addComment(1, eng1, "Yes, that's next on the list!");
+
+    // 6. FEED DISPLAY & REVIEW
+    net.displayFeed();
+    
+    // Comments are shown a page at a time; this is the second page of Post 1
+    net.displayPost(1, 1);
+
+    // Posts by Alice and her connections, searched by word
+    net.searchPosts(eng1, "network OR burnout");
+    net.searchPosts(eng2, "network OR burnout");
+
+    // 7. REVIEW CONNECTIONS
+    if (eng1) net.displayConnections(eng1->getID());
+
+    // 8. REMOVAL: the profile and every connection to it go away
+    if (art2) {
+        net.removeProfile(art2->getID());
+        art2 = nullptr; // Dangling once removed
+    }
+    if (eng1) net.displayConnections(eng1->getID());
+    net.displayAllProfiles();
+    
+    return 0;
 }
\ No newline at end of file